@@ -0,0 +1,66 @@
+#include "PairKernel.h"
+#include <benchmark/benchmark.h>
+#include <glm/glm.hpp>
+#include <random>
+#include <vector>
+
+namespace {
+    // A shallow-tank neighborhood: particles scattered within the
+    // interaction radius, neighbor indices in random (cache-unfriendly) order
+    struct PairKernelFixture {
+        std::vector<float> x, y, z, vx, vy, vz, mass, radius, color, inverseDensity, pressureRatio;
+        std::vector<uint32_t> indices;
+        PairNeighbors neighbors{};
+
+        explicit PairKernelFixture(size_t neighborCount) {
+            const size_t particleCount = 8192;
+            std::mt19937 gen(1);
+            std::uniform_real_distribution<float> pos(-5.0f, 5.0f);
+            std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+            for (size_t i = 0; i < particleCount; ++i) {
+                x.push_back(pos(gen));
+                y.push_back(pos(gen) * 0.5f);
+                z.push_back(pos(gen));
+                vx.push_back(pos(gen));
+                vy.push_back(pos(gen));
+                vz.push_back(pos(gen));
+                mass.push_back(0.8f + 0.4f * unit(gen));
+                radius.push_back(0.15f + 0.1f * unit(gen));
+                inverseDensity.push_back(2.0f + unit(gen));
+                pressureRatio.push_back(unit(gen));
+                for (int c = 0; c < 3; ++c) color.push_back(0.3f + 0.7f * unit(gen));
+            }
+            std::uniform_int_distribution<uint32_t> pick(0, particleCount - 1);
+            for (size_t n = 0; n < neighborCount; ++n) {
+                indices.push_back(pick(gen));
+            }
+            neighbors = {x.data(), y.data(), z.data(), vx.data(), vy.data(), vz.data(),
+                         mass.data(), radius.data(), color.data(), inverseDensity.data(), pressureRatio.data(),
+                         indices.data(), indices.size()};
+        }
+    };
+
+    void BM_PairKernel(benchmark::State& state, PairKernelIsa isa) {
+        if (static_cast<int>(isa) > static_cast<int>(GetSupportedPairKernelIsa())) {
+            state.SkipWithError("ISA not supported on this CPU");
+            return;
+        }
+
+        PairKernelFixture fixture(static_cast<size_t>(state.range(0)));
+        const PairKernelFn kernel = GetPairKernel(isa);
+        const PairSubject subject{glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.7f), 1.0f, 0.2f, 0.5f};
+        const PairKernelParams params{5.0f, SphKernel(2.0f)};
+
+        for (auto _ : state) {
+            PairAccumulator acc;
+            kernel(subject, fixture.neighbors, params, acc);
+            benchmark::DoNotOptimize(acc);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+        state.SetLabel(GetPairKernelName(isa));
+    }
+}
+
+BENCHMARK_CAPTURE(BM_PairKernel, Scalar, PairKernelIsa::Scalar)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK_CAPTURE(BM_PairKernel, AVX2, PairKernelIsa::AVX2)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK_CAPTURE(BM_PairKernel, AVX512, PairKernelIsa::AVX512)->Arg(16)->Arg(64)->Arg(256);
@@ -0,0 +1,196 @@
+#include "Config.h"
+#include "LiquidSimulation.h"
+#include "RandomParticles.h"
+#include "TrajectoryRecorder.h"
+#include "VertexPacking.h"
+#include "WaveField.h"
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// End-to-end Update and per-phase timings over the standard random
+// workload at several particle counts and thread counts. Run with
+//   CppLiquidBench --benchmark_out=bench.json --benchmark_out_format=json
+// and diff the JSON between releases.
+//
+// Scenes above CPPLIQUID_BENCH_MAX_PARTICLES (default 100000, every size)
+// are reported as skipped, for trimming the run on small machines.
+
+namespace {
+    constexpr uint32_t WorkloadSeed = 1234;
+    constexpr float StepSize = 1.0f / 60.0f;
+
+    size_t MaxParticles() {
+        const char* value = std::getenv("CPPLIQUID_BENCH_MAX_PARTICLES");
+        return value ? std::strtoull(value, nullptr, 10) : 100000;
+    }
+
+    // One warmed-up scene per particle count, copied by each benchmark
+    const LiquidSimulation& GetScene(int particleCount) {
+        static std::map<int, std::unique_ptr<LiquidSimulation>> scenes;
+        auto& scene = scenes[particleCount];
+        if (!scene) {
+            Config config;
+            scene = std::make_unique<LiquidSimulation>(config.width, config.height, WorkloadSeed);
+            std::mt19937 gen = MakeWorkloadGenerator(WorkloadSeed);
+            AddRandomParticles(*scene, config, 0, particleCount, gen);
+            scene->Update(StepSize); // Settle particles into the tank
+        }
+        return *scene;
+    }
+
+    // Returns null (and marks the run skipped) for oversized scenes
+    std::unique_ptr<LiquidSimulation> MakeSimulation(benchmark::State& state) {
+        const int particleCount = static_cast<int>(state.range(0));
+        if (static_cast<size_t>(particleCount) > MaxParticles()) {
+            state.SkipWithError("Above CPPLIQUID_BENCH_MAX_PARTICLES");
+            return nullptr;
+        }
+        auto simulation = std::make_unique<LiquidSimulation>(GetScene(particleCount));
+        simulation->SetThreadCount(static_cast<int>(state.range(1)));
+        return simulation;
+    }
+
+    void SetCounters(benchmark::State& state, const LiquidSimulation& simulation) {
+        state.counters["particles"] = static_cast<double>(simulation.GetParticleCount());
+        state.SetItemsProcessed(state.iterations() * simulation.GetParticleCount());
+    }
+
+    // Update as a task graph, or with the phases one after another
+    void BM_Update(benchmark::State& state, bool taskGraph) {
+        auto simulation = MakeSimulation(state);
+        if (!simulation) return;
+        simulation->SetTaskGraphEnabled(taskGraph);
+        for (auto _ : state) {
+            simulation->Update(StepSize);
+        }
+        SetCounters(state, *simulation);
+    }
+
+    void BM_Phase(benchmark::State& state, LiquidSimulation::Phase phase) {
+        auto simulation = MakeSimulation(state);
+        if (!simulation) return;
+        for (auto _ : state) {
+            simulation->RunPhase(phase, StepSize);
+        }
+        SetCounters(state, *simulation);
+    }
+
+    void BM_VertexPacking(benchmark::State& state) {
+        auto simulation = MakeSimulation(state);
+        if (!simulation) return;
+        std::vector<float> vertices;
+        for (auto _ : state) {
+            PackLiquidVertices(simulation->GetParticleStore(), nullptr, vertices);
+            benchmark::DoNotOptimize(vertices.data());
+        }
+        SetCounters(state, *simulation);
+    }
+
+    // Generating and inserting the standard workload, as the app does at
+    // startup
+    void BM_AddParticles(benchmark::State& state) {
+        const int particleCount = static_cast<int>(state.range(0));
+        Config config;
+        for (auto _ : state) {
+            state.PauseTiming();
+            LiquidSimulation simulation(config.width, config.height, WorkloadSeed);
+            simulation.SetThreadCount(static_cast<int>(state.range(1)));
+            std::mt19937 gen = MakeWorkloadGenerator(WorkloadSeed);
+            state.ResumeTiming();
+            AddRandomParticles(simulation, config, 0, particleCount, gen);
+        }
+        state.SetItemsProcessed(state.iterations() * particleCount);
+    }
+
+    // The simulation-thread cost of recording: the copy into a free
+    // buffer. Encoding and I/O run on the writer thread, outside the timing.
+    void BM_TrajectoryCapture(benchmark::State& state, bool delta) {
+        auto simulation = MakeSimulation(state);
+        if (!simulation) return;
+        const std::string path = "bench_trajectory.bin";
+        {
+            TrajectoryRecorder::Options options;
+            options.delta = delta;
+            TrajectoryRecorder recorder(path, options);
+            for (auto _ : state) {
+                recorder.Capture(simulation->GetParticleStore(), 0.0);
+                state.PauseTiming();
+                recorder.Flush();
+                state.ResumeTiming();
+            }
+            state.counters["bytes_per_frame"] = static_cast<double>(recorder.GetBytesWritten()) / state.iterations();
+        }
+        std::remove(path.c_str());
+        SetCounters(state, *simulation);
+    }
+
+    // A tank-sized field with every channel loud, so no step is skipped.
+    // Items are cells times channels.
+    void BM_WaveFieldStep(benchmark::State& state) {
+        const int threads = static_cast<int>(state.range(0));
+        constexpr size_t Channels = 6;
+        WaveField field;
+        field.Configure(glm::vec3(-120.0f, -80.0f, -40.0f), glm::vec3(120.0f, 80.0f, 40.0f),
+                        Channels, WaveField::Params());
+        std::mt19937 gen(WorkloadSeed);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        for (auto _ : state) {
+            state.PauseTiming();
+            for (size_t channel = 0; channel < Channels; ++channel) {
+                const glm::vec3 position(unit(gen) * 120.0f, unit(gen) * 80.0f, unit(gen) * 40.0f);
+                field.Inject(channel, position, 1.0f, unit(gen) * 3.0f);
+            }
+            state.ResumeTiming();
+            field.Step(StepSize, threads);
+        }
+        state.SetItemsProcessed(state.iterations() * field.GetCellCount() * Channels);
+    }
+
+    void SceneArgs(benchmark::internal::Benchmark* bench) {
+        bench->ArgNames({"particles", "threads"})
+            ->ArgsProduct({{1000, 10000, 25000, 100000}, {1, 2, 4, 8}})
+            ->Unit(benchmark::kMillisecond)
+            ->UseRealTime();
+    }
+
+    const bool registered = [] {
+        benchmark::AddCustomContext("pair_kernel", GetPairKernelName(GetSupportedPairKernelIsa()));
+        benchmark::AddCustomContext("workload_seed", std::to_string(WorkloadSeed));
+
+        benchmark::RegisterBenchmark("Update", BM_Update, true)->Apply(SceneArgs);
+        benchmark::RegisterBenchmark("Update/InOrder", BM_Update, false)->Apply(SceneArgs);
+        for (LiquidSimulation::Phase phase : LiquidSimulation::UpdatePhases) {
+            std::string name = std::string("Phase/") + LiquidSimulation::GetPhaseName(phase);
+            benchmark::RegisterBenchmark(name.c_str(), BM_Phase, phase)->Apply(SceneArgs);
+        }
+        benchmark::RegisterBenchmark("AddParticles", BM_AddParticles)
+            ->ArgNames({"particles", "threads"})
+            ->ArgsProduct({{10000, 100000, 1000000}, {1, 2, 4, 8}})
+            ->UseRealTime()
+            ->Unit(benchmark::kMillisecond);
+        for (bool delta : {false, true}) {
+            benchmark::RegisterBenchmark(delta ? "TrajectoryCapture/Delta" : "TrajectoryCapture/Raw",
+                                         BM_TrajectoryCapture, delta)
+                ->ArgNames({"particles", "threads"})
+                ->ArgsProduct({{1000, 10000, 25000, 100000}, {1}})
+                ->Unit(benchmark::kMillisecond);
+        }
+        // Single-threaded, so one thread count is enough
+        benchmark::RegisterBenchmark("VertexPacking", BM_VertexPacking)
+            ->ArgNames({"particles", "threads"})
+            ->ArgsProduct({{1000, 10000, 25000, 100000}, {1}})
+            ->Unit(benchmark::kMillisecond);
+        benchmark::RegisterBenchmark("WaveField/Step", BM_WaveFieldStep)
+            ->ArgNames({"threads"})
+            ->ArgsProduct({{1, 2, 4, 8}})
+            ->UseRealTime()
+            ->Unit(benchmark::kMillisecond);
+        return true;
+    }();
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// On-disk layout of LiquidSimulation checkpoints. A fixed header is
+// followed by a section table and then the raw section payloads, each
+// starting on a CheckpointAlignment boundary. Particle arrays are stored
+// exactly as they sit in ParticleStore, so loading maps the file and
+// copies each array in one go, with no per-particle parsing. All values
+// use the writer's byte order; loaders reject files with a different
+// endianTag. Readers skip section ids they don't know, so new sections
+// can be added without a version bump; a changed payload layout needs one.
+namespace Checkpoint {
+
+constexpr char Magic[8] = {'C', 'P', 'L', 'Q', 'C', 'K', 'P', 'T'};
+constexpr uint32_t Version = 2;
+// Version 1 files predate the SPH constants in the header and load with
+// the simulation's current ones
+constexpr uint32_t OldestVersion = 1;
+constexpr uint32_t EndianTag = 0x01020304;
+constexpr size_t Alignment = 64;
+
+enum class SectionId : uint32_t {
+  // ParticleStore arrays, one element per particle
+  X = 1, Y, Z,
+  VX, VY, VZ,
+  Mass,
+  Radius,
+  Color,
+  TargetColor,
+  ColorTransitionSpeed,
+  BaseRadius,
+  WavePhase,
+  WaveAmplitude,
+  WaveDecay,
+  ExpireTime, // Optional: older files load as never expiring
+  // Optional, with MembershipColors: each particle's group, its distance
+  // and the particle color they were computed from. Older files recompute
+  // every membership against the centroid colors.
+  Group, GroupDistance, MembershipColor,
+  // One element per group
+  Centroids = 100,
+  // Optional: WaveField phasors, one glm::vec2 per cell of every group.
+  // Older files load with a silent field.
+  WaveField = 101,
+  // Centroid colors the memberships were computed against
+  MembershipColors = 102,
+  // std::mt19937 state in its standard text form
+  RngState = 200,
+};
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t endianTag;
+  uint64_t fileSize;
+  uint64_t particleCount;
+  uint32_t groupCount;
+  uint32_t sectionCount;
+  uint32_t seed;
+  float globalTime;
+  float timeSinceLastSpawn;
+  float width, height;
+  float gravity;
+  float damping;
+  float pressureConstant, restDensity; // Since version 2, as are the rest
+  float viscosity;
+  uint8_t reserved[48]; // Zero; pads the header to one aligned block
+};
+static_assert(sizeof(Header) == 128);
+
+struct Section {
+  SectionId id;
+  uint32_t elementSize; // Bytes per element, checked on load
+  uint64_t offset;      // From the start of the file, Alignment-aligned
+  uint64_t bytes;
+};
+static_assert(sizeof(Section) == 24);
+
+} // namespace Checkpoint
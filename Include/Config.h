@@ -2,6 +2,7 @@
 
 #include <nlohmann/json.hpp>
 #include <glm/glm.hpp>
+#include <cstdint>
 #include <string>
 
 using json = nlohmann::json;
@@ -16,13 +17,59 @@ struct Config {
     float gravity = -12.0f;       
     float damping = 0.98f;        
     
-    // Camera - positioned to see massive area and fill entire window
-    glm::vec3 cameraPos = glm::vec3(60.0f, 40.0f, 100.0f);  // Much further back
-    glm::vec3 cameraTarget = glm::vec3(60.0f, 40.0f, 0.0f); // Center of large area
+    // SPH fluid: pressure is pressureStiffness * (density - restDensity),
+    // clamped at zero, and viscosity smooths velocities between neighbors
+    float pressureStiffness = 1000.0f;
+    float restDensity = 1.5f;
+    float viscosity = 0.5f;
+    
+    // Threads for the parallel simulation phases (0 = OpenMP default)
+    int threadCount = 0;
+    int collisionIterations = 1;  // Contact solver passes per step
+    
+    // Fixed simulation step, independent of the display rate
+    float fixedTimestep = 1.0f / 60.0f;
+    int maxSubsteps = 4;          // Per frame; extra time is dropped
+    // Step on a thread of its own instead of between frames
+    bool simulationThread = false;
+    
+    // Random seed for the simulation and the initial particles; a fixed
+    // seed makes runs repeatable (-1 = new random seed each run)
+    int64_t seed = -1;
+    
+    // Resume from this checkpoint if it exists; the state is saved back on
+    // exit and on SIGUSR1 (empty = no checkpointing)
+    std::string checkpointPath;
+    
+    // Record particle trajectories here (empty = off). Delta implies
+    // quantized; together they shrink files about fourfold.
+    std::string recordPath;
+    bool recordQuantized = true;
+    bool recordDelta = true;
+    
+    // Particle emitter: spawns per second near existing particles, each
+    // living emitLifetime seconds (0 = forever), while fewer than
+    // emitMaxParticles are alive (0 = no cap). 0 particles/s = off.
+    float emitRate = 0.0f;
+    float emitLifetime = 0.0f;
+    int emitMaxParticles = 0;
+    
+    // Play this trajectory back instead of simulating (empty = simulate).
+    // `CppLiquid --replay <path>` sets it for one run.
+    std::string replayPath;
+    
+    // Camera - positioned to see massive area and fill entire window.
+    // The wall box spans width x height centered on x = 0 with its floor
+    // at y = 0, so the target is its middle: (0, height / 2, 0).
+    glm::vec3 cameraPos = glm::vec3(0.0f, 40.0f, 100.0f);   // Much further back
+    glm::vec3 cameraTarget = glm::vec3(0.0f, 40.0f, 0.0f);  // Center of the wall box
     
     // Load from JSON file, fallback to defaults if missing
     static Config Load(const std::string& filename = "config.json");
     
+    // `seed`, or a fresh random one when it is negative
+    uint32_t ResolveSeed() const;
+    
     // Save to JSON file
     void Save(const std::string& filename = "config.json") const;
 };
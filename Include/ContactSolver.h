@@ -0,0 +1,39 @@
+#pragma once
+#include "ParticleStore.h"
+#include "SpatialGrid.h"
+#include <cstdint>
+#include <vector>
+
+// Particle-particle contact solver. Touching pairs are gathered from a grid
+// over the current positions, then greedily colored into batches in which
+// no particle appears twice, so each batch can be solved in parallel
+// without races. Batches run in a fixed order, which keeps results
+// independent of the thread count.
+class ContactSolver {
+public:
+  struct Contact {
+    uint32_t a, b;
+    float waveIntensity; // Strongest collision impulse response, -1 = none
+  };
+
+  void Solve(ParticleStore &particles, int iterations, int threadCount);
+
+  // Contacts from the last Solve, ordered batch by batch
+  const std::vector<Contact> &GetContacts() const { return contacts; }
+  size_t GetBatchCount() const { return batchOffsets.empty() ? 0 : batchOffsets.size() - 1; }
+  size_t GetBatchBegin(size_t batch) const { return batchOffsets[batch]; }
+  size_t GetBatchEnd(size_t batch) const { return batchOffsets[batch + 1]; }
+
+private:
+  void GatherContacts(const ParticleStore &particles, int threadCount);
+  void ColorContacts(size_t particleCount);
+  static void SolveContact(ParticleStore &particles, Contact &contact);
+
+  SpatialGrid grid;
+  std::vector<size_t> contactOffsets; // Per-particle CSR of the gather pass
+  std::vector<Contact> gathered;
+  std::vector<Contact> contacts;      // Reordered into batches
+  std::vector<size_t> batchOffsets;
+  std::vector<uint64_t> usedColors;   // Per particle, bit c = in batch c
+  std::vector<uint8_t> contactColor;
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include "SpatialGrid.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// Per-cell member counts of each group over a grid with cell size
+// radius / 2, so a point's neighborhood tally is a sum over nearby cells
+// instead of a scan over neighbor pairs. Approximate mode sums every cell
+// whose center lies within the radius. Exact mode sums cells entirely
+// inside the radius and distance-tests only the points of cells that
+// straddle it, matching a brute-force count.
+class GroupHistogram {
+public:
+  enum class Mode { Approximate, Exact };
+
+  static constexpr size_t MaxGroups = 32;
+  static constexpr uint8_t Uncounted = 0xFF;
+
+  // groupOf(i) returns point i's group, or Uncounted to leave it out.
+  // Storage is reused across builds.
+  template <typename PositionFn, typename GroupFn>
+  void Build(size_t count, size_t groupCount, float radius,
+             PositionFn &&positionOf, GroupFn &&groupOf);
+
+  // Adds the number of counted points of each group within the radius of
+  // `point` to counts[0..GetGroupCount()). A counted point at `point`
+  // itself is included; callers subtract it.
+  void Count(const glm::vec3 &point, Mode mode, int *counts) const;
+
+  size_t GetGroupCount() const { return groupCount; }
+  float GetRadius() const { return radius; }
+
+private:
+  SpatialGrid grid;
+  std::vector<uint32_t> cellCounts;       // cell * groupCount + group
+  std::vector<glm::vec3> sortedPositions; // In grid order
+  std::vector<uint8_t> sortedGroups;
+  size_t groupCount = 0;
+  float radius = 0.0f;
+};
+
+template <typename PositionFn, typename GroupFn>
+void GroupHistogram::Build(size_t count, size_t groups, float r,
+                           PositionFn &&positionOf, GroupFn &&groupOf) {
+  groupCount = std::min(groups, MaxGroups);
+  radius = r;
+  grid.Build(count, radius * 0.5f, positionOf);
+
+  const std::vector<uint32_t> &sorted = grid.GetSortedIndices();
+  sortedPositions.resize(count);
+  sortedGroups.resize(count);
+  cellCounts.assign(grid.GetCellCount() * groupCount, 0u);
+  for (size_t k = 0; k < count; ++k) {
+    const uint32_t i = sorted[k];
+    const uint8_t group = groupOf(i);
+    sortedPositions[k] = positionOf(i);
+    sortedGroups[k] = group < groupCount ? group : Uncounted;
+    if (group < groupCount) {
+      ++cellCounts[grid.GetCellOf(i) * groupCount + group];
+    }
+  }
+}
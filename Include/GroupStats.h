@@ -0,0 +1,51 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+// Running aggregates over the members of one color group. Partial stats
+// over disjoint ranges of particles merge into the stats of their union,
+// so a parallel pass can fill one per chunk and combine them in order.
+struct GroupStats {
+  static constexpr uint32_t NoMember = UINT32_MAX;
+
+  uint32_t count = 0;
+  glm::vec3 positionSum = glm::vec3(0.0f);
+  glm::vec3 velocitySum = glm::vec3(0.0f);
+  glm::vec3 boundsMin = glm::vec3(std::numeric_limits<float>::max());
+  glm::vec3 boundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+  // Strong member closest to the group's centroid (see LiquidSimulation)
+  uint32_t representative = NoMember;
+  float representativeDistance2 = std::numeric_limits<float>::max();
+
+  glm::vec3 GetMeanPosition() const { return count ? positionSum / float(count) : glm::vec3(0.0f); }
+  glm::vec3 GetMeanVelocity() const { return count ? velocitySum / float(count) : glm::vec3(0.0f); }
+
+  void Add(const glm::vec3 &position, const glm::vec3 &velocity) {
+    ++count;
+    positionSum += position;
+    velocitySum += velocity;
+    boundsMin = glm::min(boundsMin, position);
+    boundsMax = glm::max(boundsMax, position);
+  }
+
+  // Keeps the closest candidate; ties go to the one offered first
+  void OfferRepresentative(uint32_t index, float distance2) {
+    if (distance2 < representativeDistance2) {
+      representative = index;
+      representativeDistance2 = distance2;
+    }
+  }
+
+  // `other` must cover particles after this one's for ties to keep
+  // favoring the lowest index
+  void Merge(const GroupStats &other) {
+    count += other.count;
+    positionSum += other.positionSum;
+    velocitySum += other.velocitySum;
+    boundsMin = glm::min(boundsMin, other.boundsMin);
+    boundsMax = glm::max(boundsMax, other.boundsMax);
+    OfferRepresentative(other.representative, other.representativeDistance2);
+  }
+};
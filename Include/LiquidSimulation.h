@@ -1,57 +1,267 @@
 #pragma once
+#include "ContactSolver.h"
+#include "GroupHistogram.h"
+#include "GroupStats.h"
+#include "NeighborList.h"
+#include "PairKernel.h"
+#include "ParticleStore.h"
+#include "SignedDistanceField.h"
+#include "SpatialGrid.h"
+#include "SphKernel.h"
+#include "TaskGraph.h"
 #include "Wall.h"
+#include "WaveField.h"
 #include <boost/container/static_vector.hpp>
 #include <glm/glm.hpp>
+#include <algorithm>
+#include <functional>
+#include <queue>
 #include <random>
+#include <span>
+#include <string>
+#include <utility>
 #include <vector>
 
-struct LiquidParticle {
+// What a caller chooses about a new particle; AddParticles draws the rest
+// (radius, mass, transition speed, wave decay) from the simulation's RNG
+struct ParticleInit {
   glm::vec3 position;
   glm::vec3 velocity;
   glm::vec3 color;
-  glm::vec3 targetColor;  // For smooth color transitions
-  float radius;
-  float baseRadius;       // Original radius before wave effects
-  float mass;
-  float colorTransitionSpeed;
-  float wavePhase;        // Phase for wave propagation
-  float waveAmplitude;    // Current wave amplitude
-  float waveDecay;        // How fast the wave decays
+  float lifetime = 0.0f; // Seconds until it despawns, 0 = never
 };
 
 class LiquidSimulation {
 public:
-  LiquidSimulation(float width, float height);
+  // The stages of Update, in the order they take effect. Exposed so tools
+  // and benchmarks can run and time each one on its own.
+  enum class Phase {
+    NeighborSearch,
+    Density,
+    Centroids,
+    Forces,
+    Positions,
+    Colors,
+    Waves,
+    Collisions,
+    WallCollisions,
+    WavePropagation,
+    GroupStats
+  };
+  static constexpr Phase UpdatePhases[] = {
+      Phase::NeighborSearch, Phase::Density, Phase::Centroids, Phase::Forces,
+      Phase::Positions, Phase::Colors, Phase::Waves,
+      Phase::Collisions, Phase::WallCollisions, Phase::WavePropagation,
+      Phase::GroupStats};
+  static const char *GetPhaseName(Phase phase);
+
+  // Every random draw comes from one generator seeded here, so a fixed
+  // seed gives bit-identical runs for a given build, pair-kernel ISA and
+  // dt sequence, whatever the thread count
+  LiquidSimulation(float width, float height,
+                   uint32_t seed = std::random_device{}());
 
+  // Runs the phases as a task graph: tasks wait only on the data they
+  // need, so independent phases and chunks of particles overlap
   void Update(float deltaTime);
+  // With false, Update runs the phases one after another as RunPhase
+  // does. Both give identical results.
+  void SetTaskGraphEnabled(bool enabled) { taskGraphEnabled = enabled; }
+  bool IsTaskGraphEnabled() const { return taskGraphEnabled; }
+  // The graph the last Update ran, for inspecting its dependencies
+  const TaskGraph &GetUpdateGraph() const { return updateGraph; }
+  // Later phases read state earlier ones produce (e.g. Forces reads the
+  // neighbor list), so run alone they see the previous step's data
+  void RunPhase(Phase phase, float deltaTime);
   void AddParticle(const glm::vec3 &position, const glm::vec3 &velocity,
                    const glm::vec3 &color);
+  // Appends every particle with one resize per array. The random fields
+  // are hashed from a single RNG draw per call, so large batches fill in
+  // parallel and still give the same result for any thread count.
+  void AddParticles(std::span<const ParticleInit> inits);
+  // Preallocates room for `count` particles in total
+  void Reserve(size_t count);
+  size_t GetCapacity() const { return particles.Capacity(); }
+
+  // Particle pool. Despawn leaves a hole (IsAlive false) and puts the slot
+  // on a free list that Spawn reuses first; both are O(1). Compact fills
+  // the holes by moving particles down from the end, in O(holes). Update
+  // expires particles, then compacts, then emits, so its phases only ever
+  // see live, contiguous particles. Indices stay stable until a Compact.
+  size_t Spawn(const ParticleInit &init); // Returns the particle's index
+  void Despawn(size_t index);
+  void Compact();
+  bool IsAlive(size_t i) const { return particles.IsAlive(i); }
+  size_t GetLiveCount() const { return particles.Size() - freeSlots.size(); }
+  // The moves the last Compact made, in order, and the particle count it
+  // left; callers holding per-particle data replay them to follow along
+  struct ParticleMove {
+    uint32_t from, to;
+  };
+  struct CompactionLog {
+    std::vector<ParticleMove> moves;
+    size_t size = 0;
+  };
+  const CompactionLog &GetLastCompaction() const { return compaction; }
+  // Each step spawns `rate` particles per second near the group centroids,
+  // living `lifetime` seconds each (0 = forever), while fewer than
+  // `maxLive` are alive (0 = no cap). Rate 0, the default, turns it off.
+  void SetEmitter(float rate, float lifetime, size_t maxLive);
+
+  // Binary snapshot of the whole simulation state: particles, centroids,
+  // clocks, physics parameters and RNG state (format in Checkpoint.h).
+  // Loading maps the file and bulk-copies each array, and a loaded
+  // simulation continues exactly as the saved one would have. Both throw
+  // std::runtime_error on I/O or format errors; a failed load leaves the
+  // current state untouched.
+  void SaveCheckpoint(const std::string &path) const;
+  void LoadCheckpoint(const std::string &path);
 
-  const std::vector<LiquidParticle> &GetParticles() const { return particles; }
+  // Gathers the SoA store into AoS records; rebuilt lazily after changes.
+  // Hot paths (rendering) should read GetParticleStore() instead.
+  const std::vector<LiquidParticle> &GetParticles() const;
+  const ParticleStore &GetParticleStore() const { return particles; }
   const std::vector<Wall> &GetWalls() const { return walls; }
-  size_t GetParticleCount() const { return particles.size(); }
+  // Adds a static solid box that particles collide with, like the walls
+  void AddObstacle(const glm::vec3 &position, const glm::vec3 &size);
+  // Signed distance to the walls and obstacles, which drives wall collisions
+  const SignedDistanceField &GetWallField() const { return wallField; }
+  size_t GetParticleCount() const { return particles.Size(); }
   void SetGravity(const glm::vec3& g) { gravity = g.y; }
   void SetDamping(float d) { damping = d; }
+  // SPH pressure is stiffness * (density - restDensity), never negative;
+  // densities are mass per unit volume over smoothingRadius
+  void SetPressure(float stiffness, float rest) { pressureConstant = stiffness; restDensity = rest; }
+  void SetViscosity(float v) { viscosityConstant = v; }
+  // As of the last Density phase
+  float GetDensity(size_t i) const { return densities[i]; }
+  float GetPressure(size_t i) const { return pressureRatios[i] * densities[i] * densities[i]; }
+  // Results are identical for any thread count; 0 uses the OpenMP default
+  void SetThreadCount(int count) { threadCount = count; }
+  int GetThreadCount() const;
+  uint32_t GetSeed() const { return seed; }
+  float GetTime() const { return globalTime; } // Simulated seconds
+  void SetCollisionIterations(int iterations) { collisionIterations = std::max(iterations, 1); }
+  // Exact matches a per-pair count; Approximate counts whole grid cells
+  void SetColorCountMode(GroupHistogram::Mode mode) { colorCountMode = mode; }
+  // Defaults to the best variant the CPU supports
+  void SetPairKernelIsa(PairKernelIsa isa) { pairKernelIsa = isa; pairKernel = GetPairKernel(isa); }
+  PairKernelIsa GetPairKernelIsa() const { return pairKernelIsa; }
+  // Nearest group centroid by color, cached per particle
+  static constexpr uint8_t NoGroup = 0xFF;
+  // Memberships are refreshed once a centroid color, or the particle's own,
+  // has moved this far from the color they were computed against
+  static constexpr float MembershipColorTolerance = 0.02f;
+  size_t GetGroupCount() const { return groupCentroids.size(); }
+  const glm::vec3 &GetGroupColor(uint8_t group) const { return groupCentroids[group].color; }
+  uint8_t GetParticleGroup(size_t i) const { return particleGroup[i]; }
+  float GetParticleGroupDistance(size_t i) const { return particleGroupDistance[i]; }
+  // Per-group member count, position and velocity sums, bounds and the
+  // strong member (color within 0.3) nearest the centroid, indexed like
+  // the groups. Refreshed by the GroupStats phase at the end of each step.
+  const std::vector<GroupStats> &GetGroupStats() const { return groupStats; }
 
 private:
   void InitializeParticles();
   void InitializeWalls();
+  // Floor, ceiling and four sides spanning width x height, centered on x = 0
+  static std::vector<Wall> BoxWalls(float width, float height);
+  static constexpr size_t BoxWallCount = 6; // Leading entries of walls
   void CreateCompoundShape(const glm::vec3& center, const glm::vec3& color, int shapeType);
+  // Builds and runs the Update task graph
+  void RunTaskGraph(float deltaTime);
+  // Phases over every particle, and the per-range parts the task graph
+  // runs as chunks. Serial setup and follow-up steps are split out.
+  void BuildNeighborList();
+  void PrepareNeighborList();           // Grid, then starts the list
+  void CountNeighbors(size_t begin, size_t end);
+  void FillNeighbors(size_t begin, size_t end);
+  void ComputeDensities();
+  void PrepareDensities();              // Sizes the density arrays
+  void ComputeDensities(size_t begin, size_t end);
   void ApplyForces(float deltaTime);
+  void PrepareForces();                 // Scratch and random draws
+  void ApplyForces(size_t begin, size_t end, float deltaTime);
+  void FinishForces();                  // Swaps velocities, queues waves
   void UpdatePositions(float deltaTime);
+  void UpdatePositions(size_t begin, size_t end, float deltaTime);
   void UpdateColors(float deltaTime);
+  void BuildColorHistogram();
+  void PickTargetColors(size_t begin, size_t end);
+  void ApplyColorTransitions(size_t begin, size_t end, float deltaTime);
   void UpdateCentroids(float deltaTime);
+  void MoveCentroids(float deltaTime);  // Flags memberships for a refresh
   void UpdateWaves(float deltaTime);
-  void PropagateWave(size_t sourceIndex, float intensity);
+  void UpdateWaves(size_t begin, size_t end, float deltaTime);
+  void QueueWave(size_t sourceIndex, float intensity);
+  void PropagateWaves(float deltaTime);
+  void InjectWaveEvents(); // Into their source group's channel, then clears them
+  void PropagateWaves(size_t begin, size_t end);
+  // Over the walls, one channel per group
+  static void ConfigureWaveField(WaveField &field, const std::vector<Wall> &walls, size_t channels);
   void ResolveCollisions();
   void HandleWallCollisions();
+  void HandleWallCollisions(size_t begin, size_t end);
   void SpawnNewParticle();
-  glm::vec3 CalculatePressureForce(size_t particleIndex);
-  glm::vec3 CalculateViscosityForce(size_t particleIndex);
+  void ExpireParticles();
+  void QueueExpiry(size_t i);       // If particle i is mortal
+  void EmitParticles(float deltaTime);
+  // Fills slot i from `init`, hashing the random fields from `key`
+  void InitializeSlot(size_t i, const ParticleInit &init, uint64_t key);
+  void UpdateGroupMembership(size_t particleIndex);
+  void RefreshGroupMembership();        // Against the current centroid colors
+  void RefreshGroupMembership(size_t begin, size_t end);
+  void SnapshotMembershipColors();
+  void UpdateGroupStats();
+  // Drops a group representative whose slot was despawned or reused
+  void ForgetRepresentative(size_t index);
+  void PrepareGroupStats();
+  void GatherGroupStats(size_t chunk);
+  void MergeGroupStats();
+  // Particles count toward their group only when close to its color
+  uint8_t CountedGroup(size_t i) const {
+    return particleGroupDistance[i] < 0.5f ? particleGroup[i] : GroupHistogram::Uncounted;
+  }
 
-  std::vector<LiquidParticle> particles;
+  ParticleStore particles;
+  mutable std::vector<LiquidParticle> particleView; // GetParticles() gather
+  mutable bool particleViewDirty = true;
   std::vector<Wall> walls;
-  std::vector<size_t> neighbors;
+  SignedDistanceField wallField; // Rebaked whenever walls change
+  static constexpr float WallFieldCellSize = 0.25f;
+
+  // Neighbor search runs once per step; every pair phase reads the list.
+  // Forces read every entry within interactionRadius, densities only the
+  // inner ones within smoothingRadius.
+  SpatialGrid grid;          // Cell size = interactionRadius
+  NeighborList neighborList; // Distances as of the start of the step
+  
+  // SPH density per particle, from the neighbor list, with the 1 / rho
+  // and p / rho^2 the force pass reads for both sides of every pair
+  std::vector<float> densities, inverseDensities, pressureRatios;
+  SphKernel smoothingKernel;
+  
+  // ApplyForces scratch: velocities are written here and swapped in so the
+  // parallel loop only ever reads the previous step's neighbor state.
+  // Random draws are made serially up front to keep results thread-count
+  // independent, and wave triggers are applied after the loop.
+  std::vector<float> nextVx, nextVy, nextVz;
+  std::vector<glm::vec3> explorationNoise;
+  std::vector<int> waveRolls;
+  std::vector<uint8_t> waveTriggered;
+  
+  // Phases only queue wave events; PropagateWaves injects the whole batch
+  // into the field at the end of the step, steps it, and every particle
+  // samples its own group's channel, so no phase writes into other particles.
+  struct WaveEvent {
+    uint32_t source;
+    float intensity;
+  };
+  std::vector<WaveEvent> waveEvents;
+  WaveField waveField;
+  
+  ContactSolver contactSolver;
+  int collisionIterations = 1;
   
   // Group centroid tracking
   struct GroupCentroid {
@@ -61,6 +271,28 @@ private:
     float phase; // For movement patterns
   };
   std::vector<GroupCentroid> groupCentroids;
+  
+  // Nearest centroid and its color distance, per particle, measured
+  // against membershipColors from the particle's color at the time,
+  // particleMembershipColor. Refreshed when UpdateColors moves a color
+  // past the tolerance, or for everyone when a centroid color does.
+  std::vector<uint8_t> particleGroup;
+  std::vector<float> particleGroupDistance;
+  std::vector<glm::vec3> particleMembershipColor;
+  std::vector<glm::vec3> membershipColors;
+  bool membershipStale = false; // Set by MoveCentroids for this step
+  
+  // GetGroupStats() results, and the per-chunk partials they merge
+  std::vector<GroupStats> groupStats;
+  std::vector<GroupStats> groupStatsChunks;
+  
+  // Group member counts for the UpdateColors takeover rule
+  GroupHistogram colorHistogram;
+  GroupHistogram::Mode colorCountMode = GroupHistogram::Mode::Exact;
+  
+  // Rebuilt by every Update; storage is reused
+  TaskGraph updateGraph;
+  bool taskGraphEnabled = true;
 
   float width, height;
   float gravity;
@@ -69,16 +301,31 @@ private:
   float restDensity;
   float smoothingRadius;
   float damping;
+  int threadCount = 0;
+  PairKernelIsa pairKernelIsa = GetSupportedPairKernelIsa();
+  PairKernelFn pairKernel = GetPairKernel(pairKernelIsa);
 
+  uint32_t seed;
   std::mt19937 rng;
   std::uniform_real_distribution<float> colorDist;
   std::uniform_real_distribution<float> positionDist;
   std::uniform_real_distribution<float> unitDist;  // 0.0 to 1.0
   std::uniform_int_distribution<int> percentDist; // 0 to 99
   
-  float timeSinceLastSpawn;
-  const float spawnInterval = 0.05f; // More frequent spawning for better coverage
-  const size_t maxParticles = 800; // More particles to fill the screen
+  // Pool and emitter state
+  std::vector<uint32_t> freeSlots; // Holes left by Despawn, reused LIFO
+  CompactionLog compaction;
+  // (expireTime, slot) of every mortal particle, soonest first. Entries go
+  // stale when their slot is despawned, moved or reused; ExpireParticles
+  // skips any whose slot no longer expires at that time.
+  using ExpiryEntry = std::pair<float, uint32_t>;
+  std::priority_queue<ExpiryEntry, std::vector<ExpiryEntry>, std::greater<>> expiryQueue;
+  float emitRate = 0.0f;
+  float emitLifetime = 0.0f;
+  size_t emitMaxLive = 0;
+  float timeSinceLastSpawn;        // Emitter time not yet spent on spawns
+  const float interactionRadius = 5.0f; // Boid neighborhood radius
+  const float colorRadius = 2.0f;       // Color takeover neighborhood
   
   float globalTime; // Global time for synchronized animations
 };
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only memory mapping of a whole file, unmapped on destruction.
+// Throws std::runtime_error if the file can't be opened or mapped.
+class MappedFile {
+public:
+  explicit MappedFile(const std::string &path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const uint8_t *GetData() const { return data; }
+  size_t GetSize() const { return size; }
+
+  // Hints that [offset, offset + bytes) will be read soon, so the kernel
+  // can start paging it in
+  void Prefetch(size_t offset, size_t bytes) const;
+
+private:
+  const uint8_t *data = nullptr;
+  size_t size = 0;
+};
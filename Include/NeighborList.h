@@ -0,0 +1,135 @@
+#pragma once
+#include "SpatialGrid.h"
+#include <glm/glm.hpp>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Per-step neighbor list in CSR form: the neighbors of point i within
+// `radius` are entries [GetBegin(i), GetEnd(i)), stored as indices only.
+// Those also within `innerRadius` come first, [GetBegin(i), GetInnerEnd(i)),
+// and only they cache their distance at build time, so the wide radius
+// costs four bytes per pair.
+class NeighborList {
+public:
+  // Count, prefix sum, fill: parallel over points, yet every row comes out
+  // in the order a serial build would give
+  template <typename PositionFn>
+  void Build(const SpatialGrid &grid, size_t count, float radius,
+             float innerRadius, PositionFn &&positionOf, int threadCount = 1);
+
+  // Build in steps, for callers that schedule the ranges themselves:
+  // Start, Count every range, Allocate, then Fill every range. Ranges of
+  // one step may run concurrently.
+  void Start(size_t count, float radius, float innerRadius);
+  template <typename PositionFn>
+  void Count(const SpatialGrid &grid, size_t begin, size_t end, PositionFn &&positionOf);
+  void Allocate(); // Prefix sums, then sizes the entry arrays
+  template <typename PositionFn>
+  void Fill(const SpatialGrid &grid, size_t begin, size_t end, PositionFn &&positionOf);
+
+  size_t GetBegin(size_t i) const { return offsets[i]; }
+  size_t GetEnd(size_t i) const { return offsets[i + 1]; }
+  size_t GetInnerEnd(size_t i) const {
+    return offsets[i] + (innerOffsets[i + 1] - innerOffsets[i]);
+  }
+  uint32_t GetIndex(size_t entry) const { return indices[entry]; }
+  const uint32_t *GetIndexData() const { return indices.data(); }
+  // Distance of inner entry `entry` of point i
+  float GetDistance(size_t i, size_t entry) const {
+    return distances[innerOffsets[i] + (entry - offsets[i])];
+  }
+
+  size_t GetPointCount() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+  size_t GetEntryCount() const { return indices.size(); }
+  size_t GetInnerEntryCount() const { return distances.size(); }
+
+private:
+  // fn(j, squared distance, within innerRadius) for each neighbor of i
+  template <typename PositionFn, typename Fn>
+  void ForEachNeighbor(const SpatialGrid &grid, size_t i, PositionFn &positionOf, Fn &&fn) const;
+
+  float radius = 0.0f, innerRadius = 0.0f;
+  std::vector<size_t> offsets;      // Size count + 1
+  std::vector<size_t> innerOffsets; // Into distances, size count + 1
+  std::vector<uint32_t> indices;
+  std::vector<float> distances;     // Inner entries only
+};
+
+template <typename PositionFn>
+void NeighborList::Build(const SpatialGrid &grid, size_t count, float radius,
+                         float innerRadius, PositionFn &&positionOf,
+                         int threadCount) {
+  Start(count, radius, innerRadius);
+  #pragma omp parallel for schedule(dynamic, 64) num_threads(threadCount)
+  for (size_t i = 0; i < count; ++i) {
+    Count(grid, i, i + 1, positionOf);
+  }
+  Allocate();
+  #pragma omp parallel for schedule(dynamic, 64) num_threads(threadCount)
+  for (size_t i = 0; i < count; ++i) {
+    Fill(grid, i, i + 1, positionOf);
+  }
+}
+
+inline void NeighborList::Start(size_t count, float radius, float innerRadius) {
+  this->radius = radius;
+  this->innerRadius = innerRadius;
+  offsets.assign(count + 1, 0);
+  innerOffsets.assign(count + 1, 0);
+}
+
+template <typename PositionFn>
+void NeighborList::Count(const SpatialGrid &grid, size_t begin, size_t end,
+                         PositionFn &&positionOf) {
+  for (size_t i = begin; i < end; ++i) {
+    size_t found = 0, inner = 0;
+    ForEachNeighbor(grid, i, positionOf, [&](size_t, float, bool isInner) {
+      ++found;
+      inner += isInner;
+    });
+    offsets[i + 1] = found;
+    innerOffsets[i + 1] = inner;
+  }
+}
+
+inline void NeighborList::Allocate() {
+  for (size_t i = 0; i + 1 < offsets.size(); ++i) {
+    offsets[i + 1] += offsets[i];
+    innerOffsets[i + 1] += innerOffsets[i];
+  }
+  indices.resize(offsets.back());
+  distances.resize(innerOffsets.back());
+}
+
+template <typename PositionFn>
+void NeighborList::Fill(const SpatialGrid &grid, size_t begin, size_t end,
+                        PositionFn &&positionOf) {
+  for (size_t i = begin; i < end; ++i) {
+    size_t innerSlot = offsets[i];
+    size_t outerSlot = GetInnerEnd(i);
+    size_t distanceSlot = innerOffsets[i];
+    ForEachNeighbor(grid, i, positionOf, [&](size_t j, float distSq, bool isInner) {
+      if (isInner) {
+        indices[innerSlot++] = static_cast<uint32_t>(j);
+        distances[distanceSlot++] = std::sqrt(distSq);
+      } else {
+        indices[outerSlot++] = static_cast<uint32_t>(j);
+      }
+    });
+  }
+}
+
+template <typename PositionFn, typename Fn>
+void NeighborList::ForEachNeighbor(const SpatialGrid &grid, size_t i,
+                                   PositionFn &positionOf, Fn &&fn) const {
+  const float radiusSq = radius * radius;
+  const float innerRadiusSq = innerRadius * innerRadius;
+  const glm::vec3 pi = positionOf(i);
+  grid.ForEachCandidate(pi, radius, [&](size_t j) {
+    if (j == i) return;
+    const glm::vec3 diff = positionOf(j) - pi;
+    const float distSq = glm::dot(diff, diff);
+    if (distSq < radiusSq) fn(j, distSq, distSq < innerRadiusSq);
+  });
+}
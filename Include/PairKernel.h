@@ -0,0 +1,69 @@
+#pragma once
+#include "SphKernel.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+
+// Fused per-pair interaction kernel for ApplyForces: one particle against a
+// block of neighbors, producing the boid terms and the SPH pressure and
+// viscosity terms in a single pass. Densities come in pre-divided from the
+// density pass, so the kernels never divide by them. SIMD variants evaluate
+// 8 (AVX2) or 16 (AVX-512) neighbors at once using squared-distance masks;
+// the variant is picked at runtime from CPUID so a single binary runs
+// everywhere.
+
+enum class PairKernelIsa { Scalar, AVX2, AVX512 };
+
+struct PairSubject {
+  glm::vec3 position;
+  glm::vec3 velocity;
+  glm::vec3 color;
+  float mass;
+  float radius;
+  float pressureRatio;  // pressure / density^2
+};
+
+// Neighbor data is read straight from the particle store's arrays
+struct PairNeighbors {
+  const float *x, *y, *z;
+  const float *vx, *vy, *vz;
+  const float *mass;
+  const float *radius;
+  const float *color;       // Interleaved rgb, 3 floats per particle
+  const float *inverseDensity;
+  const float *pressureRatio; // pressure / density^2
+  const uint32_t *indices;  // Neighbors to evaluate
+  size_t count;
+};
+
+struct PairKernelParams {
+  float interactionRadius;  // Boid separation/alignment/cohesion
+  SphKernel smoothing;      // Pressure and viscosity
+};
+
+struct PairAccumulator {
+  glm::vec3 separation{0.0f};
+  glm::vec3 alignment{0.0f};
+  glm::vec3 cohesion{0.0f};
+  float totalWeight = 0.0f;
+  glm::vec3 pressure{0.0f};   // Acceleration from symmetric SPH pressure
+  glm::vec3 viscosity{0.0f};  // Multiply by viscosity / own density
+};
+
+using PairKernelFn = void (*)(const PairSubject &, const PairNeighbors &,
+                              const PairKernelParams &, PairAccumulator &);
+
+// Best variant this CPU supports
+PairKernelIsa GetSupportedPairKernelIsa();
+// Falls back to scalar if the requested variant isn't compiled in
+PairKernelFn GetPairKernel(PairKernelIsa isa);
+const char *GetPairKernelName(PairKernelIsa isa);
+
+void EvaluatePairsScalar(const PairSubject &subject, const PairNeighbors &neighbors,
+                         const PairKernelParams &params, PairAccumulator &acc);
+#if defined(__x86_64__) || defined(__i386__)
+void EvaluatePairsAVX2(const PairSubject &subject, const PairNeighbors &neighbors,
+                       const PairKernelParams &params, PairAccumulator &acc);
+void EvaluatePairsAVX512(const PairSubject &subject, const PairNeighbors &neighbors,
+                         const PairKernelParams &params, PairAccumulator &acc);
+#endif
@@ -0,0 +1,68 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <limits>
+#include <vector>
+
+// Array-of-structs view of one particle, used for AddParticle and the
+// GetParticles() compatibility gather.
+struct LiquidParticle {
+  glm::vec3 position;
+  glm::vec3 velocity;
+  glm::vec3 color;
+  glm::vec3 targetColor;  // For smooth color transitions
+  float radius;
+  float baseRadius;       // Original radius before wave effects
+  float mass;
+  float colorTransitionSpeed;
+  float wavePhase;        // Phase for wave propagation
+  float waveAmplitude;    // Current wave amplitude
+  float waveDecay;        // How fast the wave decays
+  float expireTime = std::numeric_limits<float>::infinity(); // Simulation time
+};
+
+// Structure-of-arrays particle storage. The fields every pair loop reads
+// (position, velocity, mass, radius) each get their own contiguous array so
+// those loops don't drag the color-transition and wave state through cache.
+struct ParticleStore {
+  // Hot: read per neighbor pair
+  std::vector<float> x, y, z;
+  std::vector<float> vx, vy, vz;
+  std::vector<float> mass;
+  std::vector<float> radius;
+
+  // Warm: read per pair by the color-weighted forces
+  std::vector<glm::vec3> color;
+
+  // Cold: per-particle only
+  std::vector<glm::vec3> targetColor;
+  std::vector<float> colorTransitionSpeed;
+  std::vector<float> baseRadius;
+  std::vector<float> wavePhase;
+  std::vector<float> waveAmplitude;
+  std::vector<float> waveDecay;
+  // Simulation time the particle expires at: NoExpiry for never, Dead for
+  // a despawned slot waiting to be reused or compacted away
+  std::vector<float> expireTime;
+
+  static constexpr float NoExpiry = std::numeric_limits<float>::infinity();
+  static constexpr float Dead = -std::numeric_limits<float>::infinity();
+
+  size_t Size() const { return x.size(); }
+  bool Empty() const { return x.empty(); }
+  bool IsAlive(size_t i) const { return expireTime[i] != Dead; }
+
+  glm::vec3 GetPosition(size_t i) const { return glm::vec3(x[i], y[i], z[i]); }
+  glm::vec3 GetVelocity(size_t i) const { return glm::vec3(vx[i], vy[i], vz[i]); }
+  void SetPosition(size_t i, const glm::vec3 &p) { x[i] = p.x; y[i] = p.y; z[i] = p.z; }
+  void SetVelocity(size_t i, const glm::vec3 &v) { vx[i] = v.x; vy[i] = v.y; vz[i] = v.z; }
+
+  void Reserve(size_t count);
+  size_t Capacity() const { return x.capacity(); }
+  // Grows or shrinks every array; new entries are zeroed
+  void Resize(size_t count);
+  void Clear();
+  void Add(const LiquidParticle &particle);
+  // Copies every field of particle `from` over particle `to`
+  void Move(size_t from, size_t to);
+  LiquidParticle Get(size_t i) const;
+};
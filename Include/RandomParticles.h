@@ -0,0 +1,15 @@
+#pragma once
+#include "Config.h"
+#include <random>
+
+class LiquidSimulation;
+
+// Adds particles [begin, end) of the standard random workload: spread over
+// the config's area with random velocities and bright palette colors. The
+// windowed app and the headless runner both start from it.
+void AddRandomParticles(LiquidSimulation &simulation, const Config &config,
+                        int begin, int end, std::mt19937 &gen);
+
+// Generator for the workload, derived from the simulation's seed but on a
+// different stream than the simulation's own draws
+std::mt19937 MakeWorkloadGenerator(uint32_t seed);
@@ -6,7 +6,9 @@
 #include <vector>
 
 class LiquidSimulation;
+class SimulationStepper;
 class Wall;
+struct TrajectoryFrame;
 
 class Renderer {
 public:
@@ -15,6 +17,10 @@ public:
 
   void Begin(const glm::mat4 &view, const glm::mat4 &projection);
   void RenderLiquid(const LiquidSimulation &simulation);
+  // Positions interpolated between the stepper's last two states
+  void RenderLiquid(const SimulationStepper &stepper);
+  // A recorded frame, for replay without a simulation
+  void RenderLiquid(const TrajectoryFrame &frame);
   void RenderWalls(const std::vector<Wall> &walls);
   void End();
 
@@ -25,11 +31,15 @@ private:
 
   void InitializeLiquidBuffers();
   void InitializeWallBuffers();
+  void DrawLiquid(const LiquidSimulation &simulation, const SimulationStepper *stepper);
+  // Uploads liquidVertices and draws them as points
+  void DrawLiquidVertices();
 
   GLuint liquidShader;
   GLuint wallShader;
 
   GLuint liquidVAO, liquidVBO;
+  std::vector<float> liquidVertices; // Reused each frame
   GLuint wallVAO, wallVBO, wallEBO;
 
   glm::mat4 currentView;
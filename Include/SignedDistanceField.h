@@ -0,0 +1,48 @@
+#pragma once
+#include "Wall.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+// Signed distance to a set of solid boxes, baked once into a grid of
+// samples and read back with trilinear interpolation. Positive in open
+// space, negative in solids. Space a closed set of walls encloses is
+// open and everything outside it counts as solid, so a particle that
+// gets out is pushed back in rather than lost; boxes that enclose
+// nothing are plain obstacles in open space. Samples are exact on the
+// open side and accurate to about half a cell inside solids.
+class SignedDistanceField {
+public:
+  // Upper bound on samples; large scenes get a coarser cell size
+  static constexpr size_t MaxSamples = size_t(1) << 22;
+
+  void Bake(const std::vector<Wall> &walls, float cellSize);
+  bool IsEmpty() const { return values.empty(); }
+
+  // Distance at `position`, and in `gradient` the direction it grows
+  // fastest (out of the nearest solid, not normalized). Points beyond
+  // the grid read its nearest edge, further in by the gap.
+  float Sample(const glm::vec3 &position, glm::vec3 &gradient) const;
+  // Sample over `count` points held as separate coordinate arrays, as
+  // ParticleStore keeps them; gives exactly what Sample gives per point
+  void SampleBatch(const float *x, const float *y, const float *z, size_t count,
+                   float *distance, float *gradientX, float *gradientY,
+                   float *gradientZ) const;
+
+  float GetCellSize() const { return cellSize; }
+  int GetDimension(int axis) const { return dims[axis]; }
+
+private:
+  size_t SampleIndex(int x, int y, int z) const {
+    return (size_t(z) * dims[1] + y) * dims[0] + x;
+  }
+  glm::vec3 SamplePosition(int x, int y, int z) const {
+    return origin + glm::vec3(float(x), float(y), float(z)) * cellSize;
+  }
+
+  glm::vec3 origin{0.0f}; // Position of sample (0, 0, 0)
+  float cellSize = 1.0f, inverseCellSize = 1.0f;
+  int dims[3] = {0, 0, 0};
+  std::vector<float> values;
+  bool outsideIsSolid = false; // The boxes enclose some open space
+};
@@ -0,0 +1,48 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+
+class LiquidSimulation;
+
+// Drives a simulation at a fixed timestep regardless of frame rate.
+// Frame time goes into an accumulator that is drained in whole steps, at
+// most maxSubsteps per frame; anything beyond that is dropped so a slow
+// frame can't snowball. The positions before the last step are kept so
+// rendering can interpolate between the last two states.
+class SimulationStepper {
+public:
+  explicit SimulationStepper(LiquidSimulation &simulation,
+                             float fixedTimestep = 1.0f / 60.0f,
+                             int maxSubsteps = 4);
+
+  // Returns the number of steps taken
+  int Advance(float frameTime);
+
+  // Fraction of a step left in the accumulator, in [0, 1)
+  float GetAlpha() const { return accumulator / fixedTimestep; }
+  // Between the previous and current state by GetAlpha(). Particles added
+  // since the last step have no previous state and use their current one.
+  glm::vec3 GetInterpolatedPosition(size_t i) const;
+
+  void SetFixedTimestep(float dt);
+  float GetFixedTimestep() const { return fixedTimestep; }
+  void SetMaxSubsteps(int steps);
+  int GetMaxSubsteps() const { return maxSubsteps; }
+  // Simulated time lost to the substep cap since construction
+  double GetDroppedTime() const { return droppedTime; }
+
+  LiquidSimulation &GetSimulation() { return simulation; }
+  const LiquidSimulation &GetSimulation() const { return simulation; }
+
+private:
+  void SnapshotPositions();
+  // Applies the last step's particle compaction to the snapshot
+  void FollowCompaction();
+
+  LiquidSimulation &simulation;
+  float fixedTimestep;
+  int maxSubsteps;
+  float accumulator = 0.0f;
+  double droppedTime = 0.0;
+  std::vector<float> previousX, previousY, previousZ;
+};
@@ -0,0 +1,68 @@
+#pragma once
+#include "Trajectory.h"
+#include "TripleBuffer.h"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+class LiquidSimulation;
+class SimulationStepper;
+
+// Steps a simulation on its own thread, in real time, and publishes a
+// frame of render state after every batch of steps. The render thread
+// draws whichever frame was published last, so a slow step no longer
+// holds up input or presentation and the physics no longer waits on
+// vsync. Frames are handed over through a triple buffer: publishing and
+// acquiring never block each other.
+//
+// While running, the thread owns the simulation and its stepper; touch
+// them from elsewhere only through the step callback or after Stop().
+class SimulationThread {
+public:
+  // Called on the simulation thread after each batch of steps
+  using StepCallback = std::function<void(LiquidSimulation &simulation, int steps)>;
+
+  explicit SimulationThread(SimulationStepper &stepper);
+  // Stops the thread
+  ~SimulationThread();
+
+  SimulationThread(const SimulationThread &) = delete;
+  SimulationThread &operator=(const SimulationThread &) = delete;
+
+  void SetStepCallback(StepCallback callback) { onSteps = std::move(callback); }
+
+  // Publishes the current state, then steps from now on. No-op if running.
+  void Start();
+  // Finishes the batch in progress and joins the thread
+  void Stop();
+  bool IsRunning() const { return thread.joinable(); }
+  // If the thread died on an exception, rethrows it (once)
+  void RethrowIfFailed();
+
+  // Render thread: the latest published frame. Positions are interpolated
+  // as SimulationStepper::GetInterpolatedPosition does. Stays valid until
+  // the next call.
+  const TrajectoryFrame &AcquireFrame();
+  // Frames published since Start
+  uint64_t GetPublishedCount() const { return published.load(std::memory_order_relaxed); }
+
+private:
+  void Run();
+  void Publish();
+
+  SimulationStepper &stepper;
+  StepCallback onSteps;
+  TripleBuffer<TrajectoryFrame> frames;
+  std::atomic<uint64_t> published{0};
+
+  std::mutex mutex;
+  std::condition_variable wake;
+  bool stopping = false;
+  std::exception_ptr error;
+
+  std::thread thread;
+};
@@ -0,0 +1,140 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Uniform cell grid over a set of points, rebuilt from scratch with a
+// counting sort so every cell's points are contiguous in GetSortedIndices().
+class SpatialGrid {
+public:
+  // Upper bound on allocated cells; sparse, widely spread scenes get a
+  // coarser cell size instead of an unbounded cell array.
+  static constexpr size_t MaxCells = size_t(1) << 21;
+
+  template <typename PositionFn>
+  void Build(size_t count, float minCellSize, PositionFn &&positionOf);
+
+  // Visits every point whose cell lies within `radius` of `point`'s cell.
+  // Candidates still need an exact distance test.
+  template <typename Fn>
+  void ForEachCandidate(const glm::vec3 &point, float radius, Fn &&fn) const;
+
+  // Visits every cell within `radius` of `point`'s cell as
+  // fn(cell, cellMin); its points are [GetCellBegin, GetCellEnd) of
+  // GetSortedIndices().
+  template <typename Fn>
+  void ForEachCell(const glm::vec3 &point, float radius, Fn &&fn) const;
+
+  float GetCellSize() const { return cellSize; }
+  size_t GetCellCount() const { return cellStart.empty() ? 0 : cellStart.size() - 1; }
+  uint32_t GetCellOf(size_t index) const { return cellOf[index]; }
+  uint32_t GetCellBegin(size_t cell) const { return cellStart[cell]; }
+  uint32_t GetCellEnd(size_t cell) const { return cellStart[cell + 1]; }
+  const std::vector<uint32_t> &GetSortedIndices() const { return sortedIndices; }
+
+private:
+  void ComputeLayout(const glm::vec3 &minBound, const glm::vec3 &maxBound,
+                     float minCellSize);
+  int CellCoord(float value, int axis) const;
+  void CellRange(const glm::vec3 &point, float radius, int lo[3], int hi[3]) const;
+
+  glm::vec3 origin{0.0f};
+  float cellSize = 1.0f;
+  int dims[3] = {0, 0, 0};
+
+  std::vector<uint32_t> cellOf;        // Cell of each point
+  std::vector<uint32_t> cellStart;     // Prefix sums, size cells + 1
+  std::vector<uint32_t> sortedIndices; // Point indices grouped by cell
+  std::vector<uint32_t> cursor;        // Scatter positions, reused per build
+};
+
+template <typename PositionFn>
+void SpatialGrid::Build(size_t count, float minCellSize, PositionFn &&positionOf) {
+  glm::vec3 minBound(0.0f), maxBound(0.0f);
+  if (count > 0) {
+    minBound = maxBound = positionOf(0);
+    for (size_t i = 1; i < count; ++i) {
+      const glm::vec3 p = positionOf(i);
+      minBound = glm::min(minBound, p);
+      maxBound = glm::max(maxBound, p);
+    }
+  }
+  ComputeLayout(minBound, maxBound, minCellSize);
+
+  // Counting sort: histogram, exclusive prefix sum, scatter
+  const size_t cellCount = GetCellCount();
+  std::fill(cellStart.begin(), cellStart.end(), 0u);
+  cellOf.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    const glm::vec3 p = positionOf(i);
+    const int cx = CellCoord(p.x, 0);
+    const int cy = CellCoord(p.y, 1);
+    const int cz = CellCoord(p.z, 2);
+    cellOf[i] = static_cast<uint32_t>((cz * dims[1] + cy) * dims[0] + cx);
+    ++cellStart[cellOf[i] + 1];
+  }
+  for (size_t c = 0; c < cellCount; ++c) {
+    cellStart[c + 1] += cellStart[c];
+  }
+  sortedIndices.resize(count);
+  cursor.assign(cellStart.begin(), cellStart.end() - 1);
+  for (size_t i = 0; i < count; ++i) {
+    sortedIndices[cursor[cellOf[i]]++] = static_cast<uint32_t>(i);
+  }
+}
+
+inline int SpatialGrid::CellCoord(float value, int axis) const {
+  const float f = (value - origin[axis]) / cellSize;
+  if (!(f >= 0.0f)) return 0; // Also catches NaN
+  if (f >= static_cast<float>(dims[axis])) return dims[axis] - 1;
+  return static_cast<int>(f);
+}
+
+inline void SpatialGrid::CellRange(const glm::vec3 &point, float radius, int lo[3], int hi[3]) const {
+  const int reach = std::max(1, static_cast<int>(std::ceil(radius / cellSize)));
+  for (int axis = 0; axis < 3; ++axis) {
+    const int c = CellCoord(point[axis], axis);
+    lo[axis] = std::max(c - reach, 0);
+    hi[axis] = std::min(c + reach, dims[axis] - 1);
+  }
+}
+
+template <typename Fn>
+void SpatialGrid::ForEachCandidate(const glm::vec3 &point, float radius, Fn &&fn) const {
+  if (sortedIndices.empty()) return;
+
+  int lo[3], hi[3];
+  CellRange(point, radius, lo, hi);
+
+  for (int z = lo[2]; z <= hi[2]; ++z) {
+    for (int y = lo[1]; y <= hi[1]; ++y) {
+      // Cells along x are adjacent, so the whole row is one contiguous range
+      const size_t rowBase = static_cast<size_t>(z * dims[1] + y) * dims[0];
+      const uint32_t begin = cellStart[rowBase + lo[0]];
+      const uint32_t end = cellStart[rowBase + hi[0] + 1];
+      for (uint32_t k = begin; k < end; ++k) {
+        fn(sortedIndices[k]);
+      }
+    }
+  }
+}
+
+template <typename Fn>
+void SpatialGrid::ForEachCell(const glm::vec3 &point, float radius, Fn &&fn) const {
+  if (sortedIndices.empty()) return;
+
+  int lo[3], hi[3];
+  CellRange(point, radius, lo, hi);
+
+  for (int z = lo[2]; z <= hi[2]; ++z) {
+    for (int y = lo[1]; y <= hi[1]; ++y) {
+      const size_t rowBase = static_cast<size_t>(z * dims[1] + y) * dims[0];
+      for (int x = lo[0]; x <= hi[0]; ++x) {
+        const glm::vec3 cellMin = origin + glm::vec3(x, y, z) * cellSize;
+        fn(rowBase + x, cellMin);
+      }
+    }
+  }
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cmath>
+
+// The standard SPH smoothing kernels (Mueller et al. 2003) for a support
+// radius h: poly6 for density, the spiky kernel's gradient for pressure
+// and the viscosity kernel's Laplacian. Their normalization constants are
+// computed once per radius; every kernel is zero at and beyond h.
+struct SphKernel {
+  SphKernel() = default;
+  explicit SphKernel(float h)
+      : radius(h), radiusSq(h * h),
+        poly6(315.0f / (64.0f * Pi * std::pow(h, 9.0f))),
+        spikyGradient(-45.0f / (Pi * std::pow(h, 6.0f))),
+        viscosityLaplacian(45.0f / (Pi * std::pow(h, 6.0f))) {}
+
+  // W(r), taking r squared so callers can skip the square root
+  float Density(float distSq) const {
+    const float d = radiusSq - distSq;
+    return d > 0.0f ? poly6 * d * d * d : 0.0f;
+  }
+  // dW/dr, negative: the gradient at i points away from the neighbor
+  float PressureGradient(float dist) const {
+    const float d = radius - dist;
+    return d > 0.0f ? spikyGradient * d * d : 0.0f;
+  }
+  float Viscosity(float dist) const {
+    const float d = radius - dist;
+    return d > 0.0f ? viscosityLaplacian * d : 0.0f;
+  }
+
+  static constexpr float Pi = 3.14159265358979f;
+  float radius = 0.0f, radiusSq = 0.0f;
+  float poly6 = 0.0f;              // 315 / (64 pi h^9)
+  float spikyGradient = 0.0f;      // -45 / (pi h^6), times (h - r)^2
+  float viscosityLaplacian = 0.0f; // 45 / (pi h^6), times (h - r)
+};
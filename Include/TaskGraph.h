@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+// A graph of tasks with explicit dependencies, run on the OpenMP task
+// scheduler. A task starts as soon as the tasks it depends on are done,
+// so independent work overlaps instead of waiting at a barrier after
+// every parallel loop.
+//
+// Chunked tasks split their work into chunks that run as separate tasks.
+// A chunked task can depend on another chunk by chunk ("alongside"): its
+// chunk k then only waits for the other's chunk k, which lets a loop over
+// particles start on the chunks an earlier loop has finished.
+//
+// Exclusive tasks run alone on the calling thread between the tasks added
+// before them and those added after, and can use parallel loops of their
+// own, for work that has no useful finer dependencies.
+class TaskGraph {
+public:
+  using Task = size_t;
+
+  TaskGraph() = default;
+  // Copies start empty: tasks tend to capture their owner, which a copy
+  // of the owner would have to rebuild them for anyway
+  TaskGraph(const TaskGraph &) {}
+  TaskGraph &operator=(const TaskGraph &) {
+    Clear();
+    return *this;
+  }
+
+  // Dependencies must be tasks added earlier. Ones from before the last
+  // exclusive task are already met and are ignored.
+  Task Add(const char *name, std::function<void()> body,
+           std::initializer_list<Task> after = {});
+  // Runs body(chunk) for every chunk in [0, chunkCount). Each chunk waits
+  // for all of `after` and for its own chunk of each task in `alongside`;
+  // an alongside task with a different chunk count is waited on whole.
+  Task AddChunked(const char *name, size_t chunkCount,
+                  std::function<void(size_t chunk)> body,
+                  std::initializer_list<Task> after = {},
+                  std::initializer_list<Task> alongside = {});
+  Task AddExclusive(const char *name, std::function<void()> body);
+
+  // Runs every task once, on up to threadCount threads (0 = OpenMP
+  // default), and returns when all are done
+  void Run(int threadCount);
+  // Removes every task; storage is kept for the next graph
+  void Clear();
+
+  size_t GetTaskCount() const { return tasks.size(); }
+  // The first task named `name`, or GetTaskCount() if there is none
+  Task Find(const char *name) const;
+  // Whether `task` only starts once every chunk of `other` is done, through
+  // dependencies or an exclusive task between them
+  bool IsOrderedAfter(Task task, Task other) const;
+
+private:
+  struct Node {
+    const char *name;
+    std::function<void(size_t)> body;
+    size_t chunkCount;
+    bool exclusive;
+    std::vector<Task> after, alongside;
+    // Filled by Run
+    std::vector<Task> successors, chunkSuccessors;
+    size_t firstItem; // Into pending; every node has at least one item
+  };
+
+  Task AddNode(const char *name, size_t chunkCount, std::function<void(size_t)> body,
+               bool exclusive, std::initializer_list<Task> after,
+               std::initializer_list<Task> alongside);
+  void RunStage(Task begin, Task end, int threadCount);
+  void Spawn(Task task, size_t chunk);
+  void Execute(Task task, size_t chunk);
+  size_t GetItemCount(Task task) const { return tasks[task].chunkCount ? tasks[task].chunkCount : 1; }
+
+  std::vector<Node> tasks;
+  // Unmet dependencies per chunk, and unfinished chunks per task
+  std::unique_ptr<std::atomic<uint32_t>[]> pending, chunksLeft;
+  size_t pendingCapacity = 0, chunksLeftCapacity = 0;
+  // Tasks of the current stage with nothing to wait on, listed before any
+  // task runs: a task released by another one must not be spawned again
+  std::vector<Task> roots;
+};
@@ -0,0 +1,103 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Scoped-timer tracing for hot paths. TRACE_SCOPE("name") records the
+// enclosing scope's start, duration and thread into a fixed-size ring
+// buffer holding the most recent events, which WriteChromeTrace dumps as
+// Chrome/Perfetto trace JSON (open in ui.perfetto.dev or chrome://tracing).
+// The macro compiles to nothing unless CPPLIQUID_TRACING is defined
+// (CMake option CPPLIQUID_TRACING).
+namespace Trace {
+
+#ifdef CPPLIQUID_TRACING
+constexpr bool Enabled = true;
+#else
+constexpr bool Enabled = false;
+#endif
+
+struct Event {
+  const char *name; // Not copied: use string literals
+  uint32_t thread;
+  int64_t startNs; // Since the recorder was created
+  int64_t durationNs;
+};
+
+class Recorder {
+public:
+  static constexpr size_t DefaultCapacity = 1 << 16;
+
+  // Capacity is rounded up to a power of two
+  explicit Recorder(size_t capacity = DefaultCapacity);
+
+  // The recorder TRACE_SCOPE writes to
+  static Recorder &Global();
+
+  // Safe to call from any thread
+  void Record(const char *name, std::chrono::steady_clock::time_point start,
+              std::chrono::steady_clock::time_point end);
+
+  // The retained events, oldest first. Safe while other threads record:
+  // events still being written, or overwritten during the copy, are left
+  // out rather than torn.
+  std::vector<Event> Snapshot() const;
+  void Clear();
+
+  size_t GetCapacity() const { return slots.size(); }
+  // Events recorded since construction or Clear, including overwritten ones
+  uint64_t GetRecordedCount() const {
+    return next.load(std::memory_order_relaxed) - cleared.load(std::memory_order_relaxed);
+  }
+
+  // Returns false if the file can't be written
+  bool WriteChromeTrace(const std::string &path) const;
+
+private:
+  // One ring entry behind a seqlock: sequence is 2 * ticket + 1 while the
+  // event with that ticket is written and 2 * ticket + 2 once it is done
+  struct Slot {
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<const char *> name{nullptr};
+    std::atomic<uint32_t> thread{0};
+    std::atomic<int64_t> startNs{0}, durationNs{0};
+  };
+
+  std::vector<Slot> slots;
+  std::atomic<uint64_t> next{0};    // Ticket of the next event
+  std::atomic<uint64_t> cleared{0}; // First ticket since Clear
+  std::chrono::steady_clock::time_point epoch;
+};
+
+// Small stable id of the calling thread, in order of first use
+uint32_t CurrentThreadId();
+
+class ScopedTimer {
+public:
+  explicit ScopedTimer(const char *name)
+      : name(name), start(std::chrono::steady_clock::now()) {}
+  ~ScopedTimer() {
+    Recorder::Global().Record(name, start, std::chrono::steady_clock::now());
+  }
+
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+private:
+  const char *name;
+  std::chrono::steady_clock::time_point start;
+};
+
+} // namespace Trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef CPPLIQUID_TRACING
+#define TRACE_SCOPE(name)                                                      \
+  ::Trace::ScopedTimer TRACE_CONCAT(traceScope, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name) static_cast<void>(0)
+#endif
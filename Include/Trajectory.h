@@ -0,0 +1,102 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct ParticleStore;
+
+// Per-frame particle state kept by trajectory files: what the renderer
+// needs, nothing the simulation needs to continue (see Checkpoint.h).
+struct TrajectoryFrame {
+  uint64_t sequence = 0; // Capture number; gaps mark dropped frames
+  double time = 0.0;     // Simulation time
+  std::vector<float> x, y, z;
+  std::vector<glm::vec3> color;
+  std::vector<float> radius;
+
+  size_t Size() const { return x.size(); }
+  void Resize(size_t count);
+  // Copies the recorded fields out of the store, reusing capacity
+  void CopyFrom(const ParticleStore &particles);
+};
+
+// Layout of trajectory files: a header, then one chunk per frame (a
+// FrameHeader and its payload), then an index of every chunk. The header
+// points at the index once the recorder closes the file; a file whose
+// recorder died without closing it has indexOffset 0 and readers rebuild
+// the index by walking the chunks. Values use the writer's byte order.
+//
+// Payloads hold x, y, z, color and radius as arrays. Raw files store them
+// as floats. Quantized files store positions as int32 multiples of
+// positionStep, colors as 8-bit rgb and radii as 16-bit multiples of
+// RadiusStep. Delta files are quantized files whose non-keyframes store
+// each position as a zigzag varint of its change since the previous
+// frame; a keyframe is written every keyframeInterval frames and whenever
+// the particle count changes, so readers can seek to any keyframe.
+namespace Trajectory {
+
+constexpr char Magic[8] = {'C', 'P', 'L', 'Q', 'T', 'R', 'A', 'J'};
+constexpr uint32_t Version = 1;
+constexpr uint32_t EndianTag = 0x01020304;
+constexpr uint32_t FrameMagic = 0x454D5246; // "FRME"
+constexpr float RadiusStep = 1.0f / 1024.0f;
+
+enum Flags : uint32_t {
+  Quantized = 1 << 0,
+  Delta = 1 << 1,    // Implies Quantized
+  Keyframe = 1 << 2, // Frame flag only
+};
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t endianTag;
+  uint32_t flags; // Quantized and Delta
+  float positionStep;
+  uint64_t frameCount;  // Valid once indexOffset is set
+  uint64_t indexOffset; // 0 = not closed cleanly
+  uint8_t reserved[24];
+};
+static_assert(sizeof(FileHeader) == 64);
+
+struct FrameHeader {
+  uint32_t magic;
+  uint32_t flags;
+  uint64_t sequence;
+  double time;
+  uint32_t particleCount;
+  uint32_t reserved;
+  uint64_t payloadBytes;
+};
+static_assert(sizeof(FrameHeader) == 40);
+
+struct IndexEntry {
+  uint64_t offset; // Of the FrameHeader
+  double time;
+  uint32_t particleCount;
+  uint32_t flags;
+};
+static_assert(sizeof(IndexEntry) == 24);
+
+// Encodes and decodes frame payloads. Delta frames are relative to the
+// last frame the same codec handled, so a codec must see every frame
+// since the last keyframe, in order.
+class Codec {
+public:
+  Codec(uint32_t fileFlags, float positionStep);
+
+  // Appends the payload to `out` and returns the frame's flags
+  uint32_t Encode(const TrajectoryFrame &frame, bool keyframe,
+                  std::vector<uint8_t> &out);
+  // Returns false on a malformed payload or a delta frame without a base
+  bool Decode(const uint8_t *payload, size_t bytes, uint32_t frameFlags,
+              size_t particleCount, TrajectoryFrame &out);
+
+private:
+  uint32_t fileFlags;
+  float positionStep;
+  std::vector<int32_t> qx, qy, qz; // Quantized positions of the last frame
+};
+
+} // namespace Trajectory
@@ -0,0 +1,58 @@
+#pragma once
+#include "TrajectoryReader.h"
+#include <cstddef>
+#include <string>
+
+// Plays a recorded trajectory back against a clock in simulation time.
+// Advance moves the clock by frame time scaled by the playback speed and
+// decodes whichever recorded frame the clock lands on, so playback speed
+// doesn't depend on the rate the run was recorded at. The frames ahead of
+// the current one are prefetched from the mapping so decoding rarely
+// waits on the disk.
+class TrajectoryPlayer {
+public:
+  // Throws std::runtime_error if the file can't be read or has no frames.
+  // `readAhead` is the number of frames kept prefetched.
+  explicit TrajectoryPlayer(const std::string &path, size_t readAhead = 16);
+
+  // Moves the clock by frameTime * speed (unless paused) and returns true
+  // if that changed the current frame. Stops at either end, or wraps
+  // around when looping.
+  bool Advance(double frameTime);
+
+  // Jump to the last frame at or before `time`, clamped to the recording
+  void Seek(double time);
+  void SeekFrame(size_t frame);
+
+  // Negative speeds play backwards; each step back replays the delta
+  // frames since the preceding keyframe
+  void SetSpeed(double value) { speed = value; }
+  double GetSpeed() const { return speed; }
+  void SetPaused(bool value) { paused = value; }
+  bool IsPaused() const { return paused; }
+  void SetLooping(bool value) { looping = value; }
+  bool IsLooping() const { return looping; }
+
+  double GetTime() const { return clock; }
+  double GetStartTime() const { return reader.GetEntry(0).time; }
+  double GetEndTime() const { return reader.GetEntry(reader.GetFrameCount() - 1).time; }
+  size_t GetFrameIndex() const { return current; }
+  size_t GetFrameCount() const { return reader.GetFrameCount(); }
+  const TrajectoryFrame &GetFrame() const { return frame; }
+  const TrajectoryReader &GetReader() const { return reader; }
+
+private:
+  // Last frame recorded at or before `time`
+  size_t FindFrame(double time) const;
+  void Show(size_t index);
+
+  TrajectoryReader reader;
+  TrajectoryFrame frame;
+  size_t readAhead;
+  size_t current = 0;
+  size_t prefetchedFirst = 0, prefetchedEnd = 0; // Frames already hinted
+  double clock = 0.0;
+  double speed = 1.0;
+  bool paused = false;
+  bool looping = true;
+};
@@ -0,0 +1,39 @@
+#pragma once
+#include "MappedFile.h"
+#include "Trajectory.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Reads trajectory files written by TrajectoryRecorder through a memory
+// mapping. Frames decode straight from the mapped chunks; reading the
+// next frame in order costs one decode, while a jump replays the delta
+// frames since the preceding keyframe.
+class TrajectoryReader {
+public:
+  // Throws std::runtime_error if the file is missing or not a trajectory.
+  // A file that was never closed has its index rebuilt from the chunks,
+  // up to the first incomplete one.
+  explicit TrajectoryReader(const std::string &path);
+
+  size_t GetFrameCount() const { return index.size(); }
+  const Trajectory::IndexEntry &GetEntry(size_t frame) const { return index[frame]; }
+  uint32_t GetFlags() const { return header.flags; }
+  bool WasRecovered() const { return recovered; }
+
+  // Throws std::runtime_error on a corrupt chunk
+  void ReadFrame(size_t frame, TrajectoryFrame &out);
+  // Asks the OS to page in frames [first, first + count) ahead of use
+  void Prefetch(size_t first, size_t count) const;
+
+private:
+  void RebuildIndex();
+  void DecodeFrame(size_t frame, TrajectoryFrame &out);
+
+  MappedFile file;
+  Trajectory::FileHeader header{};
+  std::vector<Trajectory::IndexEntry> index;
+  Trajectory::Codec codec;
+  size_t lastDecoded = SIZE_MAX; // Frame the codec's delta base belongs to
+  bool recovered = false;
+};
@@ -0,0 +1,77 @@
+#pragma once
+#include "Trajectory.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct ParticleStore;
+
+// Records particle trajectories without stalling the caller. Capture
+// copies the state into one of a few preallocated buffers and hands it to
+// a writer thread, which encodes and appends it to the file. If every
+// buffer is still queued (the disk is slower than the simulation) the
+// frame is dropped and counted instead of waiting, so Capture never blocks
+// on I/O.
+class TrajectoryRecorder {
+public:
+  struct Options {
+    bool quantize = false;
+    bool delta = false;            // Implies quantize
+    float positionStep = 0.001f;   // Quantization step, in world units
+    int keyframeInterval = 60;     // Delta files: frames between keyframes
+    int bufferCount = 2;           // Frames in flight; more absorbs bursts
+  };
+
+  // Throws std::runtime_error if the file can't be created
+  TrajectoryRecorder(const std::string &path, const Options &options);
+  explicit TrajectoryRecorder(const std::string &path)
+      : TrajectoryRecorder(path, Options{}) {}
+  // Writes out queued frames and closes the file
+  ~TrajectoryRecorder();
+
+  TrajectoryRecorder(const TrajectoryRecorder &) = delete;
+  TrajectoryRecorder &operator=(const TrajectoryRecorder &) = delete;
+
+  // Returns false if the frame was dropped
+  bool Capture(const ParticleStore &particles, double time);
+
+  // Waits for the writer to finish every queued frame
+  void Flush();
+
+  uint64_t GetCapturedCount() const;
+  uint64_t GetDroppedCount() const;
+  uint64_t GetWrittenCount() const;
+  uint64_t GetBytesWritten() const;
+  // Set if a write failed; later frames are dropped
+  bool HasFailed() const;
+
+private:
+  void WriterLoop();
+  void WriteFrame(const TrajectoryFrame &frame);
+  void Close();
+
+  std::ofstream file;
+  Trajectory::FileHeader header{};
+  Trajectory::Codec codec;
+  int keyframeInterval;
+  std::vector<Trajectory::IndexEntry> index; // Writer thread only
+  std::vector<uint8_t> payload;              // Writer thread only
+
+  mutable std::mutex mutex;
+  std::condition_variable frameQueued;
+  std::condition_variable frameWritten;
+  std::vector<TrajectoryFrame> buffers;
+  std::vector<size_t> freeBuffers;
+  std::deque<size_t> pendingBuffers;
+  bool writing = false; // Writer holds a buffer outside both lists
+  bool stopping = false;
+  bool failed = false;
+  uint64_t captured = 0, dropped = 0, written = 0, bytesWritten = 0;
+
+  std::thread writer; // Last: starts after everything above exists
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Hands values from one writer thread to one reader thread without locks.
+// The writer fills the back slot and publishes it by swapping it with the
+// middle one; the reader swaps the middle slot for its front one when
+// something new was published. Neither side ever waits on the other, and
+// the reader always gets the most recently published value; values it
+// didn't get to in time are overwritten.
+template <typename T>
+class TripleBuffer {
+public:
+  // Writer side: the slot to fill next
+  T &GetBack() { return slots[back]; }
+  // Makes the back slot the latest value
+  void Publish() {
+    const uint8_t previous = middle.exchange(back | FreshBit, std::memory_order_acq_rel);
+    back = previous & IndexMask;
+  }
+
+  // Reader side: takes the latest published value if there is a newer one
+  // than the front slot, and returns whether there was
+  bool Acquire() {
+    if (!(middle.load(std::memory_order_relaxed) & FreshBit)) return false;
+    const uint8_t previous = middle.exchange(front, std::memory_order_acq_rel);
+    front = previous & IndexMask;
+    return true;
+  }
+  // The value last acquired; stays put until the next Acquire
+  const T &GetFront() const { return slots[front]; }
+
+private:
+  static constexpr uint8_t IndexMask = 0x3;
+  static constexpr uint8_t FreshBit = 0x4; // Middle holds an unread value
+
+  T slots[3];
+  uint8_t back = 0;             // Writer thread only
+  std::atomic<uint8_t> middle{1};
+  uint8_t front = 2;            // Reader thread only
+};
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+struct ParticleStore;
+struct TrajectoryFrame;
+class SimulationStepper;
+
+// Interleaved liquid vertex: position xyz, color rgb, point size
+constexpr size_t LiquidVertexFloats = 7;
+
+// Packs one vertex per particle into `vertices` (resized to fit, capacity
+// reused across frames). With a stepper, positions are interpolated
+// between its last two states.
+void PackLiquidVertices(const ParticleStore &particles,
+                        const SimulationStepper *stepper,
+                        std::vector<float> &vertices);
+
+// Packs a recorded frame, for replay
+void PackLiquidVertices(const TrajectoryFrame &frame,
+                        std::vector<float> &vertices);
@@ -0,0 +1,83 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Wave energy on a coarse 3D grid with one channel per color group. Each
+// cell holds its wave as a phasor, amplitude * (cos phase, sin phase), so
+// waves meeting from different directions blend by phase. Events raise
+// the cell they land in, Step spreads every channel to neighboring cells
+// (turning the phase back a little per unit travelled, so farther cells
+// lag behind), advances and decays it, and particles read the field back
+// with a trilinear sample. A step costs O(cells) however many events
+// fired, and its z-slabs run in parallel.
+class WaveField {
+public:
+  struct Params {
+    float cellSize = 2.0f;
+    float spreadRate = 100.0f; // Diffusivity, in units^2 per second
+    float decayRate = 3.0f;    // Fraction lost per second, exponentially
+    float phaseLag = 0.3f;     // Radians per unit of distance travelled
+    float phaseRate = 0.0f;    // Radians per second every wave advances
+  };
+
+  // Covers [minBound, maxBound] with cells of about params.cellSize and
+  // clears every channel. Points outside the bounds use the nearest cell.
+  void Configure(const glm::vec3 &minBound, const glm::vec3 &maxBound,
+                 size_t channelCount, const Params &params);
+  void Clear();
+
+  // Raises the cell at `position` to `amplitude` at `phase`, unless it
+  // already holds a stronger wave
+  void Inject(size_t channel, const glm::vec3 &position, float amplitude, float phase);
+  // Spreads, advances and decays every channel by deltaTime
+  void Step(float deltaTime, int threadCount = 1);
+
+  // Step in parts, for callers that schedule the slabs themselves:
+  // BeginStep, then StepSlabs(substep, ...) over every z range for each
+  // substep in order, then EndStep. The slabs of one substep may run
+  // concurrently; substeps past the ones BeginStep returned are no-ops.
+  int GetSubstepCount(float deltaTime) const;
+  int BeginStep(float deltaTime); // Substeps to run, 0 when quiet
+  void StepSlabs(int substep, int zBegin, int zEnd);
+  void EndStep();
+  // Returns false where the channel is too weak to matter
+  bool Sample(size_t channel, const glm::vec3 &position, float &amplitude, float &phase) const;
+  // Nothing to sample anywhere; set by Step and Inject
+  bool IsQuiet() const { return quiet; }
+
+  size_t GetChannelCount() const { return channelCount; }
+  size_t GetCellCount() const { return size_t(dims[0]) * dims[1] * dims[2]; }
+  int GetDimension(int axis) const { return dims[axis]; }
+  // channel * GetCellCount() + cell; exposed for checkpoints. Call
+  // Refresh after writing to it.
+  std::vector<glm::vec2> &GetPhasors() { return phasors; }
+  const std::vector<glm::vec2> &GetPhasors() const { return phasors; }
+  void Refresh();
+
+  // Amplitudes below this read as silence and are dropped by Step
+  static constexpr float MinAmplitude = 1e-3f;
+
+private:
+  size_t CellIndex(int x, int y, int z) const {
+    return (size_t(z) * dims[1] + y) * dims[0] + x;
+  }
+  glm::vec3 ToGrid(const glm::vec3 &position) const; // In cell units, clamped
+
+  Params params;
+  glm::vec3 origin = glm::vec3(0.0f); // Center of cell (0, 0, 0)
+  int dims[3] = {0, 0, 0};
+  size_t channelCount = 0;
+  std::vector<glm::vec2> phasors, scratch;
+  bool quiet = true;
+
+  // Set by BeginStep for the step in progress
+  struct Stepping {
+    int substeps = 0;
+    float alpha = 0.0f;
+    float rotateCos = 1.0f, rotateSin = 0.0f;   // Phase lag per cell
+    float advanceCos = 1.0f, advanceSin = 0.0f; // Advance and decay
+  } stepping;
+  std::vector<uint8_t> slabLoud; // Per z: anything left after the step
+};
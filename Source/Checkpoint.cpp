@@ -0,0 +1,296 @@
+#include "Checkpoint.h"
+#include "LiquidSimulation.h"
+#include "MappedFile.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// LiquidSimulation::SaveCheckpoint / LoadCheckpoint; format in Checkpoint.h
+
+namespace {
+    using Checkpoint::SectionId;
+    
+    // Calls fn(id, array) for every ParticleStore array, in file order
+    template <typename Store, typename Fn>
+    void ForEachParticleArray(Store& particles, Fn&& fn) {
+        fn(SectionId::X, particles.x);
+        fn(SectionId::Y, particles.y);
+        fn(SectionId::Z, particles.z);
+        fn(SectionId::VX, particles.vx);
+        fn(SectionId::VY, particles.vy);
+        fn(SectionId::VZ, particles.vz);
+        fn(SectionId::Mass, particles.mass);
+        fn(SectionId::Radius, particles.radius);
+        fn(SectionId::Color, particles.color);
+        fn(SectionId::TargetColor, particles.targetColor);
+        fn(SectionId::ColorTransitionSpeed, particles.colorTransitionSpeed);
+        fn(SectionId::BaseRadius, particles.baseRadius);
+        fn(SectionId::WavePhase, particles.wavePhase);
+        fn(SectionId::WaveAmplitude, particles.waveAmplitude);
+        fn(SectionId::WaveDecay, particles.waveDecay);
+        fn(SectionId::ExpireTime, particles.expireTime);
+    }
+    
+    uint64_t AlignUp(uint64_t offset) {
+        return (offset + Checkpoint::Alignment - 1) & ~uint64_t(Checkpoint::Alignment - 1);
+    }
+}
+
+void LiquidSimulation::SaveCheckpoint(const std::string& path) const {
+    TRACE_SCOPE("SaveCheckpoint");
+    static_assert(std::is_trivially_copyable_v<GroupCentroid>);
+    
+    std::ostringstream rngText;
+    rngText << rng;
+    const std::string rngState = rngText.str();
+    
+    // Lay out the sections after the header and table
+    struct Payload {
+        Checkpoint::Section section;
+        const void* data;
+    };
+    std::vector<Payload> payloads;
+    auto addSection = [&](SectionId id, uint32_t elementSize, const void* data, size_t count) {
+        payloads.push_back({{id, elementSize, 0, uint64_t(elementSize) * count}, data});
+    };
+    ForEachParticleArray(particles, [&](SectionId id, const auto& array) {
+        addSection(id, sizeof(array[0]), array.data(), array.size());
+    });
+    addSection(SectionId::Centroids, sizeof(GroupCentroid), groupCentroids.data(), groupCentroids.size());
+    addSection(SectionId::Group, sizeof(uint8_t), particleGroup.data(), particleGroup.size());
+    addSection(SectionId::GroupDistance, sizeof(float), particleGroupDistance.data(), particleGroupDistance.size());
+    addSection(SectionId::MembershipColor, sizeof(glm::vec3), particleMembershipColor.data(),
+               particleMembershipColor.size());
+    addSection(SectionId::MembershipColors, sizeof(glm::vec3), membershipColors.data(), membershipColors.size());
+    const std::vector<glm::vec2>& wavePhasors = waveField.GetPhasors();
+    addSection(SectionId::WaveField, sizeof(glm::vec2), wavePhasors.data(), wavePhasors.size());
+    addSection(SectionId::RngState, 1, rngState.data(), rngState.size());
+    
+    uint64_t offset = AlignUp(sizeof(Checkpoint::Header) + payloads.size() * sizeof(Checkpoint::Section));
+    for (Payload& payload : payloads) {
+        payload.section.offset = offset;
+        offset = AlignUp(offset + payload.section.bytes);
+    }
+    
+    Checkpoint::Header header{};
+    std::memcpy(header.magic, Checkpoint::Magic, sizeof(header.magic));
+    header.version = Checkpoint::Version;
+    header.endianTag = Checkpoint::EndianTag;
+    header.fileSize = offset;
+    header.particleCount = particles.Size();
+    header.groupCount = static_cast<uint32_t>(groupCentroids.size());
+    header.sectionCount = static_cast<uint32_t>(payloads.size());
+    header.seed = seed;
+    header.globalTime = globalTime;
+    header.timeSinceLastSpawn = timeSinceLastSpawn;
+    header.width = width;
+    header.height = height;
+    header.gravity = gravity;
+    header.damping = damping;
+    header.pressureConstant = pressureConstant;
+    header.restDensity = restDensity;
+    header.viscosity = viscosityConstant;
+    
+    // Write beside the target and rename, so readers never see a partial file
+    const std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) throw std::runtime_error("Cannot write checkpoint " + tempPath);
+        
+        const char padding[Checkpoint::Alignment] = {};
+        uint64_t written = 0;
+        auto write = [&](const void* data, uint64_t bytes) {
+            file.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+            written += bytes;
+        };
+        auto padTo = [&](uint64_t target) { write(padding, target - written); };
+        
+        write(&header, sizeof(header));
+        for (const Payload& payload : payloads) {
+            write(&payload.section, sizeof(payload.section));
+        }
+        for (const Payload& payload : payloads) {
+            padTo(payload.section.offset);
+            write(payload.data, payload.section.bytes);
+        }
+        padTo(header.fileSize);
+        
+        if (!file.flush()) {
+            std::remove(tempPath.c_str());
+            throw std::runtime_error("Failed writing checkpoint " + tempPath);
+        }
+    }
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        throw std::runtime_error("Cannot replace checkpoint " + path);
+    }
+}
+
+void LiquidSimulation::LoadCheckpoint(const std::string& path) {
+    TRACE_SCOPE("LoadCheckpoint");
+    const MappedFile file(path);
+    const uint8_t* data = file.GetData();
+    const size_t size = file.GetSize();
+    file.Prefetch(0, size); // Page everything in ahead of the copies
+    auto fail = [&](const std::string& reason) {
+        throw std::runtime_error("Invalid checkpoint " + path + ": " + reason);
+    };
+    
+    if (size < sizeof(Checkpoint::Header)) fail("truncated header");
+    Checkpoint::Header header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, Checkpoint::Magic, sizeof(header.magic)) != 0) fail("not a checkpoint");
+    if (header.endianTag != Checkpoint::EndianTag) fail("written with a different byte order");
+    if (header.version < Checkpoint::OldestVersion || header.version > Checkpoint::Version) fail("unsupported version " + std::to_string(header.version));
+    if (header.fileSize != size) fail("truncated");
+    if (header.groupCount > GroupHistogram::MaxGroups) fail("too many groups");
+    if (header.particleCount > size) fail("bad particle count");
+    
+    const uint64_t tableEnd = sizeof(header) + uint64_t(header.sectionCount) * sizeof(Checkpoint::Section);
+    if (tableEnd > size) fail("truncated section table");
+    
+    // Validate every section before touching any state, so a bad file
+    // leaves the simulation as it was
+    auto hasSection = [&](SectionId id) {
+        for (uint32_t s = 0; s < header.sectionCount; ++s) {
+            Checkpoint::Section section;
+            std::memcpy(&section, data + sizeof(header) + s * sizeof(section), sizeof(section));
+            if (section.id == id) return true;
+        }
+        return false;
+    };
+    auto findSection = [&](SectionId id, uint32_t elementSize) {
+        for (uint32_t s = 0; s < header.sectionCount; ++s) {
+            Checkpoint::Section section;
+            std::memcpy(&section, data + sizeof(header) + s * sizeof(section), sizeof(section));
+            if (section.id != id) continue;
+            if (section.elementSize != elementSize || section.offset % Checkpoint::Alignment != 0 ||
+                section.offset > size || section.bytes > size - section.offset) {
+                fail("bad section " + std::to_string(static_cast<uint32_t>(id)));
+            }
+            return section;
+        }
+        fail("missing section " + std::to_string(static_cast<uint32_t>(id)));
+        return Checkpoint::Section{};
+    };
+    auto findArray = [&](SectionId id, uint32_t elementSize, uint64_t count) {
+        Checkpoint::Section section = findSection(id, elementSize);
+        if (section.bytes != elementSize * count) fail("bad section " + std::to_string(static_cast<uint32_t>(id)));
+        return section;
+    };
+    
+    std::vector<Checkpoint::Section> particleSections;
+    const bool hasExpireTimes = hasSection(SectionId::ExpireTime);
+    ForEachParticleArray(particles, [&](SectionId id, auto& array) {
+        if (id == SectionId::ExpireTime && !hasExpireTimes) {
+            particleSections.push_back({id, sizeof(array[0]), 0, 0}); // Filled in below
+            return;
+        }
+        particleSections.push_back(findArray(id, sizeof(array[0]), header.particleCount));
+    });
+    const Checkpoint::Section centroidSection = findArray(SectionId::Centroids, sizeof(GroupCentroid), header.groupCount);
+    // Memberships lag the colors by up to the tolerance, so they are state
+    // of their own rather than something to recompute
+    const bool hasMemberships = hasSection(SectionId::MembershipColors);
+    Checkpoint::Section groupSection{}, groupDistanceSection{}, membershipColorSection{}, membershipColorsSection{};
+    if (hasMemberships) {
+        groupSection = findArray(SectionId::Group, sizeof(uint8_t), header.particleCount);
+        groupDistanceSection = findArray(SectionId::GroupDistance, sizeof(float), header.particleCount);
+        membershipColorSection = findArray(SectionId::MembershipColor, sizeof(glm::vec3), header.particleCount);
+        membershipColorsSection = findArray(SectionId::MembershipColors, sizeof(glm::vec3), header.groupCount);
+    }
+    // The walls span the checkpoint's size, keeping any obstacles, and the
+    // wave field's cells follow from the walls
+    const bool resized = header.width != width || header.height != height;
+    std::vector<Wall> restoredWalls = resized ? BoxWalls(header.width, header.height) : walls;
+    if (resized && walls.size() > BoxWallCount) {
+        restoredWalls.insert(restoredWalls.end(), walls.begin() + BoxWallCount, walls.end());
+    }
+    WaveField restoredWaveField;
+    ConfigureWaveField(restoredWaveField, restoredWalls, header.groupCount);
+    Checkpoint::Section waveFieldSection{};
+    if (hasSection(SectionId::WaveField)) {
+        waveFieldSection = findArray(SectionId::WaveField, sizeof(glm::vec2),
+                                     uint64_t(restoredWaveField.GetCellCount()) * header.groupCount);
+    }
+    
+    const Checkpoint::Section rngSection = findSection(SectionId::RngState, 1);
+    std::istringstream rngText(std::string(reinterpret_cast<const char*>(data + rngSection.offset),
+                                           rngSection.bytes));
+    std::mt19937 restoredRng;
+    rngText >> restoredRng;
+    if (!rngText) fail("bad RNG state");
+    
+    // Bulk-copy each array straight out of the mapping
+    size_t next = 0;
+    ForEachParticleArray(particles, [&](SectionId, auto& array) {
+        const Checkpoint::Section& section = particleSections[next++];
+        array.resize(header.particleCount);
+        if (section.bytes) std::memcpy(array.data(), data + section.offset, section.bytes);
+    });
+    if (!hasExpireTimes) {
+        std::fill(particles.expireTime.begin(), particles.expireTime.end(), ParticleStore::NoExpiry);
+    }
+    groupCentroids.resize(header.groupCount);
+    if (centroidSection.bytes) {
+        std::memcpy(groupCentroids.data(), data + centroidSection.offset, centroidSection.bytes);
+    }
+    if (resized) {
+        walls = std::move(restoredWalls);
+        wallField.Bake(walls, WallFieldCellSize);
+    }
+    waveField = std::move(restoredWaveField);
+    if (waveFieldSection.bytes) {
+        std::memcpy(waveField.GetPhasors().data(), data + waveFieldSection.offset, waveFieldSection.bytes);
+        waveField.Refresh();
+    }
+    
+    rng = restoredRng;
+    seed = header.seed;
+    globalTime = header.globalTime;
+    timeSinceLastSpawn = header.timeSinceLastSpawn;
+    width = header.width;
+    height = header.height;
+    gravity = header.gravity;
+    damping = header.damping;
+    if (header.version >= 2) {
+        pressureConstant = header.pressureConstant;
+        restDensity = header.restDensity;
+        viscosityConstant = header.viscosity;
+    }
+    positionDist = std::uniform_real_distribution<float>(-width * 0.4f, width * 0.4f);
+    
+    // Derived state: the free list is the set of dead slots, and the
+    // expiry queue the mortal ones
+    freeSlots.clear();
+    expiryQueue = {};
+    for (size_t i = 0; i < particles.Size(); ++i) {
+        if (!particles.IsAlive(i)) freeSlots.push_back(static_cast<uint32_t>(i));
+        QueueExpiry(i);
+    }
+    compaction = CompactionLog{};
+    particleGroup.resize(header.particleCount);
+    particleGroupDistance.resize(header.particleCount);
+    particleMembershipColor.resize(header.particleCount);
+    if (hasMemberships) {
+        membershipColors.resize(header.groupCount);
+        auto copy = [&](auto& array, const Checkpoint::Section& section) {
+            if (section.bytes) std::memcpy(array.data(), data + section.offset, section.bytes);
+        };
+        copy(particleGroup, groupSection);
+        copy(particleGroupDistance, groupDistanceSection);
+        copy(particleMembershipColor, membershipColorSection);
+        copy(membershipColors, membershipColorsSection);
+    } else {
+        RefreshGroupMembership();
+    }
+    UpdateGroupStats();
+    particleViewDirty = true;
+}
@@ -1,6 +1,7 @@
 #include "Config.h"
 #include <fstream>
 #include <iostream>
+#include <random>
 
 // Helper functions for glm::vec3 JSON conversion
 namespace nlohmann {
@@ -37,6 +38,23 @@ Config Config::Load(const std::string& filename) {
         if (j.contains("particleCount")) config.particleCount = j["particleCount"];
         if (j.contains("gravity")) config.gravity = j["gravity"];
         if (j.contains("damping")) config.damping = j["damping"];
+        if (j.contains("pressureStiffness")) config.pressureStiffness = j["pressureStiffness"];
+        if (j.contains("restDensity")) config.restDensity = j["restDensity"];
+        if (j.contains("viscosity")) config.viscosity = j["viscosity"];
+        if (j.contains("threadCount")) config.threadCount = j["threadCount"];
+        if (j.contains("collisionIterations")) config.collisionIterations = j["collisionIterations"];
+        if (j.contains("fixedTimestep")) config.fixedTimestep = j["fixedTimestep"];
+        if (j.contains("maxSubsteps")) config.maxSubsteps = j["maxSubsteps"];
+        if (j.contains("simulationThread")) config.simulationThread = j["simulationThread"];
+        if (j.contains("seed")) config.seed = j["seed"];
+        if (j.contains("checkpointPath")) config.checkpointPath = j["checkpointPath"];
+        if (j.contains("recordPath")) config.recordPath = j["recordPath"];
+        if (j.contains("recordQuantized")) config.recordQuantized = j["recordQuantized"];
+        if (j.contains("recordDelta")) config.recordDelta = j["recordDelta"];
+        if (j.contains("emitRate")) config.emitRate = j["emitRate"];
+        if (j.contains("emitLifetime")) config.emitLifetime = j["emitLifetime"];
+        if (j.contains("emitMaxParticles")) config.emitMaxParticles = j["emitMaxParticles"];
+        if (j.contains("replayPath")) config.replayPath = j["replayPath"];
         if (j.contains("cameraPos")) config.cameraPos = j["cameraPos"];
         if (j.contains("cameraTarget")) config.cameraTarget = j["cameraTarget"];
         
@@ -57,6 +75,23 @@ void Config::Save(const std::string& filename) const {
             {"particleCount", particleCount},
             {"gravity", gravity},
             {"damping", damping},
+            {"pressureStiffness", pressureStiffness},
+            {"restDensity", restDensity},
+            {"viscosity", viscosity},
+            {"threadCount", threadCount},
+            {"collisionIterations", collisionIterations},
+            {"fixedTimestep", fixedTimestep},
+            {"maxSubsteps", maxSubsteps},
+            {"simulationThread", simulationThread},
+            {"seed", seed},
+            {"checkpointPath", checkpointPath},
+            {"recordPath", recordPath},
+            {"recordQuantized", recordQuantized},
+            {"recordDelta", recordDelta},
+            {"emitRate", emitRate},
+            {"emitLifetime", emitLifetime},
+            {"emitMaxParticles", emitMaxParticles},
+            {"replayPath", replayPath},
             {"cameraPos", cameraPos},
             {"cameraTarget", cameraTarget}
         };
@@ -69,3 +104,7 @@ void Config::Save(const std::string& filename) const {
         std::cout << "Failed to save config: " << e.what() << "\n";
     }
 }
+
+uint32_t Config::ResolveSeed() const {
+    return seed >= 0 ? static_cast<uint32_t>(seed) : std::random_device{}();
+}
@@ -0,0 +1,152 @@
+#include "ContactSolver.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace {
+    // Greedy coloring uses a 64-bit mask per particle; contacts that find no
+    // free color go into one extra batch that is solved serially
+    constexpr int MaxParallelBatches = 64;
+}
+
+void ContactSolver::Solve(ParticleStore& particles, int iterations, int threadCount) {
+    GatherContacts(particles, threadCount);
+    ColorContacts(particles.Size());
+    
+    const size_t batchCount = GetBatchCount();
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        for (size_t batch = 0; batch < batchCount; ++batch) {
+            const size_t begin = batchOffsets[batch];
+            const size_t end = batchOffsets[batch + 1];
+            
+            if (batch == MaxParallelBatches) {
+                // Overflow batch may share particles between contacts
+                for (size_t c = begin; c < end; ++c) {
+                    SolveContact(particles, contacts[c]);
+                }
+                continue;
+            }
+            
+            #pragma omp parallel for schedule(static) num_threads(threadCount)
+            for (size_t c = begin; c < end; ++c) {
+                SolveContact(particles, contacts[c]);
+            }
+        }
+    }
+}
+
+void ContactSolver::GatherContacts(const ParticleStore& particles, int threadCount) {
+    const size_t count = particles.Size();
+    
+    float maxRadius = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        maxRadius = std::max(maxRadius, particles.radius[i]);
+    }
+    const float reach = std::max(2.0f * maxRadius, 0.01f);
+    grid.Build(count, reach, [&](size_t i) { return particles.GetPosition(i); });
+    
+    // Each pair is owned by its lower index
+    auto forEachContact = [&](size_t i, auto&& fn) {
+        const glm::vec3 position = particles.GetPosition(i);
+        grid.ForEachCandidate(position, reach, [&](size_t j) {
+            if (j <= i) return;
+            glm::vec3 diff = position - particles.GetPosition(j);
+            float minDistance = particles.radius[i] + particles.radius[j];
+            if (glm::dot(diff, diff) < minDistance * minDistance) {
+                fn(j);
+            }
+        });
+    };
+    
+    // Count, prefix sum, fill: parallel, yet the order matches a serial gather
+    contactOffsets.assign(count + 1, 0);
+    #pragma omp parallel for schedule(dynamic, 64) num_threads(threadCount)
+    for (size_t i = 0; i < count; ++i) {
+        size_t found = 0;
+        forEachContact(i, [&](size_t) { ++found; });
+        contactOffsets[i + 1] = found;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        contactOffsets[i + 1] += contactOffsets[i];
+    }
+    
+    gathered.resize(contactOffsets[count]);
+    #pragma omp parallel for schedule(dynamic, 64) num_threads(threadCount)
+    for (size_t i = 0; i < count; ++i) {
+        size_t slot = contactOffsets[i];
+        forEachContact(i, [&](size_t j) {
+            gathered[slot++] = {static_cast<uint32_t>(i), static_cast<uint32_t>(j), -1.0f};
+        });
+    }
+}
+
+void ContactSolver::ColorContacts(size_t particleCount) {
+    usedColors.assign(particleCount, 0);
+    contactColor.resize(gathered.size());
+    
+    // Greedy: lowest batch where neither particle is already used
+    size_t batchSizes[MaxParallelBatches + 1] = {};
+    for (size_t c = 0; c < gathered.size(); ++c) {
+        const Contact& contact = gathered[c];
+        uint64_t free = ~(usedColors[contact.a] | usedColors[contact.b]);
+        int color = free ? std::countr_zero(free) : MaxParallelBatches;
+        if (color < MaxParallelBatches) {
+            usedColors[contact.a] |= uint64_t(1) << color;
+            usedColors[contact.b] |= uint64_t(1) << color;
+        }
+        contactColor[c] = static_cast<uint8_t>(color);
+        ++batchSizes[color];
+    }
+    
+    // Drop empty trailing batches, keep the overflow batch index fixed
+    int lastBatch = -1;
+    for (int b = 0; b <= MaxParallelBatches; ++b) {
+        if (batchSizes[b] > 0) lastBatch = b;
+    }
+    batchOffsets.assign(lastBatch + 2, 0);
+    for (int b = 0; b <= lastBatch; ++b) {
+        batchOffsets[b + 1] = batchOffsets[b] + batchSizes[b];
+    }
+    
+    contacts.resize(gathered.size());
+    std::vector<size_t> cursor(batchOffsets.begin(), batchOffsets.end() - 1);
+    for (size_t c = 0; c < gathered.size(); ++c) {
+        contacts[cursor[contactColor[c]]++] = gathered[c];
+    }
+}
+
+void ContactSolver::SolveContact(ParticleStore& particles, Contact& contact) {
+    const size_t i = contact.a;
+    const size_t j = contact.b;
+    
+    glm::vec3 diff = particles.GetPosition(i) - particles.GetPosition(j);
+    float distSq = glm::dot(diff, diff);
+    float minDistance = particles.radius[i] + particles.radius[j];
+    float minDistSq = minDistance * minDistance;
+    
+    if (distSq < minDistSq && distSq > 0.0001f) {
+        float distance = std::sqrt(distSq);
+        glm::vec3 normal = diff / distance;
+        float overlap = minDistance - distance;
+        
+        particles.SetPosition(i, particles.GetPosition(i) + normal * overlap * 0.5f);
+        particles.SetPosition(j, particles.GetPosition(j) - normal * overlap * 0.5f);
+        
+        glm::vec3 relVel = particles.GetVelocity(i) - particles.GetVelocity(j);
+        float velAlongNormal = glm::dot(relVel, normal);
+        
+        if (velAlongNormal > 0) {
+            float restitution = 0.1f;
+            float impulseMagnitude = -(1 + restitution) * velAlongNormal;
+            impulseMagnitude /= 1.0f / particles.mass[i] + 1.0f / particles.mass[j];
+            
+            glm::vec3 impulse = impulseMagnitude * normal;
+            particles.SetVelocity(i, particles.GetVelocity(i) + impulse / particles.mass[i]);
+            particles.SetVelocity(j, particles.GetVelocity(j) - impulse / particles.mass[j]);
+            
+            // Collision strength for the caller's wave trigger
+            float collisionIntensity = std::min(1.0f, velAlongNormal * 0.1f);
+            contact.waveIntensity = std::max(contact.waveIntensity, collisionIntensity);
+        }
+    }
+}
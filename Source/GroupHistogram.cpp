@@ -0,0 +1,52 @@
+#include "GroupHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+void GroupHistogram::Count(const glm::vec3& point, Mode mode, int* counts) const {
+    const float radiusSq = radius * radius;
+    const float cellSize = grid.GetCellSize();
+    
+    grid.ForEachCell(point, radius, [&](size_t cell, const glm::vec3& cellMin) {
+        const uint32_t* cellGroups = &cellCounts[cell * groupCount];
+        const glm::vec3 cellMax = cellMin + glm::vec3(cellSize);
+        
+        if (mode == Mode::Approximate) {
+            glm::vec3 toCenter = (cellMin + cellMax) * 0.5f - point;
+            if (glm::dot(toCenter, toCenter) < radiusSq) {
+                for (size_t g = 0; g < groupCount; ++g) {
+                    counts[g] += cellGroups[g];
+                }
+            }
+            return;
+        }
+        
+        // Nearest and farthest points of the cell from `point`
+        float nearSq = 0.0f, farSq = 0.0f;
+        for (int axis = 0; axis < 3; ++axis) {
+            float below = cellMin[axis] - point[axis];
+            float above = point[axis] - cellMax[axis];
+            float nearest = std::max({below, above, 0.0f});
+            float farthest = std::max(std::abs(below), std::abs(above));
+            nearSq += nearest * nearest;
+            farSq += farthest * farthest;
+        }
+        
+        // Margins absorb rounding between cell bounds and cell assignment
+        if (nearSq > radiusSq * 1.0001f) return;
+        if (farSq < radiusSq * 0.9999f) {
+            for (size_t g = 0; g < groupCount; ++g) {
+                counts[g] += cellGroups[g];
+            }
+            return;
+        }
+        
+        // Straddles the radius: test the points themselves
+        for (uint32_t k = grid.GetCellBegin(cell); k < grid.GetCellEnd(cell); ++k) {
+            if (sortedGroups[k] == Uncounted) continue;
+            glm::vec3 diff = sortedPositions[k] - point;
+            if (glm::dot(diff, diff) < radiusSq) {
+                ++counts[sortedGroups[k]];
+            }
+        }
+    });
+}
@@ -0,0 +1,233 @@
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+#include "LiquidSimulation.h"
+#include "Config.h"
+#include "RandomParticles.h"
+#include "Trace.h"
+#include "TrajectoryRecorder.h"
+
+// Runs the simulation without a window or GL context, for batch jobs on
+// GPU-less machines. Prints the time of each step and a summary.
+
+namespace {
+    // Set by SIGUSR1 to snapshot the run after the current step
+    volatile std::sig_atomic_t checkpointRequested = 0;
+
+    struct Options {
+        std::string configPath = "config.json";
+        std::string tracePath;  // Empty = no trace
+        std::optional<std::string> recordPath; // Unset = take from config
+        std::optional<std::string> checkpointPath; // Unset = take from config
+        int particleCount = -1; // -1 = take from config
+        int steps = 100;
+        float dt = -1.0f;       // -1 = config fixedTimestep
+        int threadCount = -1;   // -1 = take from config
+        std::optional<int64_t> seed; // Unset = take from config
+        bool quiet = false;     // Summary only
+    };
+
+    void PrintUsage(const char* program) {
+        std::cout << "Usage: " << program << " [options]\n"
+                  << "  --particles <n>   Particles to add (default: config particleCount)\n"
+                  << "  --steps <n>       Steps to run (default: 100)\n"
+                  << "  --dt <seconds>    Step size (default: config fixedTimestep)\n"
+                  << "  --threads <n>     Worker threads, 0 = OpenMP default (default: config threadCount)\n"
+                  << "  --seed <n>        Random seed, -1 = new each run (default: config seed)\n"
+                  << "  --config <path>   Config file (default: config.json)\n"
+                  << "  --checkpoint <path> Resume from <path> if it exists, save back at the end\n"
+                  << "                    and on SIGUSR1 (default: config checkpointPath)\n"
+                  << "  --record <path>   Record the trajectory to <path> (default: config recordPath)\n"
+                  << "  --trace <path>    Write a Chrome trace of the run (needs CPPLIQUID_TRACING)\n"
+                  << "  --quiet           Print only the summary\n"
+                  << "  --help            Show this message\n";
+    }
+
+    // Returns false (after printing why) on bad arguments
+    bool ParseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "--help") {
+                PrintUsage(argv[0]);
+                std::exit(0);
+            }
+            if (arg == "--quiet") {
+                options.quiet = true;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << "\n";
+                return false;
+            }
+            const std::string value = argv[++i];
+            try {
+                if (arg == "--particles") options.particleCount = std::stoi(value);
+                else if (arg == "--steps") options.steps = std::stoi(value);
+                else if (arg == "--dt") options.dt = std::stof(value);
+                else if (arg == "--threads") options.threadCount = std::stoi(value);
+                else if (arg == "--seed") options.seed = std::stoll(value);
+                else if (arg == "--config") options.configPath = value;
+                else if (arg == "--trace") options.tracePath = value;
+                else if (arg == "--record") options.recordPath = value;
+                else if (arg == "--checkpoint") options.checkpointPath = value;
+                else {
+                    std::cerr << "Unknown option " << arg << "\n";
+                    return false;
+                }
+            } catch (const std::exception&) {
+                std::cerr << "Invalid value for " << arg << ": " << value << "\n";
+                return false;
+            }
+        }
+        if (options.steps < 0 || options.particleCount < -1 || options.threadCount < -1 ||
+            (options.seed && (*options.seed < -1 || *options.seed > UINT32_MAX)) ||
+            (options.dt != -1.0f && !(options.dt > 0.0f))) {
+            std::cerr << "Values out of range\n";
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    Config config = Config::Load(options.configPath);
+    if (options.particleCount >= 0) config.particleCount = options.particleCount;
+    if (options.threadCount >= 0) config.threadCount = options.threadCount;
+    if (options.seed) config.seed = *options.seed;
+    if (options.checkpointPath) config.checkpointPath = *options.checkpointPath;
+    if (options.recordPath) config.recordPath = *options.recordPath;
+    const float dt = options.dt > 0.0f ? options.dt : config.fixedTimestep;
+
+    const uint32_t seed = config.ResolveSeed();
+    LiquidSimulation simulation(config.width, config.height, seed);
+    simulation.SetGravity(glm::vec3(0.0f, config.gravity, 0.0f));
+    simulation.SetDamping(config.damping);
+    simulation.SetPressure(config.pressureStiffness, config.restDensity);
+    simulation.SetViscosity(config.viscosity);
+    simulation.SetThreadCount(config.threadCount);
+    simulation.SetCollisionIterations(config.collisionIterations);
+    simulation.SetEmitter(config.emitRate, config.emitLifetime, std::max(config.emitMaxParticles, 0));
+
+    const bool checkpointing = !config.checkpointPath.empty();
+    if (checkpointing && std::filesystem::exists(config.checkpointPath)) {
+        const auto loadStart = std::chrono::steady_clock::now();
+        try {
+            simulation.LoadCheckpoint(config.checkpointPath);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        const double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+        std::cout << "Resumed from " << config.checkpointPath << " in " << loadMs << " ms\n";
+    } else {
+        std::mt19937 gen = MakeWorkloadGenerator(seed);
+        AddRandomParticles(simulation, config, 0, config.particleCount, gen);
+    }
+    if (checkpointing) {
+        std::signal(SIGUSR1, [](int) { checkpointRequested = 1; });
+    }
+    auto saveCheckpoint = [&] {
+        try {
+            simulation.SaveCheckpoint(config.checkpointPath);
+            std::cout << "Checkpoint saved to " << config.checkpointPath << "\n";
+        } catch (const std::exception& e) {
+            std::cerr << "Checkpoint failed: " << e.what() << std::endl;
+        }
+    };
+
+    std::cout << "Headless run: " << simulation.GetParticleCount() << " particles, "
+              << options.steps << " steps, dt " << dt << " s, "
+              << simulation.GetThreadCount() << " threads, seed " << simulation.GetSeed() << "\n";
+
+    std::unique_ptr<TrajectoryRecorder> recorder;
+    if (!config.recordPath.empty()) {
+        try {
+            TrajectoryRecorder::Options recordOptions;
+            recordOptions.quantize = config.recordQuantized;
+            recordOptions.delta = config.recordDelta;
+            recorder = std::make_unique<TrajectoryRecorder>(config.recordPath, recordOptions);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    using Clock = std::chrono::steady_clock;
+    std::vector<double> stepMs;
+    stepMs.reserve(options.steps);
+
+    const auto runStart = Clock::now();
+    for (int step = 0; step < options.steps; ++step) {
+        const auto start = Clock::now();
+        try {
+            simulation.Update(dt);
+            if (recorder) recorder->Capture(simulation.GetParticleStore(), simulation.GetTime());
+        } catch (const std::exception& e) {
+            std::cerr << "Simulation error at step " << step << ": " << e.what() << std::endl;
+            return 1;
+        }
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        stepMs.push_back(ms);
+
+        if (checkpointRequested) {
+            checkpointRequested = 0;
+            saveCheckpoint();
+        }
+
+        if (!options.quiet) {
+            std::cout << "step " << step << ": " << std::fixed << std::setprecision(3) << ms << " ms\n";
+        }
+    }
+    const double totalMs = std::chrono::duration<double, std::milli>(Clock::now() - runStart).count();
+
+    if (checkpointing) saveCheckpoint();
+    if (recorder) {
+        recorder->Flush();
+        std::cout << "Recorded " << recorder->GetWrittenCount() << " frames to " << config.recordPath
+                  << " (" << recorder->GetDroppedCount() << " dropped, "
+                  << recorder->GetBytesWritten() / (1024 * 1024) << " MiB)\n";
+        recorder.reset(); // Writes the index and closes the file
+    }
+    if (!options.tracePath.empty()) {
+        if (!Trace::Enabled) {
+            std::cerr << "Tracing is compiled out; rebuild with -DCPPLIQUID_TRACING=ON\n";
+        } else if (Trace::Recorder::Global().WriteChromeTrace(options.tracePath)) {
+            std::cout << "Trace written to " << options.tracePath << "\n";
+        } else {
+            std::cerr << "Failed to write " << options.tracePath << "\n";
+        }
+    }
+
+    if (config.emitRate > 0.0f) {
+        std::cout << "Live particles at end: " << simulation.GetLiveCount() << "\n";
+    }
+
+    if (stepMs.empty()) return 0;
+
+    std::vector<double> sorted = stepMs;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&](double p) {
+        return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))];
+    };
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "total " << totalMs << " ms | mean " << totalMs / stepMs.size() << " ms"
+              << " | min " << sorted.front() << " | p50 " << percentile(0.5)
+              << " | p95 " << percentile(0.95) << " | max " << sorted.back() << " ms"
+              << " | " << std::setprecision(1) << stepMs.size() * 1000.0 / totalMs << " steps/s\n";
+    return 0;
+}
@@ -1,20 +1,49 @@
 #include "LiquidSimulation.h"
+#include "Trace.h"
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdlib>
+#include <limits>
 #include <vector>
-#include <GLFW/glfw3.h>
+#include <omp.h>
 
-LiquidSimulation::LiquidSimulation(float width, float height)
+// SplitMix64 finalizer: a stateless generator, so parallel loops can draw
+// per-item random values from (key, index) in any order
+static uint64_t MixBits(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Uniform in [0, 1) from the top 24 bits
+static float UnitFloat(uint64_t bits) {
+    return static_cast<float>(bits >> 40) * 0x1.0p-24f;
+}
+
+// Particles per chunk of the Update task graph, and per block of the
+// parallel loops phases run on their own
+static constexpr size_t TaskChunk = 1024;
+static constexpr size_t LoopBlock = 64;
+// Fixed so group stat sums don't depend on the thread count
+static constexpr size_t GroupStatsChunk = 4096;
+
+static size_t ChunkCount(size_t count, size_t chunkSize) {
+    return (count + chunkSize - 1) / chunkSize;
+}
+
+LiquidSimulation::LiquidSimulation(float width, float height, uint32_t seed)
     : width(width)
     , height(height)
     , gravity(-2.0f)  // Moderate gravity
-    , pressureConstant(2000.0f)
-    , viscosityConstant(50.0f)
-    , restDensity(1000.0f)
+    , pressureConstant(1000.0f)
+    , viscosityConstant(0.5f)
+    , restDensity(1.5f)      // About a settled layer at smoothingRadius 2
     , smoothingRadius(2.0f)  // Smaller for smaller blobs
     , damping(0.99f)
-    , rng(std::random_device{}())
+    , seed(seed)
+    , rng(seed)
     , colorDist(0.3f, 1.0f)
     , positionDist(-width * 0.4f, width * 0.4f)
     , unitDist(0.0f, 1.0f)
@@ -22,6 +51,7 @@ LiquidSimulation::LiquidSimulation(float width, float height)
     , timeSinceLastSpawn(0.0f)
     , globalTime(0.0f) {
     
+    smoothingKernel = SphKernel(smoothingRadius);
     InitializeWalls();
     InitializeParticles();
     
@@ -46,6 +76,9 @@ LiquidSimulation::LiquidSimulation(float width, float height)
         centroid.phase = static_cast<float>(i) * M_PI / 3.0f;
         groupCentroids.push_back(centroid);
     }
+    ConfigureWaveField(waveField, walls, groupCentroids.size());
+    RefreshGroupMembership();
+    UpdateGroupStats();
 }
 
 void LiquidSimulation::InitializeParticles() {
@@ -79,39 +112,296 @@ void LiquidSimulation::InitializeParticles() {
 }
 
 void LiquidSimulation::InitializeWalls() {
-    float wallHeight = 5.0f;  // Shallow box
-    float halfWidth = 15.0f;  // Tighter bounds for more interaction
-    float halfDepth = 10.0f;  // Tighter bounds
+    walls = BoxWalls(width, height);
+    wallField.Bake(walls, WallFieldCellSize);
+}
+
+std::vector<Wall> LiquidSimulation::BoxWalls(float width, float height) {
+    // Spans the simulation's area, so workloads spawned over it start
+    // inside the walls
+    float wallHeight = height;
+    float halfWidth = width * 0.5f;
+    float halfDepth = 20.0f;  // Holds the random workload's z range
+    std::vector<Wall> box;
     
     // Front and back walls
-    walls.emplace_back(glm::vec3(0.0f, wallHeight * 0.5f, -halfDepth), glm::vec3(halfWidth * 2, wallHeight, 1.0f));
-    walls.emplace_back(glm::vec3(0.0f, wallHeight * 0.5f, halfDepth), glm::vec3(halfWidth * 2, wallHeight, 1.0f));
+    box.emplace_back(glm::vec3(0.0f, wallHeight * 0.5f, -halfDepth), glm::vec3(halfWidth * 2, wallHeight, 1.0f));
+    box.emplace_back(glm::vec3(0.0f, wallHeight * 0.5f, halfDepth), glm::vec3(halfWidth * 2, wallHeight, 1.0f));
     
     // Left and right walls
-    walls.emplace_back(glm::vec3(-halfWidth, wallHeight * 0.5f, 0.0f), glm::vec3(1.0f, wallHeight, halfDepth * 2));
-    walls.emplace_back(glm::vec3(halfWidth, wallHeight * 0.5f, 0.0f), glm::vec3(1.0f, wallHeight, halfDepth * 2));
+    box.emplace_back(glm::vec3(-halfWidth, wallHeight * 0.5f, 0.0f), glm::vec3(1.0f, wallHeight, halfDepth * 2));
+    box.emplace_back(glm::vec3(halfWidth, wallHeight * 0.5f, 0.0f), glm::vec3(1.0f, wallHeight, halfDepth * 2));
     
     // Floor
-    walls.emplace_back(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(halfWidth * 2, 0.1f, halfDepth * 2));
+    box.emplace_back(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(halfWidth * 2, 0.1f, halfDepth * 2));
     
     // Ceiling
-    walls.emplace_back(glm::vec3(0.0f, wallHeight, 0.0f), glm::vec3(halfWidth * 2, 0.1f, halfDepth * 2));
+    box.emplace_back(glm::vec3(0.0f, wallHeight, 0.0f), glm::vec3(halfWidth * 2, 0.1f, halfDepth * 2));
+    return box;
+}
+
+void LiquidSimulation::AddObstacle(const glm::vec3& position, const glm::vec3& size) {
+    walls.emplace_back(position, size);
+    wallField.Bake(walls, WallFieldCellSize);
 }
 
 void LiquidSimulation::AddParticle(const glm::vec3& position, const glm::vec3& velocity, const glm::vec3& color) {
-    LiquidParticle particle;
-    particle.position = position;
-    particle.velocity = velocity;
-    particle.color = color;
-    particle.targetColor = color;
-    particle.baseRadius = 0.3f + unitDist(rng) * 0.9f; // 80% smaller (was 1.5-6.0, now 0.3-1.2)
-    particle.radius = particle.baseRadius;
-    particle.mass = 0.2f + unitDist(rng) * 0.8f; // Varied masses
-    particle.colorTransitionSpeed = 2.0f + unitDist(rng) * 2.0f;
-    particle.wavePhase = 0.0f;
-    particle.waveAmplitude = 0.0f;
-    particle.waveDecay = 0.85f + unitDist(rng) * 0.1f;
-    particles.push_back(particle);
+    const ParticleInit init{position, velocity, color};
+    AddParticles(std::span<const ParticleInit>(&init, 1));
+}
+
+void LiquidSimulation::AddParticles(std::span<const ParticleInit> inits) {
+    TRACE_SCOPE("AddParticles");
+    const size_t first = particles.Size();
+    const size_t count = inits.size();
+    if (count == 0) return;
+    particles.Resize(first + count);
+    particleGroup.resize(first + count);
+    particleGroupDistance.resize(first + count);
+    particleMembershipColor.resize(first + count);
+    
+    // One draw keys the whole batch; each particle hashes its own values
+    // from it, so the loop parallelizes without depending on thread count
+    const uint64_t batchKey = uint64_t(rng()) << 32;
+    
+    #pragma omp parallel for schedule(static) num_threads(GetThreadCount()) if(count >= 4096)
+    for (size_t n = 0; n < count; ++n) {
+        InitializeSlot(first + n, inits[n], batchKey + 2 * uint64_t(n));
+    }
+    for (size_t n = 0; n < count; ++n) {
+        QueueExpiry(first + n);
+    }
+    particleViewDirty = true;
+}
+
+void LiquidSimulation::InitializeSlot(size_t i, const ParticleInit& init, uint64_t key) {
+    const uint64_t bitsA = MixBits(key);
+    const uint64_t bitsB = MixBits(key + 1);
+    particles.baseRadius[i] = 0.3f + UnitFloat(bitsA) * 0.9f; // 80% smaller (was 1.5-6.0, now 0.3-1.2)
+    particles.mass[i] = 0.2f + UnitFloat(bitsA << 24) * 0.8f; // Varied masses
+    particles.colorTransitionSpeed[i] = 2.0f + UnitFloat(bitsB) * 2.0f;
+    particles.waveDecay[i] = 0.85f + UnitFloat(bitsB << 24) * 0.1f;
+    particles.SetPosition(i, init.position);
+    particles.SetVelocity(i, init.velocity);
+    particles.color[i] = init.color;
+    particles.targetColor[i] = init.color;
+    particles.radius[i] = particles.baseRadius[i];
+    particles.wavePhase[i] = 0.0f;
+    particles.waveAmplitude[i] = 0.0f;
+    particles.expireTime[i] = init.lifetime > 0.0f ? globalTime + init.lifetime : ParticleStore::NoExpiry;
+    UpdateGroupMembership(i);
+}
+
+size_t LiquidSimulation::Spawn(const ParticleInit& init) {
+    if (freeSlots.empty()) {
+        AddParticles(std::span<const ParticleInit>(&init, 1));
+        return particles.Size() - 1;
+    }
+    const size_t i = freeSlots.back();
+    freeSlots.pop_back();
+    ForgetRepresentative(i); // The slot now holds someone else
+    InitializeSlot(i, init, uint64_t(rng()) << 32);
+    QueueExpiry(i);
+    particleViewDirty = true;
+    return i;
+}
+
+void LiquidSimulation::Despawn(size_t index) {
+    if (index >= particles.Size() || !particles.IsAlive(index)) return;
+    particles.expireTime[index] = ParticleStore::Dead;
+    particles.radius[index] = 0.0f; // Invisible until compacted away
+    freeSlots.push_back(static_cast<uint32_t>(index));
+    particleViewDirty = true;
+}
+
+void LiquidSimulation::ForgetRepresentative(size_t index) {
+    for (GroupStats& stats : groupStats) {
+        if (stats.representative == index) {
+            stats.representative = GroupStats::NoMember;
+            stats.representativeDistance2 = std::numeric_limits<float>::max();
+        }
+    }
+}
+
+void LiquidSimulation::Compact() {
+    compaction.moves.clear();
+    for (uint32_t hole : freeSlots) {
+        ForgetRepresentative(hole);
+    }
+    size_t end = particles.Size();
+    // Fill each hole with the last live particle; holes already in the
+    // dead tail just fall off the end
+    for (uint32_t hole : freeSlots) {
+        while (end > 0 && !particles.IsAlive(end - 1)) --end;
+        if (hole >= end) continue;
+        const size_t from = end - 1;
+        particles.Move(from, hole);
+        particleGroup[hole] = particleGroup[from];
+        particleGroupDistance[hole] = particleGroupDistance[from];
+        particleMembershipColor[hole] = particleMembershipColor[from];
+        particles.expireTime[from] = ParticleStore::Dead;
+        QueueExpiry(hole); // Its old entry names a slot that is gone
+        compaction.moves.push_back({static_cast<uint32_t>(from), hole});
+        --end;
+    }
+    while (end > 0 && !particles.IsAlive(end - 1)) --end;
+    freeSlots.clear();
+    particles.Resize(end);
+    particleGroup.resize(end);
+    particleGroupDistance.resize(end);
+    particleMembershipColor.resize(end);
+    compaction.size = end;
+    
+    // Group representatives are indices from the last stats pass: follow
+    // the moves in order, as a particle may move more than once
+    for (GroupStats& stats : groupStats) {
+        for (const ParticleMove& move : compaction.moves) {
+            if (stats.representative == move.from) stats.representative = move.to;
+        }
+    }
+    particleViewDirty = true;
+}
+
+void LiquidSimulation::SetEmitter(float rate, float lifetime, size_t maxLive) {
+    emitRate = std::max(rate, 0.0f);
+    emitLifetime = std::max(lifetime, 0.0f);
+    emitMaxLive = maxLive;
+}
+
+void LiquidSimulation::ExpireParticles() {
+    // Only the particles due now are touched
+    while (!expiryQueue.empty() && expiryQueue.top().first <= globalTime) {
+        const auto [expireTime, slot] = expiryQueue.top();
+        expiryQueue.pop();
+        if (slot < particles.Size() && particles.expireTime[slot] == expireTime) {
+            Despawn(slot);
+        }
+    }
+}
+
+void LiquidSimulation::QueueExpiry(size_t i) {
+    const float expireTime = particles.expireTime[i];
+    if (expireTime != ParticleStore::NoExpiry && expireTime != ParticleStore::Dead) {
+        expiryQueue.push({expireTime, static_cast<uint32_t>(i)});
+    }
+}
+
+void LiquidSimulation::EmitParticles(float deltaTime) {
+    if (emitRate <= 0.0f) return;
+    timeSinceLastSpawn += deltaTime;
+    const float interval = 1.0f / emitRate;
+    while (timeSinceLastSpawn >= interval) {
+        timeSinceLastSpawn -= interval;
+        if (emitMaxLive > 0 && GetLiveCount() >= emitMaxLive) {
+            timeSinceLastSpawn = 0.0f; // Don't bank spawns while capped
+            break;
+        }
+        SpawnNewParticle();
+    }
+}
+
+void LiquidSimulation::Reserve(size_t count) {
+    particles.Reserve(count);
+    particleGroup.reserve(count);
+    particleGroupDistance.reserve(count);
+    particleMembershipColor.reserve(count);
+}
+
+void LiquidSimulation::UpdateGroupMembership(size_t particleIndex) {
+    uint8_t group = NoGroup;
+    float minColorDist = 999.0f;
+    for (size_t c = 0; c < membershipColors.size(); ++c) {
+        float colorDist = glm::length(particles.color[particleIndex] - membershipColors[c]);
+        if (colorDist < minColorDist) {
+            minColorDist = colorDist;
+            group = static_cast<uint8_t>(c);
+        }
+    }
+    particleGroup[particleIndex] = group;
+    particleGroupDistance[particleIndex] = minColorDist;
+    particleMembershipColor[particleIndex] = particles.color[particleIndex];
+}
+
+void LiquidSimulation::SnapshotMembershipColors() {
+    membershipColors.resize(groupCentroids.size());
+    for (size_t c = 0; c < groupCentroids.size(); ++c) {
+        membershipColors[c] = groupCentroids[c].color;
+    }
+}
+
+void LiquidSimulation::RefreshGroupMembership() {
+    SnapshotMembershipColors();
+    const size_t count = particles.Size();
+    const size_t blocks = ChunkCount(count, LoopBlock);
+    #pragma omp parallel for schedule(static) num_threads(GetThreadCount())
+    for (size_t block = 0; block < blocks; ++block) {
+        RefreshGroupMembership(block * LoopBlock, std::min(count, (block + 1) * LoopBlock));
+    }
+}
+
+void LiquidSimulation::RefreshGroupMembership(size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        UpdateGroupMembership(i);
+    }
+}
+
+void LiquidSimulation::UpdateGroupStats() {
+    PrepareGroupStats();
+    const size_t chunkCount = ChunkCount(particles.Size(), GroupStatsChunk);
+    #pragma omp parallel for schedule(static) num_threads(GetThreadCount())
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        GatherGroupStats(chunk);
+    }
+    MergeGroupStats();
+}
+
+void LiquidSimulation::PrepareGroupStats() {
+    // Fixed-size chunks merged in order: the sums don't depend on the
+    // thread count
+    const size_t chunkCount = ChunkCount(particles.Size(), GroupStatsChunk);
+    groupStatsChunks.assign(chunkCount * groupCentroids.size(), GroupStats{});
+}
+
+void LiquidSimulation::GatherGroupStats(size_t chunk) {
+    const size_t groupCount = groupCentroids.size();
+    GroupStats* local = groupStatsChunks.data() + chunk * groupCount;
+    const size_t end = std::min(particles.Size(), (chunk + 1) * GroupStatsChunk);
+    for (size_t i = chunk * GroupStatsChunk; i < end; ++i) {
+        const uint8_t group = particleGroup[i];
+        if (group >= groupCount) continue;
+        const glm::vec3 position = particles.GetPosition(i);
+        local[group].Add(position, particles.GetVelocity(i));
+        if (particleGroupDistance[i] < 0.3f) {
+            const glm::vec3 offset = position - groupCentroids[group].position;
+            local[group].OfferRepresentative(static_cast<uint32_t>(i), glm::dot(offset, offset));
+        }
+    }
+}
+
+void LiquidSimulation::MergeGroupStats() {
+    const size_t groupCount = groupCentroids.size();
+    const size_t chunkCount = groupCount ? groupStatsChunks.size() / groupCount : 0;
+    groupStats.assign(groupCount, GroupStats{});
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        for (size_t group = 0; group < groupCount; ++group) {
+            groupStats[group].Merge(groupStatsChunks[chunk * groupCount + group]);
+        }
+    }
+}
+
+int LiquidSimulation::GetThreadCount() const {
+    return threadCount > 0 ? threadCount : omp_get_max_threads();
+}
+
+const std::vector<LiquidParticle>& LiquidSimulation::GetParticles() const {
+    if (particleViewDirty) {
+        particleView.resize(particles.Size());
+        for (size_t i = 0; i < particles.Size(); ++i) {
+            particleView[i] = particles.Get(i);
+        }
+        particleViewDirty = false;
+    }
+    return particleView;
 }
 
 void LiquidSimulation::CreateCompoundShape(const glm::vec3& center, const glm::vec3& color, int shapeType) {
@@ -128,7 +418,7 @@ void LiquidSimulation::CreateCompoundShape(const glm::vec3& center, const glm::v
             }
         }
         break;
-        
+    
     case 1: // Triangle shape
         {
             int layers = 8; // More layers for bigger groups
@@ -143,7 +433,7 @@ void LiquidSimulation::CreateCompoundShape(const glm::vec3& center, const glm::v
             }
         }
         break;
-        
+    
     case 2: // Ring shape
         {
             int numSpheres = 24; // More spheres in ring
@@ -160,7 +450,7 @@ void LiquidSimulation::CreateCompoundShape(const glm::vec3& center, const glm::v
             }
         }
         break;
-        
+    
     case 3: // Cross shape
         {
             int armLength = 10; // Longer arms
@@ -178,7 +468,7 @@ void LiquidSimulation::CreateCompoundShape(const glm::vec3& center, const glm::v
             }
         }
         break;
-        
+    
     default: // Cluster shape (default)
         {
             int numSpheres = 30; // More spheres in cluster
@@ -205,44 +495,221 @@ void LiquidSimulation::CreateCompoundShape(const glm::vec3& center, const glm::v
 }
 
 void LiquidSimulation::Update(float deltaTime) {
+    TRACE_SCOPE("Update");
     // Update global time
     globalTime += deltaTime;
     
-    // Spawn new particles periodically (disabled to reduce jitter)
-    // timeSinceLastSpawn += deltaTime;
-    // if (timeSinceLastSpawn >= spawnInterval && particles.size() < maxParticles) {
-    //     timeSinceLastSpawn = 0.0f;
-    //     SpawnNewParticle();
-    // }
+    // Retire expired particles and close the holes before any phase runs;
+    // emitted particles are appended after the compaction
+    ExpireParticles();
+    Compact();
+    EmitParticles(deltaTime);
+    
+    if (taskGraphEnabled) {
+        RunTaskGraph(deltaTime);
+        particleViewDirty = true;
+    } else {
+        for (Phase phase : UpdatePhases) {
+            RunPhase(phase, deltaTime);
+        }
+    }
+}
+
+void LiquidSimulation::RunTaskGraph(float deltaTime) {
+    // Each task waits for the tasks that write what it reads, or read what
+    // it writes; anything else may overlap. Every particle sees the same
+    // inputs as with the phases run in order, so results are identical.
+    const size_t count = particles.Size();
+    const size_t chunks = ChunkCount(count, TaskChunk);
+    auto ranges = [count](auto body) {
+        return [count, body](size_t chunk) {
+            body(chunk * TaskChunk, std::min(count, (chunk + 1) * TaskChunk));
+        };
+    };
+    TaskGraph& graph = updateGraph;
+    graph.Clear();
+    
+    // Neighbors come from positions; centroids own the group state. The
+    // list is counted, sized, then filled, each chunk writing its own rows,
+    // and each chunk of Density reads only its own rows.
+    const TaskGraph::Task neighborGrid = graph.Add("NeighborSearch/Grid", [this] { PrepareNeighborList(); });
+    const TaskGraph::Task neighborCounts = graph.AddChunked("NeighborSearch/Count", chunks,
+        ranges([this](size_t begin, size_t end) { CountNeighbors(begin, end); }), {neighborGrid});
+    const TaskGraph::Task neighborOffsets = graph.Add("NeighborSearch/Offsets",
+        [this] { neighborList.Allocate(); }, {neighborCounts});
+    const TaskGraph::Task neighbors = graph.AddChunked("NeighborSearch", chunks,
+        ranges([this](size_t begin, size_t end) { FillNeighbors(begin, end); }), {neighborOffsets});
+    const TaskGraph::Task densitySetup = graph.Add("Density/Setup", [this] { PrepareDensities(); });
+    const TaskGraph::Task density = graph.AddChunked("Density", chunks,
+        ranges([this](size_t begin, size_t end) { ComputeDensities(begin, end); }),
+        {densitySetup}, {neighbors});
+    const TaskGraph::Task centroids = graph.Add("Centroids", [this, deltaTime] { MoveCentroids(deltaTime); });
+    // Only when a centroid color drifted; each chunk of Forces reads the
+    // memberships of its own particles
+    const TaskGraph::Task membership = graph.AddChunked("Centroids/Membership", chunks,
+        ranges([this](size_t begin, size_t end) {
+            if (membershipStale) RefreshGroupMembership(begin, end);
+        }), {centroids});
+    // After the centroids so the random draws keep their order, and after
+    // the density arrays are sized so its fallback never resizes them under
+    // the Density chunks. Every chunk of Forces reads the densities of its
+    // neighbors, wherever they are.
+    const TaskGraph::Task forcesSetup = graph.Add("Forces/Setup", [this] { PrepareForces(); },
+        {centroids, densitySetup});
+    const TaskGraph::Task forces = graph.AddChunked("Forces", chunks,
+        ranges([this, deltaTime](size_t begin, size_t end) { ApplyForces(begin, end, deltaTime); }),
+        {density, forcesSetup}, {membership});
+    // Swaps the velocities every chunk of Forces reads
+    const TaskGraph::Task forcesDone = graph.Add("Forces/Finish", [this] { FinishForces(); }, {forces});
+    const TaskGraph::Task positions = graph.AddChunked("Positions", chunks,
+        ranges([this, deltaTime](size_t begin, size_t end) { UpdatePositions(begin, end, deltaTime); }),
+        {forcesDone});
+    // Waves only touch their own particles, so each chunk follows its
+    // positions; colors count neighbors and wait for all of them
+    graph.AddChunked("Waves", chunks,
+        ranges([this, deltaTime](size_t begin, size_t end) { UpdateWaves(begin, end, deltaTime); }),
+        {}, {positions});
+    const TaskGraph::Task histogram = graph.Add("Colors/Histogram", [this] { BuildColorHistogram(); }, {positions});
+    const TaskGraph::Task targets = graph.AddChunked("Colors", chunks,
+        ranges([this](size_t begin, size_t end) { PickTargetColors(begin, end); }), {histogram});
+    graph.AddChunked("Colors/Apply", chunks,
+        ranges([this, deltaTime](size_t begin, size_t end) { ApplyColorTransitions(begin, end, deltaTime); }),
+        {}, {targets});
     
-    UpdateCentroids(deltaTime);
-    ApplyForces(deltaTime);
-    UpdatePositions(deltaTime);
-    UpdateColors(deltaTime);
-    UpdateWaves(deltaTime);
-    ResolveCollisions();
-    HandleWallCollisions();
+    // Contact batches move arbitrary particles and must run in order, so
+    // they get every thread to themselves
+    graph.AddExclusive("Collisions", [this] { ResolveCollisions(); });
+    
+    // Waves and group stats both read the final positions, and neither
+    // writes anything the other reads
+    const TaskGraph::Task walls = graph.AddChunked("WallCollisions", chunks,
+        ranges([this](size_t begin, size_t end) { HandleWallCollisions(begin, end); }));
+    TaskGraph::Task field = graph.Add("WavePropagation/Inject",
+        [this, deltaTime] { InjectWaveEvents(); waveField.BeginStep(deltaTime); }, {walls});
+    // One task per z-slab and substep; each substep reads the one before
+    for (int substep = 0; substep < waveField.GetSubstepCount(deltaTime); ++substep) {
+        field = graph.AddChunked("WavePropagation/Field", waveField.GetDimension(2),
+            [this, substep](size_t z) { waveField.StepSlabs(substep, int(z), int(z) + 1); }, {field});
+    }
+    field = graph.Add("WavePropagation/Finish", [this] { waveField.EndStep(); }, {field});
+    graph.AddChunked("WavePropagation", chunks,
+        ranges([this](size_t begin, size_t end) { PropagateWaves(begin, end); }), {field});
+    const TaskGraph::Task statsSetup = graph.Add("GroupStats/Setup", [this] { PrepareGroupStats(); });
+    const TaskGraph::Task stats = graph.AddChunked("GroupStats", ChunkCount(count, GroupStatsChunk),
+        [this](size_t chunk) { GatherGroupStats(chunk); }, {walls, statsSetup});
+    graph.Add("GroupStats/Merge", [this] { MergeGroupStats(); }, {stats});
+    
+    graph.Run(GetThreadCount());
+}
+
+void LiquidSimulation::RunPhase(Phase phase, float deltaTime) {
+    TRACE_SCOPE(GetPhaseName(phase));
+    switch (phase) {
+    case Phase::NeighborSearch: BuildNeighborList(); break;
+    case Phase::Density: ComputeDensities(); break;
+    case Phase::Centroids: UpdateCentroids(deltaTime); break;
+    case Phase::Forces: ApplyForces(deltaTime); break;
+    case Phase::Positions: UpdatePositions(deltaTime); break;
+    case Phase::Colors: UpdateColors(deltaTime); break;
+    case Phase::Waves: UpdateWaves(deltaTime); break;
+    case Phase::Collisions: ResolveCollisions(); break;
+    case Phase::WallCollisions: HandleWallCollisions(); break;
+    case Phase::WavePropagation: PropagateWaves(deltaTime); break; // Applies every wave event queued above
+    case Phase::GroupStats: UpdateGroupStats(); break;
+    }
+    particleViewDirty = true;
+}
+
+const char* LiquidSimulation::GetPhaseName(Phase phase) {
+    switch (phase) {
+    case Phase::NeighborSearch: return "NeighborSearch";
+    case Phase::Density: return "Density";
+    case Phase::Centroids: return "Centroids";
+    case Phase::Forces: return "Forces";
+    case Phase::Positions: return "Positions";
+    case Phase::Colors: return "Colors";
+    case Phase::Waves: return "Waves";
+    case Phase::Collisions: return "Collisions";
+    case Phase::WallCollisions: return "WallCollisions";
+    case Phase::WavePropagation: return "WavePropagation";
+    case Phase::GroupStats: return "GroupStats";
+    }
+    return "Unknown";
+}
+
+void LiquidSimulation::BuildNeighborList() {
+    auto positionOf = [this](size_t i) { return particles.GetPosition(i); };
+    grid.Build(particles.Size(), interactionRadius, positionOf);
+    neighborList.Build(grid, particles.Size(), interactionRadius, smoothingRadius, positionOf, GetThreadCount());
+}
+
+void LiquidSimulation::PrepareNeighborList() {
+    grid.Build(particles.Size(), interactionRadius, [this](size_t i) { return particles.GetPosition(i); });
+    neighborList.Start(particles.Size(), interactionRadius, smoothingRadius);
+}
+
+void LiquidSimulation::CountNeighbors(size_t begin, size_t end) {
+    neighborList.Count(grid, begin, end, [this](size_t i) { return particles.GetPosition(i); });
+}
+
+void LiquidSimulation::FillNeighbors(size_t begin, size_t end) {
+    neighborList.Fill(grid, begin, end, [this](size_t i) { return particles.GetPosition(i); });
+}
+
+void LiquidSimulation::ComputeDensities() {
+    const size_t count = particles.Size();
+    const size_t blocks = ChunkCount(count, LoopBlock);
+    PrepareDensities();
+    #pragma omp parallel for schedule(static) num_threads(GetThreadCount())
+    for (size_t block = 0; block < blocks; ++block) {
+        ComputeDensities(block * LoopBlock, std::min(count, (block + 1) * LoopBlock));
+    }
+}
+
+void LiquidSimulation::PrepareDensities() {
+    densities.resize(particles.Size());
+    inverseDensities.resize(particles.Size());
+    pressureRatios.resize(particles.Size());
+}
+
+void LiquidSimulation::ComputeDensities(size_t begin, size_t end) {
+    const float selfWeight = smoothingKernel.Density(0.0f);
+    for (size_t i = begin; i < end; ++i) {
+        // Self included, so density is never zero
+        float density = particles.mass[i] * selfWeight;
+        for (size_t n = neighborList.GetBegin(i); n < neighborList.GetInnerEnd(i); ++n) {
+            const float dist = neighborList.GetDistance(i, n);
+            density += particles.mass[neighborList.GetIndex(n)] * smoothingKernel.Density(dist * dist);
+        }
+        // Clamped: a sparse fluid doesn't pull itself together
+        const float pressure = pressureConstant * std::max(density - restDensity, 0.0f);
+        densities[i] = density;
+        inverseDensities[i] = 1.0f / density;
+        pressureRatios[i] = pressure / (density * density);
+    }
 }
 
 void LiquidSimulation::UpdateCentroids(float deltaTime) {
+    MoveCentroids(deltaTime);
+    if (membershipStale) {
+        RefreshGroupMembership();
+    }
+}
+
+void LiquidSimulation::MoveCentroids(float deltaTime) {
+    bool centroidColorsMoved = false;
     
     // Update each group centroid with complex movement
     for (size_t i = 0; i < groupCentroids.size(); ++i) {
         auto& centroid = groupCentroids[i];
         
-        // Periodically trigger waves from group centers
+        // Periodically trigger waves from group centers, at the strong
+        // member nearest the centroid as of the last stats pass
         float waveTime = globalTime + centroid.phase;
-        if (sin(waveTime * 2.0f) > 0.95f && percentDist(rng) < 30) {
-            // Find a particle near this centroid to start the wave
-            for (size_t p = 0; p < particles.size(); ++p) {
-                float colorDist = glm::length(particles[p].color - centroid.color);
-                if (colorDist < 0.3f) {
-                    float dist = glm::length(particles[p].position - centroid.position);
-                    if (dist < 10.0f) {
-                        PropagateWave(p, 0.8f);
-                        break;
-                    }
-                }
+        if (sin(waveTime * 2.0f) > 0.95f && percentDist(rng) < 30 && i < groupStats.size()) {
+            const GroupStats& stats = groupStats[i];
+            if (stats.representative < particles.Size() && stats.representativeDistance2 < 10.0f * 10.0f) {
+                QueueWave(stats.representative, 0.8f);
             }
         }
         
@@ -289,42 +756,64 @@ void LiquidSimulation::UpdateCentroids(float deltaTime) {
             }
         }
         centroid.color = avgColor / influence;
+        centroidColorsMoved |= i >= membershipColors.size() ||
+            glm::length(centroid.color - membershipColors[i]) > MembershipColorTolerance;
+    }
+    
+    // Colors morph a little nearly every step; memberships only follow
+    // once some centroid has drifted past the tolerance
+    membershipStale = centroidColorsMoved;
+    if (membershipStale) {
+        SnapshotMembershipColors();
     }
 }
 
 void LiquidSimulation::UpdateColors(float deltaTime) {
-    // Count particles of each color in local neighborhoods
-    std::vector<std::vector<int>> colorCounts(particles.size());
-    for (auto& counts : colorCounts) {
-        counts.resize(groupCentroids.size(), 0);
+    const size_t count = particles.Size();
+    const size_t blocks = ChunkCount(count, LoopBlock);
+    BuildColorHistogram();
+    
+    // First pass: pick each particle's target from its neighborhood counts.
+    // Colors are only read here, so every particle sees the same snapshot.
+    #pragma omp parallel num_threads(GetThreadCount())
+    {
+        TRACE_SCOPE("Colors/Worker");
+        #pragma omp for schedule(dynamic) nowait
+        for (size_t block = 0; block < blocks; ++block) {
+            PickTargetColors(block * LoopBlock, std::min(count, (block + 1) * LoopBlock));
+        }
     }
     
-    // First pass: count nearby colors for each particle
-    for (size_t i = 0; i < particles.size(); ++i) {
-        // Count colors in neighborhood
-        int totalNearby = 0;
+    // Second pass: apply color transitions
+    #pragma omp parallel for schedule(static) num_threads(GetThreadCount())
+    for (size_t block = 0; block < blocks; ++block) {
+        ApplyColorTransitions(block * LoopBlock, std::min(count, (block + 1) * LoopBlock), deltaTime);
+    }
+}
+
+void LiquidSimulation::BuildColorHistogram() {
+    const size_t groupCount = std::min(groupCentroids.size(), GroupHistogram::MaxGroups);
+    
+    // Count particles of each color group once per cell
+    colorHistogram.Build(particles.Size(), groupCount, colorRadius,
+        [this](size_t i) { return particles.GetPosition(i); },
+        [this](size_t i) { return CountedGroup(i); });
+}
+
+void LiquidSimulation::PickTargetColors(size_t begin, size_t end) {
+    const size_t groupCount = std::min(groupCentroids.size(), GroupHistogram::MaxGroups);
+    for (size_t i = begin; i < end; ++i) {
+        // Count colors in neighborhood, excluding self
+        std::array<int, GroupHistogram::MaxGroups> colorCounts{};
+        colorHistogram.Count(particles.GetPosition(i), colorCountMode, colorCounts.data());
+        uint8_t ownGroup = CountedGroup(i);
+        if (ownGroup != GroupHistogram::Uncounted) {
+            colorCounts[ownGroup]--;
+        }
         
-        for (size_t j = 0; j < particles.size(); ++j) {
-            if (i == j) continue;
-            
-            float dist = glm::length(particles[j].position - particles[i].position);
-            if (dist < 2.0f) { // Smaller radius for smaller particles
-                // Find which color group this particle belongs to
-                int colorGroup = -1;
-                float minColorDist = 999.0f;
-                for (size_t c = 0; c < groupCentroids.size(); ++c) {
-                    float cDist = glm::length(particles[j].color - groupCentroids[c].color);
-                    if (cDist < minColorDist) {
-                        minColorDist = cDist;
-                        colorGroup = c;
-                    }
-                }
-                
-                if (colorGroup >= 0 && minColorDist < 0.5f) {
-                    colorCounts[i][colorGroup]++;
-                    totalNearby++;
-                }
-            }
+        int totalNearby = 0;
+        for (size_t c = 0; c < groupCount; ++c) {
+            totalNearby += colorCounts[c];
         }
         
         // Takeover mechanic: if overwhelmed by another color, convert
@@ -333,9 +822,9 @@ void LiquidSimulation::UpdateColors(float deltaTime) {
             int maxCount = 0;
             
             // Find dominant color group
-            for (size_t c = 0; c < groupCentroids.size(); ++c) {
-                if (colorCounts[i][c] > maxCount) {
-                    maxCount = colorCounts[i][c];
+            for (size_t c = 0; c < groupCount; ++c) {
+                if (colorCounts[c] > maxCount) {
+                    maxCount = colorCounts[c];
                     dominantGroup = c;
                 }
             }
@@ -344,119 +833,153 @@ void LiquidSimulation::UpdateColors(float deltaTime) {
             float overwhelmRatio = static_cast<float>(maxCount) / totalNearby;
             if (dominantGroup >= 0 && overwhelmRatio > 0.7f) {
                 // Check if this is a different color than current
-                float currentColorDist = glm::length(particles[i].color - groupCentroids[dominantGroup].color);
+                float currentColorDist = glm::length(particles.color[i] - groupCentroids[dominantGroup].color);
                 if (currentColorDist > 0.5f) {
                     // Takeover! Set target color to dominant group
-                    particles[i].targetColor = groupCentroids[dominantGroup].color;
-                    particles[i].colorTransitionSpeed = 5.0f; // Fast takeover
+                    particles.targetColor[i] = groupCentroids[dominantGroup].color;
+                    particles.colorTransitionSpeed[i] = 5.0f; // Fast takeover
                 }
             }
         }
         
         // Otherwise, try to maintain group cohesion
         else {
-            // Find nearest centroid of same color
-            int myGroup = -1;
-            float minDist = 999.0f;
-            for (size_t c = 0; c < groupCentroids.size(); ++c) {
-                float colorDist = glm::length(particles[i].color - groupCentroids[c].color);
-                if (colorDist < 0.3f) {
-                    float dist = glm::length(particles[i].position - groupCentroids[c].position);
-                    if (dist < minDist) {
-                        minDist = dist;
-                        myGroup = c;
-                    }
-                }
-            }
-            
-            if (myGroup >= 0) {
+            // Centroid of same color
+            uint8_t myGroup = particleGroupDistance[i] < 0.3f ? particleGroup[i] : NoGroup;
+            if (myGroup != NoGroup) {
                 // Maintain group color
-                particles[i].targetColor = groupCentroids[myGroup].color;
-                particles[i].colorTransitionSpeed = 2.0f; // Normal speed
+                particles.targetColor[i] = groupCentroids[myGroup].color;
+                particles.colorTransitionSpeed[i] = 2.0f; // Normal speed
+            }
+        }
+    }
+}
+
+void LiquidSimulation::ApplyColorTransitions(size_t begin, size_t end, float deltaTime) {
+    for (size_t i = begin; i < end; ++i) {
+        glm::vec3 colorStep = (particles.targetColor[i] - particles.color[i]) * 
+                              particles.colorTransitionSpeed[i] * deltaTime;
+        if (colorStep != glm::vec3(0.0f)) {
+            particles.color[i] += colorStep;
+            const glm::vec3 drift = particles.color[i] - particleMembershipColor[i];
+            if (glm::dot(drift, drift) > MembershipColorTolerance * MembershipColorTolerance) {
+                UpdateGroupMembership(i);
             }
         }
-        
-        // Apply color transition
-        particles[i].color += (particles[i].targetColor - particles[i].color) * 
-                              particles[i].colorTransitionSpeed * deltaTime;
     }
 }
 
 void LiquidSimulation::SpawnNewParticle() {
-    // Randomly select a color group or create a blend
-    std::vector<glm::vec3> groupColors = {
-        glm::vec3(0.2f, 0.6f, 1.0f),  // Blue
-        glm::vec3(1.0f, 0.3f, 0.5f),  // Pink/Red
-        glm::vec3(0.3f, 1.0f, 0.6f),  // Mint Green
-        glm::vec3(1.0f, 0.7f, 0.2f),  // Orange/Yellow
-        glm::vec3(0.8f, 0.3f, 1.0f),  // Purple
-        glm::vec3(0.3f, 1.0f, 1.0f)   // Cyan
-    };
+    if (groupCentroids.empty() || groupStats.size() < groupCentroids.size()) return;
     
-    // Sometimes spawn with a blended color
-    glm::vec3 color;
+    // Randomly select a color group, sometimes blended with another
+    std::uniform_int_distribution<size_t> groupDist(0, groupCentroids.size() - 1);
+    size_t group = groupDist(rng);
+    glm::vec3 color = groupCentroids[group].color;
     if (percentDist(rng) < 20) { // 20% chance of blended color
-        std::uniform_int_distribution<size_t> groupDist(0, groupColors.size() - 1);
-        size_t g1 = groupDist(rng);
-        size_t g2 = groupDist(rng);
+        const size_t other = groupDist(rng);
         float blend = unitDist(rng);
-        color = groupColors[g1] * blend + groupColors[g2] * (1.0f - blend);
-    } else {
-        std::uniform_int_distribution<size_t> groupDist(0, groupColors.size() - 1);
-        color = groupColors[groupDist(rng)];
+        color = color * blend + groupCentroids[other].color * (1.0f - blend);
+        if (blend < 0.5f) group = other;
     }
     
-    // Find average position of this color group
-    glm::vec3 avgPos(0.0f);
-    int count = 0;
-    for (const auto& p : particles) {
-        if (glm::length(p.color - color) < 0.1f) {
-            avgPos += p.position;
-            count++;
+    // Spawn near the average position of the group the color is closest
+    // to, from the last GroupStats pass
+    const GroupStats& stats = groupStats[group];
+    if (stats.count == 0) return;
+    glm::vec3 offset(
+        (unitDist(rng) - 0.5f) * 5.0f,
+        3.5f,  // Spawn from above in shallow space
+        (unitDist(rng) - 0.5f) * 5.0f
+    );
+    Spawn({stats.GetMeanPosition() + offset, glm::vec3(0.0f), color, emitLifetime});
+}
+
+void LiquidSimulation::ApplyForces(float deltaTime) {
+    const size_t count = particles.Size();
+    const size_t blocks = ChunkCount(count, LoopBlock);
+    PrepareForces();
+    
+    // Gather-only: each iteration reads shared state and writes particle i
+    #pragma omp parallel num_threads(GetThreadCount())
+    {
+        TRACE_SCOPE("Forces/Worker");
+        #pragma omp for schedule(dynamic) nowait
+        for (size_t block = 0; block < blocks; ++block) {
+            ApplyForces(block * LoopBlock, std::min(count, (block + 1) * LoopBlock), deltaTime);
         }
     }
     
-    if (count > 0) {
-        avgPos /= static_cast<float>(count);
-        // Spawn near the group center with some random offset
-        glm::vec3 offset(
-            (unitDist(rng) - 0.5f) * 5.0f,
-            3.5f,  // Spawn from above in shallow space
-            (unitDist(rng) - 0.5f) * 5.0f
+    FinishForces();
+}
+
+void LiquidSimulation::PrepareForces() {
+    const size_t count = particles.Size();
+    // Forces run on their own read the last step's densities
+    if (densities.size() != count) {
+        densities.assign(count, restDensity);
+        inverseDensities.assign(count, 1.0f / restDensity);
+        pressureRatios.assign(count, 0.0f);
+    }
+    nextVx.resize(count);
+    nextVy.resize(count);
+    nextVz.resize(count);
+    waveTriggered.assign(count, 0);
+    
+    // Draw all randomness serially so the parallel loop never touches rng
+    explorationNoise.resize(count);
+    waveRolls.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        float nx = unitDist(rng);
+        float ny = unitDist(rng);
+        float nz = unitDist(rng);
+        explorationNoise[i] = glm::vec3(
+            (nx - 0.5f) * 0.5f,
+            (ny - 0.5f) * 0.3f, // Vertical movement
+            (nz - 0.5f) * 0.5f
         );
-        AddParticle(avgPos + offset, glm::vec3(0.0f), color);
+        waveRolls[i] = percentDist(rng);
     }
 }
 
-void LiquidSimulation::ApplyForces(float deltaTime) {
-    static float time = 0.0f;
-    time += deltaTime;
+void LiquidSimulation::ApplyForces(size_t begin, size_t end, float deltaTime) {
+    const size_t count = particles.Size();
+    static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "pair kernel reads colors as interleaved rgb");
+    const PairKernelParams params{interactionRadius, smoothingKernel};
+    const PairNeighbors allNeighbors{
+        particles.x.data(), particles.y.data(), particles.z.data(),
+        particles.vx.data(), particles.vy.data(), particles.vz.data(),
+        particles.mass.data(), particles.radius.data(),
+        count ? &particles.color[0].x : nullptr,
+        inverseDensities.data(), pressureRatios.data(),
+        nullptr, 0
+    };
     
-    for (size_t i = 0; i < particles.size(); ++i) {
+    for (size_t i = begin; i < end; ++i) {
+        PairNeighbors neighbors = allNeighbors;
+        const glm::vec3 position = particles.GetPosition(i);
+        const glm::vec3 velocity = particles.GetVelocity(i);
+        const glm::vec3 color = particles.color[i];
+        const float mass = particles.mass[i];
+        const float radius = particles.radius[i];
+        
         glm::vec3 force(0.0f);
         
         // Gentle gravity
-        force.y += gravity * particles[i].mass;
+        force.y += gravity * mass;
         
         // Boid-like forces with dynamic centroid attraction
         glm::vec3 separation(0.0f), alignment(0.0f), cohesion(0.0f);
         float totalWeight = 0.0f;
         
-        // Find nearest group centroid based on color
-        int nearestCentroid = -1;
-        float minColorDist = 999.0f;
-        for (size_t c = 0; c < groupCentroids.size(); ++c) {
-            float colorDist = glm::length(particles[i].color - groupCentroids[c].color);
-            if (colorDist < minColorDist) {
-                minColorDist = colorDist;
-                nearestCentroid = c;
-            }
-        }
+        // Nearest group centroid based on color
+        const uint8_t nearestCentroid = particleGroup[i];
+        const float minColorDist = particleGroupDistance[i];
         
         // Attraction to moving centroid
         glm::vec3 centroidForce(0.0f);
-        if (nearestCentroid >= 0) {
-            glm::vec3 toCentroid = groupCentroids[nearestCentroid].position - particles[i].position;
+        if (nearestCentroid != NoGroup) {
+            glm::vec3 toCentroid = groupCentroids[nearestCentroid].position - position;
             float dist = glm::length(toCentroid);
             if (dist > 0.1f) {
                 // Stronger attraction when far, weaker when close
@@ -465,41 +988,16 @@ void LiquidSimulation::ApplyForces(float deltaTime) {
             }
         }
         
-        for (size_t j = 0; j < particles.size(); ++j) {
-            if (i == j) continue;
-            
-            glm::vec3 diff = particles[j].position - particles[i].position;
-            float dist = glm::length(diff);
-            
-            // Check if same color group
-            float colorDist = glm::length(particles[i].color - particles[j].color);
-            
-            if (dist < 5.0f && dist > 0.001f) {  // Smaller neighborhood for smaller blobs
-                glm::vec3 normalized = diff / dist;
-                
-                // Color similarity affects attraction (0 = different, 1 = same)
-                float colorSimilarity = 1.0f - (colorDist / 3.0f);
-                colorSimilarity = std::max(0.0f, colorSimilarity);
-                
-                // Mass affects influence
-                float massInfluence = particles[j].mass / (particles[i].mass + particles[j].mass);
-                
-                // Separation scaled for smaller blobs
-                float separationDist = particles[i].radius + particles[j].radius + 0.2f;
-                if (dist < separationDist) {
-                    separation -= normalized * (separationDist - dist) * 5.0f * (2.0f - colorSimilarity);
-                }
-                
-                // 3D Alignment - influenced by color similarity and mass
-                glm::vec3 velDiff = particles[j].velocity - particles[i].velocity;
-                alignment += velDiff * colorSimilarity * massInfluence * 0.5f;
-                
-                // 3D Cohesion - stronger for similar colors, with vertical component
-                glm::vec3 posDiff = particles[j].position - particles[i].position;
-                cohesion += posDiff * colorSimilarity * 0.3f;
-                totalWeight += colorSimilarity;
-            }
-        }
+        // Boid and SPH terms over all neighbors in one fused pass
+        PairAccumulator acc;
+        const size_t listBegin = neighborList.GetBegin(i);
+        neighbors.indices = neighborList.GetIndexData() + listBegin;
+        neighbors.count = neighborList.GetEnd(i) - listBegin;
+        pairKernel({position, velocity, color, mass, radius, pressureRatios[i]}, neighbors, params, acc);
+        separation = acc.separation;
+        alignment = acc.alignment;
+        cohesion = acc.cohesion;
+        totalWeight = acc.totalWeight;
         
         // Apply boid forces with proper 3D movement
         if (totalWeight > 0.1f) {
@@ -513,232 +1011,222 @@ void LiquidSimulation::ApplyForces(float deltaTime) {
         force += centroidForce * 3.0f; // Stronger centroid following
         
         // Add 3D exploration force
-        force += glm::vec3(
-            (unitDist(rng) - 0.5f) * 0.5f,
-            (unitDist(rng) - 0.5f) * 0.3f, // Vertical movement
-            (unitDist(rng) - 0.5f) * 0.5f
-        );
+        force += explorationNoise[i];
         
-        // Trigger waves when groups merge
-        if (totalWeight > 2.0f && percentDist(rng) < 5) { // 5% chance when near many particles
-            PropagateWave(i, 0.5f);
+        // Trigger waves when groups merge (applied after the parallel loop)
+        if (totalWeight > 2.0f && waveRolls[i] < 5) { // 5% chance when near many particles
+            waveTriggered[i] = 1;
         }
         
-        // Add small pressure force for fluid behavior
-        force += CalculatePressureForce(i) * 0.3f;
+        // SPH pressure and viscosity from the cached densities
+        force += acc.pressure * mass;
+        force += acc.viscosity * (viscosityConstant * mass * inverseDensities[i]);
         
-        particles[i].velocity += force * deltaTime / particles[i].mass;
-        particles[i].velocity *= damping;
+        glm::vec3 newVelocity = velocity + force * deltaTime / mass;
+        newVelocity *= damping;
         
         // Higher velocity limit for faster movement
-        float speed = glm::length(particles[i].velocity);
+        float speed = glm::length(newVelocity);
         if (speed > 15.0f) {
-            particles[i].velocity = (particles[i].velocity / speed) * 15.0f;
+            newVelocity = (newVelocity / speed) * 15.0f;
         }
+        nextVx[i] = newVelocity.x;
+        nextVy[i] = newVelocity.y;
+        nextVz[i] = newVelocity.z;
     }
 }
 
-void LiquidSimulation::UpdatePositions(float deltaTime) {
-    for (auto& particle : particles) {
-        particle.position += particle.velocity * deltaTime;
+void LiquidSimulation::FinishForces() {
+    const size_t count = particles.Size();
+    particles.vx.swap(nextVx);
+    particles.vy.swap(nextVy);
+    particles.vz.swap(nextVz);
+    
+    for (size_t i = 0; i < count; ++i) {
+        if (waveTriggered[i]) {
+            QueueWave(i, 0.5f);
+        }
     }
 }
 
-void LiquidSimulation::ResolveCollisions() {
-    for (size_t i = 0; i < particles.size(); ++i) {
-        for (size_t j = i + 1; j < particles.size(); ++j) {
-            glm::vec3 diff = particles[i].position - particles[j].position;
-            float distSq = glm::dot(diff, diff);
-            float minDistance = particles[i].radius + particles[j].radius;
-            float minDistSq = minDistance * minDistance;
-            
-            if (distSq < minDistSq && distSq > 0.0001f) {
-                float distance = std::sqrt(distSq);
-                glm::vec3 normal = diff / distance;
-                float overlap = minDistance - distance;
-                
-                particles[i].position += normal * overlap * 0.5f;
-                particles[j].position -= normal * overlap * 0.5f;
-                
-                glm::vec3 relVel = particles[i].velocity - particles[j].velocity;
-                float velAlongNormal = glm::dot(relVel, normal);
-                
-                if (velAlongNormal > 0) {
-                    float restitution = 0.1f;
-                    float j = -(1 + restitution) * velAlongNormal;
-                    j /= 1.0f / particles[i].mass + 1.0f / particles[j].mass;
-                    
-                    glm::vec3 impulse = j * normal;
-                    particles[i].velocity += impulse / particles[i].mass;
-                    particles[j].velocity -= impulse / particles[j].mass;
-                    
-                    // Trigger wave on collision
-                    float collisionIntensity = std::min(1.0f, velAlongNormal * 0.1f);
-                    PropagateWave(i, collisionIntensity);
-                    PropagateWave(j, collisionIntensity * 0.8f);
-                }
-            }
-        }
+void LiquidSimulation::UpdatePositions(float deltaTime) {
+    const size_t count = particles.Size();
+    const size_t blocks = ChunkCount(count, LoopBlock);
+    #pragma omp parallel for schedule(static) num_threads(GetThreadCount())
+    for (size_t block = 0; block < blocks; ++block) {
+        UpdatePositions(block * LoopBlock, std::min(count, (block + 1) * LoopBlock), deltaTime);
     }
 }
 
-void LiquidSimulation::HandleWallCollisions() {
-    for (auto& particle : particles) {
-        // Shallow rectangular boundaries
-        float halfWidth = 15.0f;  // Match wall boundaries
-        float halfDepth = 10.0f;  // Match wall boundaries
-        float maxHeight = 5.0f;   // Very shallow
-        
-        // X boundaries with reduced bounce
-        if (particle.position.x - particle.radius < -halfWidth) {
-            particle.position.x = -halfWidth + particle.radius;
-            particle.velocity.x = -particle.velocity.x * 0.3f;
-        }
-        if (particle.position.x + particle.radius > halfWidth) {
-            particle.position.x = halfWidth - particle.radius;
-            particle.velocity.x = -particle.velocity.x * 0.3f;
-        }
-        
-        // Z boundaries with reduced bounce
-        if (particle.position.z - particle.radius < -halfDepth) {
-            particle.position.z = -halfDepth + particle.radius;
-            particle.velocity.z = -particle.velocity.z * 0.3f;
-        }
-        if (particle.position.z + particle.radius > halfDepth) {
-            particle.position.z = halfDepth - particle.radius;
-            particle.velocity.z = -particle.velocity.z * 0.3f;
-        }
-        
-        // Y boundaries (floor and ceiling)
-        if (particle.position.y - particle.radius < 0.0f) {
-            particle.position.y = particle.radius;
-            particle.velocity.y = -particle.velocity.y * 0.5f;
-        }
-        if (particle.position.y + particle.radius > maxHeight) {
-            particle.position.y = maxHeight - particle.radius;
-            particle.velocity.y = -particle.velocity.y * 0.5f;
-        }
+void LiquidSimulation::UpdatePositions(size_t begin, size_t end, float deltaTime) {
+    for (size_t i = begin; i < end; ++i) {
+        particles.x[i] += particles.vx[i] * deltaTime;
+        particles.y[i] += particles.vy[i] * deltaTime;
+        particles.z[i] += particles.vz[i] * deltaTime;
     }
 }
 
-glm::vec3 LiquidSimulation::CalculatePressureForce(size_t particleIndex) {
-    glm::vec3 force(0.0f);
-    neighbors.clear();
+void LiquidSimulation::ResolveCollisions() {
+    contactSolver.Solve(particles, collisionIterations, GetThreadCount());
     
-    // Find neighbors and check if they're from the same group (similar color)
-    for (size_t i = 0; i < particles.size(); ++i) {
-        if (i != particleIndex) {
-            float dist = glm::length(particles[i].position - particles[particleIndex].position);
-            if (dist < smoothingRadius) {
-                neighbors.push_back(i);
-            }
+    // Trigger waves on collision, in the solver's fixed contact order
+    for (const auto& contact : contactSolver.GetContacts()) {
+        if (contact.waveIntensity >= 0.0f) {
+            QueueWave(contact.a, contact.waveIntensity);
+            QueueWave(contact.b, contact.waveIntensity * 0.8f);
         }
     }
-    
-    float density = particles[particleIndex].mass; // Include self
-    for (size_t i : neighbors) {
-        float dist = glm::length(particles[i].position - particles[particleIndex].position);
-        if (smoothingRadius > 0.0f) {
-            float influence = std::max(0.0f, 1.0f - (dist / smoothingRadius));
-            
-            // Stronger influence if same color group
-            glm::vec3 colorDiff = particles[i].color - particles[particleIndex].color;
-            float colorSimilarity = std::max(0.1f, 1.0f - glm::length(colorDiff) * 0.3f);
-            
-            density += particles[i].mass * influence * influence * colorSimilarity;
-        }
+}
+
+void LiquidSimulation::HandleWallCollisions() {
+    const size_t count = particles.Size();
+    const size_t blocks = ChunkCount(count, LoopBlock);
+    #pragma omp parallel for schedule(static) num_threads(GetThreadCount())
+    for (size_t block = 0; block < blocks; ++block) {
+        HandleWallCollisions(block * LoopBlock, std::min(count, (block + 1) * LoopBlock));
     }
-    
-    float pressure = pressureConstant * (density - restDensity);
-    
-    for (size_t i : neighbors) {
-        glm::vec3 diff = particles[particleIndex].position - particles[i].position;
-        float dist = glm::length(diff);
-        if (dist > 0.0001f) {
-            float influence = 1.0f - (dist / smoothingRadius);
+}
+
+void LiquidSimulation::HandleWallCollisions(size_t begin, size_t end) {
+    if (wallField.IsEmpty()) return;
+    // Sample a block at a time straight from the coordinate arrays, so the
+    // lookups vectorize; only the few particles touching a wall go on
+    float distances[LoopBlock], normalX[LoopBlock], normalY[LoopBlock], normalZ[LoopBlock];
+    for (size_t block = begin; block < end; block += LoopBlock) {
+        const size_t size = std::min(LoopBlock, end - block);
+        wallField.SampleBatch(&particles.x[block], &particles.y[block], &particles.z[block], size,
+                              distances, normalX, normalY, normalZ);
+        for (size_t k = 0; k < size; ++k) {
+            const size_t i = block + k;
+            const float radius = particles.radius[i];
+            const float distance = distances[k];
+            if (distance >= radius) continue;
+            glm::vec3 normal(normalX[k], normalY[k], normalZ[k]);
+            const float normalLength = glm::length(normal);
+            if (normalLength < 1e-6f) continue;
+            normal /= normalLength;
             
-            // Cohesion force for same color group
-            glm::vec3 colorDiff = particles[i].color - particles[particleIndex].color;
-            float colorSimilarity = 1.0f - glm::length(colorDiff) * 0.3f;
+            // Push out along the normal until the particle just touches
+            const float depth = radius - distance;
+            particles.x[i] += normal.x * depth;
+            particles.y[i] += normal.y * depth;
+            particles.z[i] += normal.z * depth;
             
-            force += (diff / dist) * pressure * influence * colorSimilarity;
+            // Reflect the velocity into the wall with reduced bounce: 0.3 off
+            // side walls, 0.5 off the floor and ceiling
+            const float approach = glm::dot(particles.GetVelocity(i), normal);
+            if (approach < 0.0f) {
+                const float bounce = 0.3f + 0.2f * std::abs(normal.y);
+                const float impulse = -(1.0f + bounce) * approach;
+                particles.vx[i] += normal.x * impulse;
+                particles.vy[i] += normal.y * impulse;
+                particles.vz[i] += normal.z * impulse;
+            }
         }
     }
-    
-    return force;
 }
 
-glm::vec3 LiquidSimulation::CalculateViscosityForce(size_t particleIndex) {
-    glm::vec3 force(0.0f);
-    
-    for (size_t i : neighbors) {
-        glm::vec3 velDiff = particles[i].velocity - particles[particleIndex].velocity;
-        float dist = glm::length(particles[i].position - particles[particleIndex].position);
-        if (dist > 0.0001f && smoothingRadius > 0.0f) {
-            float influence = 1.0f - (dist / smoothingRadius);
-            force += velDiff * viscosityConstant * influence;
-        }
+void LiquidSimulation::UpdateWaves(float deltaTime) {
+    const size_t count = particles.Size();
+    const size_t blocks = ChunkCount(count, LoopBlock);
+    #pragma omp parallel for schedule(static) num_threads(GetThreadCount())
+    for (size_t block = 0; block < blocks; ++block) {
+        UpdateWaves(block * LoopBlock, std::min(count, (block + 1) * LoopBlock), deltaTime);
     }
-    
-    return force;
 }
 
-void LiquidSimulation::UpdateWaves(float deltaTime) {
+void LiquidSimulation::UpdateWaves(size_t begin, size_t end, float deltaTime) {
     // Update wave properties for each particle
-    for (auto& particle : particles) {
+    for (size_t i = begin; i < end; ++i) {
         // Update wave phase
-        particle.wavePhase += deltaTime * 2.0f; // Slower wave speed
+        particles.wavePhase[i] += deltaTime * 2.0f; // Slower wave speed
         
         // Decay wave amplitude
-        particle.waveAmplitude *= (1.0f - deltaTime * (1.0f - particle.waveDecay));
+        particles.waveAmplitude[i] *= (1.0f - deltaTime * (1.0f - particles.waveDecay[i]));
         
         // Keep radius constant - no size changes
-        particle.radius = particle.baseRadius;
+        particles.radius[i] = particles.baseRadius[i];
         
         // Apply wave motion to particle position for group movement
-        float waveEffect = sin(particle.wavePhase) * particle.waveAmplitude;
+        const float phase = particles.wavePhase[i];
+        float waveEffect = sin(phase) * particles.waveAmplitude[i];
         
         // Create wave-like group movements
         glm::vec3 waveForce(0.0f);
-        waveForce.x = cos(particle.wavePhase * 1.3f) * waveEffect * 2.0f;
-        waveForce.y = sin(particle.wavePhase * 2.1f) * waveEffect * 1.0f;
-        waveForce.z = sin(particle.wavePhase * 0.7f) * waveEffect * 2.0f;
+        waveForce.x = cos(phase * 1.3f) * waveEffect * 2.0f;
+        waveForce.y = sin(phase * 2.1f) * waveEffect * 1.0f;
+        waveForce.z = sin(phase * 0.7f) * waveEffect * 2.0f;
         
         // Apply wave force as velocity change
-        particle.velocity += waveForce * deltaTime;
+        particles.vx[i] += waveForce.x * deltaTime;
+        particles.vy[i] += waveForce.y * deltaTime;
+        particles.vz[i] += waveForce.z * deltaTime;
     }
 }
 
-void LiquidSimulation::PropagateWave(size_t sourceIndex, float intensity) {
-    if (sourceIndex >= particles.size()) return;
-    
-    const auto& source = particles[sourceIndex];
+void LiquidSimulation::QueueWave(size_t sourceIndex, float intensity) {
+    if (sourceIndex >= particles.Size()) return;
+    waveEvents.push_back({static_cast<uint32_t>(sourceIndex), intensity});
+}
+
+void LiquidSimulation::PropagateWaves(float deltaTime) {
+    InjectWaveEvents();
+    waveField.Step(deltaTime, GetThreadCount());
+    if (waveField.IsQuiet()) return;
+    const size_t count = particles.Size();
+    const size_t blocks = ChunkCount(count, LoopBlock);
     
-    // Propagate wave to nearby particles of the same color group
-    for (size_t i = 0; i < particles.size(); ++i) {
-        if (i == sourceIndex) continue;
+    // Each particle only samples the field and writes itself
+    #pragma omp parallel for schedule(static) num_threads(GetThreadCount())
+    for (size_t block = 0; block < blocks; ++block) {
+        PropagateWaves(block * LoopBlock, std::min(count, (block + 1) * LoopBlock));
+    }
+}
+
+void LiquidSimulation::InjectWaveEvents() {
+    // Events land in their source's group channel, in queue order
+    for (const auto& event : waveEvents) {
+        const uint8_t group = particleGroup[event.source];
+        if (group == NoGroup) continue;
+        waveField.Inject(group, particles.GetPosition(event.source), event.intensity,
+                         particles.wavePhase[event.source]);
+    }
+    waveEvents.clear();
+}
+
+void LiquidSimulation::PropagateWaves(size_t begin, size_t end) {
+    if (waveField.IsQuiet()) return; // Nothing left to spread
+    for (size_t i = begin; i < end; ++i) {
+        const uint8_t group = particleGroup[i];
+        if (group == NoGroup) continue;
+        float amplitude, phase;
+        if (!waveField.Sample(group, particles.GetPosition(i), amplitude, phase)) continue;
         
-        float dist = glm::length(particles[i].position - source.position);
-        float maxDist = 20.0f; // Wave propagation distance
+        // Color similarity to the group scales what the particle picks up
+        const float colorSimilarity = std::max(0.0f, 1.0f - particleGroupDistance[i]);
+        const float strength = amplitude * colorSimilarity;
         
-        if (dist < maxDist && dist > 0.001f) {
-            // Color similarity affects wave propagation
-            float colorDist = glm::length(particles[i].color - source.color);
-            float colorSimilarity = std::max(0.0f, 1.0f - colorDist);
-            
-            // Calculate wave intensity based on distance and color
-            float falloff = 1.0f - (dist / maxDist);
-            falloff = falloff * falloff * colorSimilarity; // Quadratic falloff with color weighting
-            
-            // Add wave energy with phase delay based on distance
-            float phaseDelay = dist * 0.3f;
-            particles[i].waveAmplitude = std::max(particles[i].waveAmplitude, 
-                                                 intensity * falloff);
-            
-            // Synchronize phase for group movement
-            if (colorSimilarity > 0.8f) {
-                particles[i].wavePhase = source.wavePhase - phaseDelay;
-            }
+        // Synchronize phase for group movement; the field already lags
+        // the phase by distance from the source
+        if (colorSimilarity > 0.8f && strength >= particles.waveAmplitude[i]) {
+            particles.wavePhase[i] = phase;
         }
+        particles.waveAmplitude[i] = std::max(particles.waveAmplitude[i], strength);
     }
-}
\ No newline at end of file
+}
+
+void LiquidSimulation::ConfigureWaveField(WaveField& field, const std::vector<Wall>& walls, size_t channels) {
+    // Covers every wall's full extent, not just its center
+    glm::vec3 minBound(0.0f), maxBound(0.0f);
+    if (!walls.empty()) {
+        minBound = glm::vec3(std::numeric_limits<float>::max());
+        maxBound = glm::vec3(std::numeric_limits<float>::lowest());
+        for (const Wall& wall : walls) {
+            minBound = glm::min(minBound, wall.GetPosition() - wall.GetSize() * 0.5f);
+            maxBound = glm::max(maxBound, wall.GetPosition() + wall.GetSize() * 0.5f);
+        }
+    }
+    WaveField::Params params;
+    params.phaseRate = 2.0f; // Keeps pace with UpdateWaves
+    field.Configure(minBound, maxBound, channels, params);
+}
@@ -0,0 +1,40 @@
+#include "MappedFile.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Cannot open " + path);
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error("Cannot stat " + path);
+    }
+    size = static_cast<size_t>(info.st_size);
+    if (size > 0) {
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Cannot map " + path);
+        }
+        data = static_cast<const uint8_t*>(mapped);
+    }
+    close(fd); // The mapping keeps the file alive
+}
+
+MappedFile::~MappedFile() {
+    if (data) munmap(const_cast<uint8_t*>(data), size);
+}
+
+void MappedFile::Prefetch(size_t offset, size_t bytes) const {
+    if (!data || offset >= size) return;
+    // madvise wants a page-aligned start
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t start = offset & ~(pageSize - 1);
+    const size_t end = std::min(size, offset + bytes);
+    madvise(const_cast<uint8_t*>(data) + start, end - start, MADV_WILLNEED);
+}
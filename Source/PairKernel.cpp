@@ -0,0 +1,94 @@
+#include "PairKernel.h"
+#include <algorithm>
+#include <cmath>
+
+PairKernelIsa GetSupportedPairKernelIsa() {
+#if defined(__x86_64__) || defined(__i386__)
+    static const PairKernelIsa isa = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return PairKernelIsa::AVX512;
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return PairKernelIsa::AVX2;
+        return PairKernelIsa::Scalar;
+    }();
+    return isa;
+#else
+    return PairKernelIsa::Scalar;
+#endif
+}
+
+PairKernelFn GetPairKernel(PairKernelIsa isa) {
+    switch (isa) {
+#if defined(__x86_64__) || defined(__i386__)
+    case PairKernelIsa::AVX512: return EvaluatePairsAVX512;
+    case PairKernelIsa::AVX2: return EvaluatePairsAVX2;
+#endif
+    default: return EvaluatePairsScalar;
+    }
+}
+
+const char* GetPairKernelName(PairKernelIsa isa) {
+    switch (isa) {
+    case PairKernelIsa::AVX512: return "AVX-512";
+    case PairKernelIsa::AVX2: return "AVX2";
+    default: return "Scalar";
+    }
+}
+
+void EvaluatePairsScalar(const PairSubject& subject, const PairNeighbors& neighbors,
+                         const PairKernelParams& params, PairAccumulator& acc) {
+    const float radiusSq = params.interactionRadius * params.interactionRadius;
+    const SphKernel& kernel = params.smoothing;
+    
+    for (size_t k = 0; k < neighbors.count; ++k) {
+        const uint32_t j = neighbors.indices[k];
+        
+        glm::vec3 diff(neighbors.x[j] - subject.position.x,
+                       neighbors.y[j] - subject.position.y,
+                       neighbors.z[j] - subject.position.z);
+        float distSq = glm::dot(diff, diff);
+        
+        glm::vec3 colorDiff(subject.color.r - neighbors.color[3 * j],
+                            subject.color.g - neighbors.color[3 * j + 1],
+                            subject.color.b - neighbors.color[3 * j + 2]);
+        float colorDist = glm::length(colorDiff);
+        float massJ = neighbors.mass[j];
+        
+        // Boid terms, within the interaction radius
+        if (distSq < radiusSq && distSq > 0.001f * 0.001f) {
+            float dist = std::sqrt(distSq);
+            glm::vec3 normalized = diff / dist;
+            
+            // Color similarity affects attraction (0 = different, 1 = same)
+            float colorSimilarity = std::max(0.0f, 1.0f - (colorDist / 3.0f));
+            
+            // Mass affects influence
+            float massInfluence = massJ / (subject.mass + massJ);
+            
+            float separationDist = subject.radius + neighbors.radius[j] + 0.2f;
+            if (dist < separationDist) {
+                acc.separation -= normalized * (separationDist - dist) * 5.0f * (2.0f - colorSimilarity);
+            }
+            
+            glm::vec3 velDiff(neighbors.vx[j] - subject.velocity.x,
+                              neighbors.vy[j] - subject.velocity.y,
+                              neighbors.vz[j] - subject.velocity.z);
+            acc.alignment += velDiff * colorSimilarity * massInfluence * 0.5f;
+            acc.cohesion += diff * colorSimilarity * 0.3f;
+            acc.totalWeight += colorSimilarity;
+        }
+        
+        // SPH terms, within the smoothing radius: symmetric pressure and
+        // viscosity from the cached densities and pressures
+        if (distSq < kernel.radiusSq && distSq > 0.0001f * 0.0001f) {
+            float dist = std::sqrt(distSq);
+            float inverseDensity = neighbors.inverseDensity[j];
+            float pressureTerm = subject.pressureRatio + neighbors.pressureRatio[j];
+            acc.pressure += diff * (massJ * pressureTerm * kernel.PressureGradient(dist) / dist);
+            
+            glm::vec3 velDiff(neighbors.vx[j] - subject.velocity.x,
+                              neighbors.vy[j] - subject.velocity.y,
+                              neighbors.vz[j] - subject.velocity.z);
+            acc.viscosity += velDiff * (massJ * inverseDensity * kernel.Viscosity(dist));
+        }
+    }
+}
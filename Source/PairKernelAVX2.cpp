@@ -0,0 +1,164 @@
+#include "PairKernel.h"
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+// Only the functions below are compiled for AVX2/FMA (via the target
+// attribute), so nothing here leaks AVX2 code into shared inline functions.
+#define PAIR_KERNEL_AVX2 __attribute__((target("avx2,fma")))
+
+namespace {
+    PAIR_KERNEL_AVX2 inline float HorizontalSum(__m256 v) {
+        __m128 lo = _mm256_castps256_ps128(v);
+        __m128 hi = _mm256_extractf128_ps(v, 1);
+        lo = _mm_add_ps(lo, hi);
+        __m128 shuf = _mm_movehdup_ps(lo);
+        __m128 sums = _mm_add_ps(lo, shuf);
+        shuf = _mm_movehl_ps(shuf, sums);
+        return _mm_cvtss_f32(_mm_add_ss(sums, shuf));
+    }
+    
+    // Bitwise AND with a compare mask zeroes masked-out lanes, including any
+    // inf/NaN from dividing by a zero distance
+    PAIR_KERNEL_AVX2 inline __m256 Masked(__m256 value, __m256 mask) {
+        return _mm256_and_ps(value, mask);
+    }
+}
+
+PAIR_KERNEL_AVX2
+void EvaluatePairsAVX2(const PairSubject& subject, const PairNeighbors& neighbors,
+                       const PairKernelParams& params, PairAccumulator& acc) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 radiusSq = _mm256_set1_ps(params.interactionRadius * params.interactionRadius);
+    const __m256 smoothingSq = _mm256_set1_ps(params.smoothing.radiusSq);
+    const __m256 smoothing = _mm256_set1_ps(params.smoothing.radius);
+    const __m256 spikyGradient = _mm256_set1_ps(params.smoothing.spikyGradient);
+    const __m256 viscosityLaplacian = _mm256_set1_ps(params.smoothing.viscosityLaplacian);
+    const __m256 minDistSq = _mm256_set1_ps(0.001f * 0.001f);
+    const __m256 minPressureDistSq = _mm256_set1_ps(0.0001f * 0.0001f);
+    const __m256 pressureRatio = _mm256_set1_ps(subject.pressureRatio);
+    
+    const __m256 px = _mm256_set1_ps(subject.position.x);
+    const __m256 py = _mm256_set1_ps(subject.position.y);
+    const __m256 pz = _mm256_set1_ps(subject.position.z);
+    const __m256 pvx = _mm256_set1_ps(subject.velocity.x);
+    const __m256 pvy = _mm256_set1_ps(subject.velocity.y);
+    const __m256 pvz = _mm256_set1_ps(subject.velocity.z);
+    const __m256 pr = _mm256_set1_ps(subject.color.r);
+    const __m256 pg = _mm256_set1_ps(subject.color.g);
+    const __m256 pb = _mm256_set1_ps(subject.color.b);
+    const __m256 pmass = _mm256_set1_ps(subject.mass);
+    const __m256 pradius = _mm256_set1_ps(subject.radius + 0.2f);
+    const __m256i laneIds = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    
+    __m256 sepX = zero, sepY = zero, sepZ = zero;
+    __m256 aliX = zero, aliY = zero, aliZ = zero;
+    __m256 cohX = zero, cohY = zero, cohZ = zero;
+    __m256 weight = zero;
+    __m256 presX = zero, presY = zero, presZ = zero;
+    __m256 viscX = zero, viscY = zero, viscZ = zero;
+    
+    for (size_t k = 0; k < neighbors.count; k += 8) {
+        const int lanes = static_cast<int>(std::min<size_t>(8, neighbors.count - k));
+        const __m256i laneMask = _mm256_cmpgt_epi32(_mm256_set1_epi32(lanes), laneIds);
+        const __m256 valid = _mm256_castsi256_ps(laneMask);
+        
+        const __m256i idx = _mm256_maskload_epi32(reinterpret_cast<const int*>(neighbors.indices + k), laneMask);
+        const __m256i idx3 = _mm256_mullo_epi32(idx, _mm256_set1_epi32(3));
+        
+        const __m256 x = _mm256_mask_i32gather_ps(zero, neighbors.x, idx, valid, 4);
+        const __m256 y = _mm256_mask_i32gather_ps(zero, neighbors.y, idx, valid, 4);
+        const __m256 z = _mm256_mask_i32gather_ps(zero, neighbors.z, idx, valid, 4);
+        const __m256 r = _mm256_mask_i32gather_ps(zero, neighbors.color, idx3, valid, 4);
+        const __m256 g = _mm256_mask_i32gather_ps(zero, neighbors.color + 1, idx3, valid, 4);
+        const __m256 b = _mm256_mask_i32gather_ps(zero, neighbors.color + 2, idx3, valid, 4);
+        const __m256 mass = _mm256_mask_i32gather_ps(one, neighbors.mass, idx, valid, 4);
+        
+        const __m256 dx = _mm256_sub_ps(x, px);
+        const __m256 dy = _mm256_sub_ps(y, py);
+        const __m256 dz = _mm256_sub_ps(z, pz);
+        const __m256 distSq = _mm256_fmadd_ps(dz, dz, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dx, dx)));
+        const __m256 dist = _mm256_sqrt_ps(distSq);
+        const __m256 invDist = _mm256_div_ps(one, dist);
+        
+        const __m256 dr = _mm256_sub_ps(pr, r);
+        const __m256 dg = _mm256_sub_ps(pg, g);
+        const __m256 db = _mm256_sub_ps(pb, b);
+        const __m256 colorDist = _mm256_sqrt_ps(_mm256_fmadd_ps(db, db, _mm256_fmadd_ps(dg, dg, _mm256_mul_ps(dr, dr))));
+        
+        const __m256 forceMask = _mm256_and_ps(valid, _mm256_and_ps(
+            _mm256_cmp_ps(distSq, radiusSq, _CMP_LT_OQ),
+            _mm256_cmp_ps(distSq, minDistSq, _CMP_GT_OQ)));
+        const __m256 sphMask = _mm256_and_ps(valid, _mm256_and_ps(
+            _mm256_cmp_ps(distSq, smoothingSq, _CMP_LT_OQ),
+            _mm256_cmp_ps(distSq, minPressureDistSq, _CMP_GT_OQ)));
+        const __m256 velocityMask = _mm256_or_ps(forceMask, sphMask);
+        if (!_mm256_movemask_ps(velocityMask)) continue;
+        
+        // Relative velocities, shared by alignment and viscosity
+        const __m256 dvx = _mm256_sub_ps(_mm256_mask_i32gather_ps(zero, neighbors.vx, idx, velocityMask, 4), pvx);
+        const __m256 dvy = _mm256_sub_ps(_mm256_mask_i32gather_ps(zero, neighbors.vy, idx, velocityMask, 4), pvy);
+        const __m256 dvz = _mm256_sub_ps(_mm256_mask_i32gather_ps(zero, neighbors.vz, idx, velocityMask, 4), pvz);
+        
+        // Boid terms
+        if (_mm256_movemask_ps(forceMask)) {
+            const __m256 radius = _mm256_mask_i32gather_ps(zero, neighbors.radius, idx, forceMask, 4);
+            
+            const __m256 colorSimilarity = Masked(_mm256_max_ps(zero,
+                _mm256_sub_ps(one, _mm256_div_ps(colorDist, _mm256_set1_ps(3.0f)))), forceMask);
+            const __m256 massInfluence = _mm256_div_ps(mass, _mm256_add_ps(pmass, mass));
+            
+            const __m256 separationDist = _mm256_add_ps(pradius, radius);
+            const __m256 sepMask = _mm256_and_ps(forceMask, _mm256_cmp_ps(dist, separationDist, _CMP_LT_OQ));
+            const __m256 sepScale = Masked(_mm256_mul_ps(_mm256_mul_ps(
+                _mm256_mul_ps(_mm256_sub_ps(separationDist, dist), _mm256_set1_ps(5.0f)),
+                _mm256_sub_ps(_mm256_set1_ps(2.0f), colorSimilarity)), invDist), sepMask);
+            sepX = _mm256_fnmadd_ps(dx, sepScale, sepX);
+            sepY = _mm256_fnmadd_ps(dy, sepScale, sepY);
+            sepZ = _mm256_fnmadd_ps(dz, sepScale, sepZ);
+            
+            const __m256 alignScale = _mm256_mul_ps(_mm256_mul_ps(colorSimilarity, massInfluence), _mm256_set1_ps(0.5f));
+            aliX = _mm256_fmadd_ps(dvx, alignScale, aliX);
+            aliY = _mm256_fmadd_ps(dvy, alignScale, aliY);
+            aliZ = _mm256_fmadd_ps(dvz, alignScale, aliZ);
+            
+            const __m256 cohesionScale = _mm256_mul_ps(colorSimilarity, _mm256_set1_ps(0.3f));
+            cohX = _mm256_fmadd_ps(dx, cohesionScale, cohX);
+            cohY = _mm256_fmadd_ps(dy, cohesionScale, cohY);
+            cohZ = _mm256_fmadd_ps(dz, cohesionScale, cohZ);
+            weight = _mm256_add_ps(weight, colorSimilarity);
+        }
+        
+        // SPH terms: symmetric pressure and viscosity
+        if (_mm256_movemask_ps(sphMask)) {
+            const __m256 invDensity = _mm256_mask_i32gather_ps(zero, neighbors.inverseDensity, idx, sphMask, 4);
+            const __m256 pressureTerm = _mm256_add_ps(pressureRatio,
+                _mm256_mask_i32gather_ps(zero, neighbors.pressureRatio, idx, sphMask, 4));
+            const __m256 falloff = _mm256_sub_ps(smoothing, dist);
+            
+            const __m256 gradient = _mm256_mul_ps(spikyGradient, _mm256_mul_ps(falloff, falloff));
+            const __m256 presScale = Masked(_mm256_mul_ps(_mm256_mul_ps(mass, pressureTerm),
+                _mm256_mul_ps(gradient, invDist)), sphMask);
+            presX = _mm256_fmadd_ps(dx, presScale, presX);
+            presY = _mm256_fmadd_ps(dy, presScale, presY);
+            presZ = _mm256_fmadd_ps(dz, presScale, presZ);
+            
+            const __m256 viscScale = Masked(_mm256_mul_ps(_mm256_mul_ps(mass, invDensity),
+                _mm256_mul_ps(viscosityLaplacian, falloff)), sphMask);
+            viscX = _mm256_fmadd_ps(dvx, viscScale, viscX);
+            viscY = _mm256_fmadd_ps(dvy, viscScale, viscY);
+            viscZ = _mm256_fmadd_ps(dvz, viscScale, viscZ);
+        }
+    }
+    
+    acc.separation += glm::vec3(HorizontalSum(sepX), HorizontalSum(sepY), HorizontalSum(sepZ));
+    acc.alignment += glm::vec3(HorizontalSum(aliX), HorizontalSum(aliY), HorizontalSum(aliZ));
+    acc.cohesion += glm::vec3(HorizontalSum(cohX), HorizontalSum(cohY), HorizontalSum(cohZ));
+    acc.totalWeight += HorizontalSum(weight);
+    acc.pressure += glm::vec3(HorizontalSum(presX), HorizontalSum(presY), HorizontalSum(presZ));
+    acc.viscosity += glm::vec3(HorizontalSum(viscX), HorizontalSum(viscY), HorizontalSum(viscZ));
+}
+
+#endif
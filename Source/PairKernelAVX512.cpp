@@ -0,0 +1,145 @@
+#include "PairKernel.h"
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+// GCC 12's AVX-512 headers trip -Wuninitialized on their own undefined
+// passthrough operands (fixed in GCC 13)
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+#define PAIR_KERNEL_AVX512 __attribute__((target("avx512f")))
+
+PAIR_KERNEL_AVX512
+void EvaluatePairsAVX512(const PairSubject& subject, const PairNeighbors& neighbors,
+                         const PairKernelParams& params, PairAccumulator& acc) {
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 one = _mm512_set1_ps(1.0f);
+    const __m512 radiusSq = _mm512_set1_ps(params.interactionRadius * params.interactionRadius);
+    const __m512 smoothingSq = _mm512_set1_ps(params.smoothing.radiusSq);
+    const __m512 smoothing = _mm512_set1_ps(params.smoothing.radius);
+    const __m512 spikyGradient = _mm512_set1_ps(params.smoothing.spikyGradient);
+    const __m512 viscosityLaplacian = _mm512_set1_ps(params.smoothing.viscosityLaplacian);
+    const __m512 minDistSq = _mm512_set1_ps(0.001f * 0.001f);
+    const __m512 minPressureDistSq = _mm512_set1_ps(0.0001f * 0.0001f);
+    const __m512 pressureRatio = _mm512_set1_ps(subject.pressureRatio);
+    
+    const __m512 px = _mm512_set1_ps(subject.position.x);
+    const __m512 py = _mm512_set1_ps(subject.position.y);
+    const __m512 pz = _mm512_set1_ps(subject.position.z);
+    const __m512 pvx = _mm512_set1_ps(subject.velocity.x);
+    const __m512 pvy = _mm512_set1_ps(subject.velocity.y);
+    const __m512 pvz = _mm512_set1_ps(subject.velocity.z);
+    const __m512 pr = _mm512_set1_ps(subject.color.r);
+    const __m512 pg = _mm512_set1_ps(subject.color.g);
+    const __m512 pb = _mm512_set1_ps(subject.color.b);
+    const __m512 pmass = _mm512_set1_ps(subject.mass);
+    const __m512 pradius = _mm512_set1_ps(subject.radius + 0.2f);
+    
+    __m512 sepX = zero, sepY = zero, sepZ = zero;
+    __m512 aliX = zero, aliY = zero, aliZ = zero;
+    __m512 cohX = zero, cohY = zero, cohZ = zero;
+    __m512 weight = zero;
+    __m512 presX = zero, presY = zero, presZ = zero;
+    __m512 viscX = zero, viscY = zero, viscZ = zero;
+    
+    for (size_t k = 0; k < neighbors.count; k += 16) {
+        const unsigned lanes = static_cast<unsigned>(std::min<size_t>(16, neighbors.count - k));
+        const __mmask16 valid = static_cast<__mmask16>((1u << lanes) - 1);
+        
+        const __m512i idx = _mm512_maskz_loadu_epi32(valid, neighbors.indices + k);
+        const __m512i idx3 = _mm512_mullo_epi32(idx, _mm512_set1_epi32(3));
+        
+        const __m512 x = _mm512_mask_i32gather_ps(zero, valid, idx, neighbors.x, 4);
+        const __m512 y = _mm512_mask_i32gather_ps(zero, valid, idx, neighbors.y, 4);
+        const __m512 z = _mm512_mask_i32gather_ps(zero, valid, idx, neighbors.z, 4);
+        const __m512 r = _mm512_mask_i32gather_ps(zero, valid, idx3, neighbors.color, 4);
+        const __m512 g = _mm512_mask_i32gather_ps(zero, valid, idx3, neighbors.color + 1, 4);
+        const __m512 b = _mm512_mask_i32gather_ps(zero, valid, idx3, neighbors.color + 2, 4);
+        const __m512 mass = _mm512_mask_i32gather_ps(one, valid, idx, neighbors.mass, 4);
+        
+        const __m512 dx = _mm512_sub_ps(x, px);
+        const __m512 dy = _mm512_sub_ps(y, py);
+        const __m512 dz = _mm512_sub_ps(z, pz);
+        const __m512 distSq = _mm512_fmadd_ps(dz, dz, _mm512_fmadd_ps(dy, dy, _mm512_mul_ps(dx, dx)));
+        const __m512 dist = _mm512_sqrt_ps(distSq);
+        
+        const __m512 dr = _mm512_sub_ps(pr, r);
+        const __m512 dg = _mm512_sub_ps(pg, g);
+        const __m512 db = _mm512_sub_ps(pb, b);
+        const __m512 colorDist = _mm512_sqrt_ps(_mm512_fmadd_ps(db, db, _mm512_fmadd_ps(dg, dg, _mm512_mul_ps(dr, dr))));
+        
+        const __mmask16 forceMask = _mm512_mask_cmp_ps_mask(
+            _mm512_mask_cmp_ps_mask(valid, distSq, radiusSq, _CMP_LT_OQ), distSq, minDistSq, _CMP_GT_OQ);
+        const __mmask16 sphMask = _mm512_mask_cmp_ps_mask(
+            _mm512_mask_cmp_ps_mask(valid, distSq, smoothingSq, _CMP_LT_OQ), distSq, minPressureDistSq, _CMP_GT_OQ);
+        const __mmask16 velocityMask = forceMask | sphMask;
+        if (!velocityMask) continue;
+        
+        // Relative velocities, shared by alignment and viscosity
+        const __m512 dvx = _mm512_sub_ps(_mm512_mask_i32gather_ps(zero, velocityMask, idx, neighbors.vx, 4), pvx);
+        const __m512 dvy = _mm512_sub_ps(_mm512_mask_i32gather_ps(zero, velocityMask, idx, neighbors.vy, 4), pvy);
+        const __m512 dvz = _mm512_sub_ps(_mm512_mask_i32gather_ps(zero, velocityMask, idx, neighbors.vz, 4), pvz);
+        
+        // Boid terms
+        if (forceMask) {
+            const __m512 radius = _mm512_mask_i32gather_ps(zero, forceMask, idx, neighbors.radius, 4);
+            const __m512 invDist = _mm512_maskz_div_ps(forceMask, one, dist);
+            
+            const __m512 colorSimilarity = _mm512_maskz_max_ps(forceMask, zero,
+                _mm512_sub_ps(one, _mm512_div_ps(colorDist, _mm512_set1_ps(3.0f))));
+            const __m512 massInfluence = _mm512_maskz_div_ps(forceMask, mass, _mm512_add_ps(pmass, mass));
+            
+            const __m512 separationDist = _mm512_add_ps(pradius, radius);
+            const __mmask16 sepMask = _mm512_mask_cmp_ps_mask(forceMask, dist, separationDist, _CMP_LT_OQ);
+            const __m512 sepScale = _mm512_maskz_mul_ps(sepMask, _mm512_mul_ps(
+                _mm512_mul_ps(_mm512_sub_ps(separationDist, dist), _mm512_set1_ps(5.0f)),
+                _mm512_sub_ps(_mm512_set1_ps(2.0f), colorSimilarity)), invDist);
+            sepX = _mm512_fnmadd_ps(dx, sepScale, sepX);
+            sepY = _mm512_fnmadd_ps(dy, sepScale, sepY);
+            sepZ = _mm512_fnmadd_ps(dz, sepScale, sepZ);
+            
+            const __m512 alignScale = _mm512_mul_ps(_mm512_mul_ps(colorSimilarity, massInfluence), _mm512_set1_ps(0.5f));
+            aliX = _mm512_fmadd_ps(dvx, alignScale, aliX);
+            aliY = _mm512_fmadd_ps(dvy, alignScale, aliY);
+            aliZ = _mm512_fmadd_ps(dvz, alignScale, aliZ);
+            
+            const __m512 cohesionScale = _mm512_mul_ps(colorSimilarity, _mm512_set1_ps(0.3f));
+            cohX = _mm512_fmadd_ps(dx, cohesionScale, cohX);
+            cohY = _mm512_fmadd_ps(dy, cohesionScale, cohY);
+            cohZ = _mm512_fmadd_ps(dz, cohesionScale, cohZ);
+            weight = _mm512_add_ps(weight, colorSimilarity);
+        }
+        
+        // SPH terms: symmetric pressure and viscosity
+        if (sphMask) {
+            const __m512 invDensity = _mm512_mask_i32gather_ps(zero, sphMask, idx, neighbors.inverseDensity, 4);
+            const __m512 pressureTerm = _mm512_add_ps(pressureRatio,
+                _mm512_mask_i32gather_ps(zero, sphMask, idx, neighbors.pressureRatio, 4));
+            const __m512 falloff = _mm512_sub_ps(smoothing, dist);
+            
+            const __m512 gradient = _mm512_mul_ps(spikyGradient, _mm512_mul_ps(falloff, falloff));
+            const __m512 presScale = _mm512_maskz_div_ps(sphMask,
+                _mm512_mul_ps(_mm512_mul_ps(mass, pressureTerm), gradient), dist);
+            presX = _mm512_fmadd_ps(dx, presScale, presX);
+            presY = _mm512_fmadd_ps(dy, presScale, presY);
+            presZ = _mm512_fmadd_ps(dz, presScale, presZ);
+            
+            const __m512 viscScale = _mm512_maskz_mul_ps(sphMask, _mm512_mul_ps(mass, invDensity),
+                _mm512_mul_ps(viscosityLaplacian, falloff));
+            viscX = _mm512_fmadd_ps(dvx, viscScale, viscX);
+            viscY = _mm512_fmadd_ps(dvy, viscScale, viscY);
+            viscZ = _mm512_fmadd_ps(dvz, viscScale, viscZ);
+        }
+    }
+    
+    acc.separation += glm::vec3(_mm512_reduce_add_ps(sepX), _mm512_reduce_add_ps(sepY), _mm512_reduce_add_ps(sepZ));
+    acc.alignment += glm::vec3(_mm512_reduce_add_ps(aliX), _mm512_reduce_add_ps(aliY), _mm512_reduce_add_ps(aliZ));
+    acc.cohesion += glm::vec3(_mm512_reduce_add_ps(cohX), _mm512_reduce_add_ps(cohY), _mm512_reduce_add_ps(cohZ));
+    acc.totalWeight += _mm512_reduce_add_ps(weight);
+    acc.pressure += glm::vec3(_mm512_reduce_add_ps(presX), _mm512_reduce_add_ps(presY), _mm512_reduce_add_ps(presZ));
+    acc.viscosity += glm::vec3(_mm512_reduce_add_ps(viscX), _mm512_reduce_add_ps(viscY), _mm512_reduce_add_ps(viscZ));
+}
+
+#endif
@@ -0,0 +1,97 @@
+#include "ParticleStore.h"
+
+void ParticleStore::Reserve(size_t count) {
+    x.reserve(count); y.reserve(count); z.reserve(count);
+    vx.reserve(count); vy.reserve(count); vz.reserve(count);
+    mass.reserve(count);
+    radius.reserve(count);
+    color.reserve(count);
+    targetColor.reserve(count);
+    colorTransitionSpeed.reserve(count);
+    baseRadius.reserve(count);
+    wavePhase.reserve(count);
+    waveAmplitude.reserve(count);
+    waveDecay.reserve(count);
+    expireTime.reserve(count);
+}
+
+void ParticleStore::Resize(size_t count) {
+    x.resize(count); y.resize(count); z.resize(count);
+    vx.resize(count); vy.resize(count); vz.resize(count);
+    mass.resize(count);
+    radius.resize(count);
+    color.resize(count);
+    targetColor.resize(count);
+    colorTransitionSpeed.resize(count);
+    baseRadius.resize(count);
+    wavePhase.resize(count);
+    waveAmplitude.resize(count);
+    waveDecay.resize(count);
+    expireTime.resize(count);
+}
+
+void ParticleStore::Clear() {
+    x.clear(); y.clear(); z.clear();
+    vx.clear(); vy.clear(); vz.clear();
+    mass.clear();
+    radius.clear();
+    color.clear();
+    targetColor.clear();
+    colorTransitionSpeed.clear();
+    baseRadius.clear();
+    wavePhase.clear();
+    waveAmplitude.clear();
+    waveDecay.clear();
+    expireTime.clear();
+}
+
+void ParticleStore::Add(const LiquidParticle& particle) {
+    x.push_back(particle.position.x);
+    y.push_back(particle.position.y);
+    z.push_back(particle.position.z);
+    vx.push_back(particle.velocity.x);
+    vy.push_back(particle.velocity.y);
+    vz.push_back(particle.velocity.z);
+    mass.push_back(particle.mass);
+    radius.push_back(particle.radius);
+    color.push_back(particle.color);
+    targetColor.push_back(particle.targetColor);
+    colorTransitionSpeed.push_back(particle.colorTransitionSpeed);
+    baseRadius.push_back(particle.baseRadius);
+    wavePhase.push_back(particle.wavePhase);
+    waveAmplitude.push_back(particle.waveAmplitude);
+    waveDecay.push_back(particle.waveDecay);
+    expireTime.push_back(particle.expireTime);
+}
+
+void ParticleStore::Move(size_t from, size_t to) {
+    x[to] = x[from]; y[to] = y[from]; z[to] = z[from];
+    vx[to] = vx[from]; vy[to] = vy[from]; vz[to] = vz[from];
+    mass[to] = mass[from];
+    radius[to] = radius[from];
+    color[to] = color[from];
+    targetColor[to] = targetColor[from];
+    colorTransitionSpeed[to] = colorTransitionSpeed[from];
+    baseRadius[to] = baseRadius[from];
+    wavePhase[to] = wavePhase[from];
+    waveAmplitude[to] = waveAmplitude[from];
+    waveDecay[to] = waveDecay[from];
+    expireTime[to] = expireTime[from];
+}
+
+LiquidParticle ParticleStore::Get(size_t i) const {
+    LiquidParticle particle;
+    particle.position = GetPosition(i);
+    particle.velocity = GetVelocity(i);
+    particle.color = color[i];
+    particle.targetColor = targetColor[i];
+    particle.radius = radius[i];
+    particle.baseRadius = baseRadius[i];
+    particle.mass = mass[i];
+    particle.colorTransitionSpeed = colorTransitionSpeed[i];
+    particle.wavePhase = wavePhase[i];
+    particle.waveAmplitude = waveAmplitude[i];
+    particle.waveDecay = waveDecay[i];
+    particle.expireTime = expireTime[i];
+    return particle;
+}
@@ -0,0 +1,53 @@
+#include "RandomParticles.h"
+#include "LiquidSimulation.h"
+#include <algorithm>
+#include <vector>
+
+void AddRandomParticles(LiquidSimulation& simulation, const Config& config,
+                        int begin, int end, std::mt19937& gen) {
+    // Inside the simulation's walls, which are centered on x = 0
+    std::uniform_real_distribution<float> posX(-config.width * 0.5f + 5.0f, config.width * 0.5f - 5.0f);
+    std::uniform_real_distribution<float> posY(5.0f, config.height - 5.0f);  // Use massive height  
+    std::uniform_real_distribution<float> posZ(-15.0f, 15.0f);               // Deeper for perspective
+    std::uniform_real_distribution<float> vel(-3.0f, 3.0f);                  // Higher velocities
+    std::uniform_real_distribution<float> variation(-0.1f, 0.3f);            // Bias toward brighter
+    
+    // Much brighter color palette for visibility
+    std::vector<glm::vec3> colors = {
+        glm::vec3(1.0f, 0.4f, 0.4f),  // Bright Red
+        glm::vec3(0.4f, 1.0f, 0.4f),  // Bright Green  
+        glm::vec3(0.4f, 0.4f, 1.0f),  // Bright Blue
+        glm::vec3(1.0f, 1.0f, 0.4f),  // Bright Yellow
+        glm::vec3(1.0f, 0.4f, 1.0f),  // Bright Magenta
+        glm::vec3(0.4f, 1.0f, 1.0f),  // Bright Cyan
+        glm::vec3(1.0f, 0.7f, 0.2f),  // Orange
+        glm::vec3(0.8f, 0.2f, 1.0f)   // Purple
+    };
+    
+    std::vector<ParticleInit> inits;
+    inits.reserve(std::max(end - begin, 0));
+    for (int i = begin; i < end; ++i) {
+        ParticleInit& init = inits.emplace_back();
+        // Separate statements keep the draw order fixed
+        init.position.x = posX(gen);
+        init.position.y = posY(gen);
+        init.position.z = posZ(gen);
+        init.velocity.x = vel(gen);
+        init.velocity.y = vel(gen) * 0.8f;
+        init.velocity.z = vel(gen) * 0.3f;
+        
+        // Make colors even brighter for visibility
+        glm::vec3 baseColor = colors[i % colors.size()];
+        glm::vec3 colorVariation;
+        colorVariation.r = variation(gen);
+        colorVariation.g = variation(gen);
+        colorVariation.b = variation(gen);
+        init.color = glm::clamp(baseColor + colorVariation, 0.2f, 1.0f);  // Minimum brightness
+    }
+    simulation.AddParticles(inits);
+}
+
+std::mt19937 MakeWorkloadGenerator(uint32_t seed) {
+    std::seed_seq sequence{seed, 0x776f726bu}; // "work"
+    return std::mt19937(sequence);
+}
@@ -1,5 +1,9 @@
 #include "Renderer.h"
 #include "LiquidSimulation.h"
+#include "SimulationStepper.h"
+#include "Trace.h"
+#include "Trajectory.h"
+#include "VertexPacking.h"
 #include "Wall.h"
 #include <fstream>
 #include <sstream>
@@ -68,53 +72,71 @@ void Renderer::InitializeWallBuffers() {
 }
 
 void Renderer::Begin(const glm::mat4& view, const glm::mat4& projection) {
+    TRACE_SCOPE("Renderer::Begin");
     currentView = view;
     currentProjection = projection;
 }
 
 void Renderer::RenderLiquid(const LiquidSimulation& simulation) {
-    const auto& particles = simulation.GetParticles();
-    if (particles.empty()) return;
-    
-    std::vector<float> vertexData;
-    vertexData.reserve(particles.size() * 7);
+    DrawLiquid(simulation, nullptr);
+}
+
+void Renderer::RenderLiquid(const SimulationStepper& stepper) {
+    DrawLiquid(stepper.GetSimulation(), &stepper);
+}
+
+void Renderer::DrawLiquid(const LiquidSimulation& simulation, const SimulationStepper* stepper) {
+    TRACE_SCOPE("Renderer::RenderLiquid");
+    const auto& particles = simulation.GetParticleStore();
+    if (particles.Empty()) return;
     
     // Debug first particle only once
     static bool debugged = false;
-    if (!debugged && !particles.empty()) {
+    if (!debugged) {
         debugged = true;
-        const auto& p = particles[0];
-        std::cout << "First particle: pos(" << p.position.x << "," << p.position.y << "," << p.position.z 
-                  << ") color(" << p.color.r << "," << p.color.g << "," << p.color.b 
-                  << ") radius=" << p.radius << std::endl;
+        std::cout << "First particle: pos(" << particles.x[0] << "," << particles.y[0] << "," << particles.z[0] 
+                  << ") color(" << particles.color[0].r << "," << particles.color[0].g << "," << particles.color[0].b 
+                  << ") radius=" << particles.radius[0] << std::endl;
     }
     
-    for (const auto& particle : particles) {
-        vertexData.push_back(particle.position.x);
-        vertexData.push_back(particle.position.y);
-        vertexData.push_back(particle.position.z);
-        vertexData.push_back(particle.color.r);
-        vertexData.push_back(particle.color.g);
-        vertexData.push_back(particle.color.b);
-        vertexData.push_back(particle.radius * 40.0f);  // Scaled for better visibility
+    {
+        TRACE_SCOPE("Renderer::PackVertices");
+        PackLiquidVertices(particles, stepper, liquidVertices);
     }
-    
+    DrawLiquidVertices();
+}
+
+void Renderer::RenderLiquid(const TrajectoryFrame& frame) {
+    TRACE_SCOPE("Renderer::RenderLiquid");
+    if (frame.Size() == 0) return;
+    {
+        TRACE_SCOPE("Renderer::PackVertices");
+        PackLiquidVertices(frame, liquidVertices);
+    }
+    DrawLiquidVertices();
+}
+
+void Renderer::DrawLiquidVertices() {
     glUseProgram(liquidShader);
     glUniformMatrix4fv(glGetUniformLocation(liquidShader, "view"), 1, GL_FALSE, glm::value_ptr(currentView));
     glUniformMatrix4fv(glGetUniformLocation(liquidShader, "projection"), 1, GL_FALSE, glm::value_ptr(currentProjection));
     
     glBindVertexArray(liquidVAO);
     glBindBuffer(GL_ARRAY_BUFFER, liquidVBO);
-    glBufferData(GL_ARRAY_BUFFER, vertexData.size() * sizeof(float), vertexData.data(), GL_DYNAMIC_DRAW);
+    {
+        TRACE_SCOPE("Renderer::Upload");
+        glBufferData(GL_ARRAY_BUFFER, liquidVertices.size() * sizeof(float), liquidVertices.data(), GL_DYNAMIC_DRAW);
+    }
     
     glEnable(GL_PROGRAM_POINT_SIZE);
-    glDrawArrays(GL_POINTS, 0, particles.size());
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(liquidVertices.size() / LiquidVertexFloats));
     glDisable(GL_PROGRAM_POINT_SIZE);
     
     glBindVertexArray(0);
 }
 
 void Renderer::RenderWalls(const std::vector<Wall>& walls) {
+    TRACE_SCOPE("Renderer::RenderWalls");
     glUseProgram(wallShader);
     glUniformMatrix4fv(glGetUniformLocation(wallShader, "view"), 1, GL_FALSE, glm::value_ptr(currentView));
     glUniformMatrix4fv(glGetUniformLocation(wallShader, "projection"), 1, GL_FALSE, glm::value_ptr(currentProjection));
@@ -142,6 +164,7 @@ void Renderer::RenderWalls(const std::vector<Wall>& walls) {
 }
 
 void Renderer::End() {
+    TRACE_SCOPE("Renderer::End");
     glUseProgram(0);
 }
 
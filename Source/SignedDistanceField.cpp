@@ -0,0 +1,266 @@
+#include "SignedDistanceField.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace {
+    // Clamps one grid coordinate into [0, last] and splits it into a cell
+    // and the offset within it
+    inline void GridCoordinate(float grid, int last, int& base, float& t) {
+        const float clamped = std::min(std::max(grid, 0.0f), static_cast<float>(last));
+        base = std::min(static_cast<int>(clamped), last - 1);
+        t = clamped - base;
+    }
+    
+    // Per axis, how far p lies beyond the box's faces (negative inside)
+    glm::vec3 BoxOffset(const glm::vec3& p, const Wall& wall) {
+        return glm::abs(p - wall.GetPosition()) - wall.GetSize() * 0.5f;
+    }
+    
+    // Signed distance from p to an axis-aligned box
+    float BoxDistance(const glm::vec3& p, const Wall& wall) {
+        const glm::vec3 q = BoxOffset(p, wall);
+        const float largest = std::max(q.x, std::max(q.y, q.z));
+        return glm::length(glm::max(q, 0.0f)) + std::min(largest, 0.0f);
+    }
+    
+    // Squared distance transform of f along one line of n samples
+    // (Felzenszwalb and Huttenlocher), in place. d, v and z are scratch.
+    void DistanceTransform(float* f, int n, std::vector<float>& d, std::vector<int>& v, std::vector<float>& z) {
+        const float inf = std::numeric_limits<float>::infinity();
+        d.resize(n);
+        v.resize(n);
+        z.resize(n + 1);
+        
+        // Lower envelope of the parabolas rooted at every finite sample
+        int k = -1;
+        for (int q = 0; q < n; ++q) {
+            if (f[q] == inf) continue;
+            while (k >= 0) {
+                const int p = v[k];
+                const float s = ((f[q] + float(q) * q) - (f[p] + float(p) * p)) / (2.0f * (q - p));
+                if (s > z[k]) {
+                    v[++k] = q;
+                    z[k] = s;
+                    z[k + 1] = inf;
+                    break;
+                }
+                --k;
+            }
+            if (k < 0) {
+                v[0] = q;
+                z[0] = -inf;
+                z[1] = inf;
+                k = 0;
+            }
+        }
+        if (k < 0) return; // No finite samples on this line
+        
+        for (int q = 0, j = 0; q < n; ++q) {
+            while (z[j + 1] < q) ++j;
+            const float offset = float(q - v[j]);
+            d[q] = offset * offset + f[v[j]];
+        }
+        std::copy(d.begin(), d.end(), f);
+    }
+}
+
+void SignedDistanceField::Bake(const std::vector<Wall>& walls, float minCellSize) {
+    values.clear();
+    dims[0] = dims[1] = dims[2] = 0;
+    if (walls.empty()) return;
+    
+    // Bounds of every box, with a margin of open samples around them
+    glm::vec3 minBound(std::numeric_limits<float>::max());
+    glm::vec3 maxBound(std::numeric_limits<float>::lowest());
+    for (const Wall& wall : walls) {
+        minBound = glm::min(minBound, wall.GetPosition() - wall.GetSize() * 0.5f);
+        maxBound = glm::max(maxBound, wall.GetPosition() + wall.GetSize() * 0.5f);
+    }
+    
+    // Coarsen the cells until the grid fits the sample budget
+    cellSize = std::max(minCellSize, 0.001f);
+    for (;;) {
+        const float margin = 2.0f * cellSize;
+        origin = minBound - glm::vec3(margin);
+        size_t total = 1;
+        for (int axis = 0; axis < 3; ++axis) {
+            const double extent = double(maxBound[axis] - minBound[axis]) + 2.0 * margin;
+            dims[axis] = static_cast<int>(std::min<double>(std::ceil(extent / cellSize), MaxSamples)) + 1;
+            total *= static_cast<size_t>(dims[axis]);
+        }
+        if (total <= MaxSamples) break;
+        cellSize *= std::cbrt(static_cast<float>(total) / MaxSamples) * 1.01f;
+    }
+    inverseCellSize = 1.0f / cellSize;
+    const size_t total = size_t(dims[0]) * dims[1] * dims[2];
+    
+    // Solid samples: any box within half a cell, so walls thinner than a
+    // cell still seal the container
+    enum : uint8_t { Open, Solid, Outside };
+    std::vector<uint8_t> kind(total, Open);
+    const float halfCell = cellSize * 0.5f;
+    for (int z = 0; z < dims[2]; ++z) {
+        for (int y = 0; y < dims[1]; ++y) {
+            for (int x = 0; x < dims[0]; ++x) {
+                const glm::vec3 p = SamplePosition(x, y, z);
+                for (const Wall& wall : walls) {
+                    const glm::vec3 q = BoxOffset(p, wall);
+                    if (q.x <= halfCell && q.y <= halfCell && q.z <= halfCell) {
+                        kind[SampleIndex(x, y, z)] = Solid;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    
+    // Flood the open space connected to the grid's edge; the margin keeps
+    // every edge sample clear of the boxes
+    std::vector<size_t> stack;
+    auto visit = [&](int x, int y, int z) {
+        const size_t index = SampleIndex(x, y, z);
+        if (kind[index] != Open) return;
+        kind[index] = Outside;
+        stack.push_back(index);
+    };
+    for (int z = 0; z < dims[2]; ++z) {
+        for (int y = 0; y < dims[1]; ++y) {
+            for (int x = 0; x < dims[0]; ++x) {
+                if (x == 0 || y == 0 || z == 0 || x == dims[0] - 1 || y == dims[1] - 1 || z == dims[2] - 1) {
+                    visit(x, y, z);
+                }
+            }
+        }
+    }
+    while (!stack.empty()) {
+        const size_t index = stack.back();
+        stack.pop_back();
+        const int x = static_cast<int>(index % dims[0]);
+        const int y = static_cast<int>(index / dims[0] % dims[1]);
+        const int z = static_cast<int>(index / (size_t(dims[0]) * dims[1]));
+        if (x > 0) visit(x - 1, y, z);
+        if (x < dims[0] - 1) visit(x + 1, y, z);
+        if (y > 0) visit(x, y - 1, z);
+        if (y < dims[1] - 1) visit(x, y + 1, z);
+        if (z > 0) visit(x, y, z - 1);
+        if (z < dims[2] - 1) visit(x, y, z + 1);
+    }
+    // Nothing enclosed: the boxes are obstacles in open space
+    outsideIsSolid = std::find(kind.begin(), kind.end(), Open) != kind.end();
+    auto isOpen = [&](size_t index) { return kind[index] == Open || (!outsideIsSolid && kind[index] == Outside); };
+    
+    // Open samples get the exact distance to the nearest box; solid ones
+    // the distance to the nearest open sample, from a separable squared
+    // distance transform in cell units
+    const float inf = std::numeric_limits<float>::infinity();
+    values.resize(total);
+    for (int z = 0; z < dims[2]; ++z) {
+        for (int y = 0; y < dims[1]; ++y) {
+            for (int x = 0; x < dims[0]; ++x) {
+                const size_t index = SampleIndex(x, y, z);
+                if (!isOpen(index)) {
+                    values[index] = inf;
+                    continue;
+                }
+                float distance = inf;
+                for (const Wall& wall : walls) {
+                    distance = std::min(distance, BoxDistance(SamplePosition(x, y, z), wall));
+                }
+                values[index] = distance;
+            }
+        }
+    }
+    
+    std::vector<float> transform(total), line, scratch, bounds;
+    std::vector<int> parabolas;
+    for (size_t index = 0; index < total; ++index) {
+        transform[index] = isOpen(index) ? 0.0f : inf;
+    }
+    const size_t strides[3] = {1, size_t(dims[0]), size_t(dims[0]) * dims[1]};
+    for (int axis = 0; axis < 3; ++axis) {
+        const int n = dims[axis];
+        line.resize(n);
+        for (size_t start = 0; start < total; ++start) {
+            // Visit each line once, from its first sample
+            if (start / strides[axis] % n != 0) continue;
+            for (int k = 0; k < n; ++k) line[k] = transform[start + k * strides[axis]];
+            DistanceTransform(line.data(), n, scratch, parabolas, bounds);
+            for (int k = 0; k < n; ++k) transform[start + k * strides[axis]] = line[k];
+        }
+    }
+    for (size_t index = 0; index < total; ++index) {
+        if (isOpen(index)) continue;
+        // The surface lies about half a cell short of the nearest open sample
+        values[index] = -std::max(std::sqrt(transform[index]) - 0.5f, 0.0f) * cellSize;
+    }
+}
+
+float SignedDistanceField::Sample(const glm::vec3& position, glm::vec3& gradient) const {
+    float distance;
+    SampleBatch(&position.x, &position.y, &position.z, 1, &distance, &gradient.x, &gradient.y, &gradient.z);
+    return distance;
+}
+
+void SignedDistanceField::SampleBatch(const float* x, const float* y, const float* z, size_t count,
+                                      float* distance, float* gradientX, float* gradientY,
+                                      float* gradientZ) const {
+    if (values.empty()) {
+        std::fill_n(distance, count, std::numeric_limits<float>::infinity());
+        std::fill_n(gradientX, count, 0.0f);
+        std::fill_n(gradientY, count, 0.0f);
+        std::fill_n(gradientZ, count, 0.0f);
+        return;
+    }
+    
+    const float* samples = values.data();
+    const int lastX = dims[0] - 1, lastY = dims[1] - 1, lastZ = dims[2] - 1;
+    const int dy = dims[0], dz = dims[0] * dims[1];
+    // Nothing but arithmetic and loads, so the loop vectorizes with the
+    // cell lookups as gathers
+    #pragma omp simd
+    for (size_t i = 0; i < count; ++i) {
+        float t[3];
+        int base[3];
+        GridCoordinate((x[i] - origin.x) * inverseCellSize, lastX, base[0], t[0]);
+        GridCoordinate((y[i] - origin.y) * inverseCellSize, lastY, base[1], t[1]);
+        GridCoordinate((z[i] - origin.z) * inverseCellSize, lastZ, base[2], t[2]);
+        
+        // Trilinear interpolation, and its derivative along each axis
+        const int index = (base[2] * dims[1] + base[1]) * dims[0] + base[0];
+        const float c000 = samples[index], c100 = samples[index + 1];
+        const float c010 = samples[index + dy], c110 = samples[index + dy + 1];
+        const float c001 = samples[index + dz], c101 = samples[index + dz + 1];
+        const float c011 = samples[index + dy + dz], c111 = samples[index + dy + dz + 1];
+        
+        const float c00 = c000 + (c100 - c000) * t[0], c10 = c010 + (c110 - c010) * t[0];
+        const float c01 = c001 + (c101 - c001) * t[0], c11 = c011 + (c111 - c011) * t[0];
+        const float c0 = c00 + (c10 - c00) * t[1], c1 = c01 + (c11 - c01) * t[1];
+        distance[i] = c0 + (c1 - c0) * t[2];
+        
+        const float dx0 = (c100 - c000) + ((c110 - c010) - (c100 - c000)) * t[1];
+        const float dx1 = (c101 - c001) + ((c111 - c011) - (c101 - c001)) * t[1];
+        gradientX[i] = (dx0 + (dx1 - dx0) * t[2]) * inverseCellSize;
+        gradientY[i] = ((c10 - c00) + ((c11 - c01) - (c10 - c00)) * t[2]) * inverseCellSize;
+        gradientZ[i] = (c1 - c0) * inverseCellSize;
+    }
+    
+    // Beyond the grid of a closed container, further from the open space
+    // by the gap and the way back is straight toward the grid; beyond
+    // obstacles, further from them. Few points get here, so this pass
+    // stays scalar.
+    const float outward = outsideIsSolid ? -1.0f : 1.0f;
+    for (size_t i = 0; i < count; ++i) {
+        const glm::vec3 grid = (glm::vec3(x[i], y[i], z[i]) - origin) * inverseCellSize;
+        const glm::vec3 clamped = glm::clamp(grid, glm::vec3(0.0f), glm::vec3(lastX, lastY, lastZ));
+        if (clamped == grid) continue;
+        const glm::vec3 gap = clamped - grid; // Back to the grid, in cells
+        const float gapLength = glm::length(gap);
+        distance[i] += outward * gapLength * cellSize;
+        const glm::vec3 gradient = gap * (-outward / gapLength);
+        gradientX[i] = gradient.x;
+        gradientY[i] = gradient.y;
+        gradientZ[i] = gradient.z;
+    }
+}
@@ -0,0 +1,78 @@
+#include "SimulationStepper.h"
+#include "LiquidSimulation.h"
+#include <algorithm>
+#include <cmath>
+
+SimulationStepper::SimulationStepper(LiquidSimulation& simulation, float fixedTimestep, int maxSubsteps)
+    : simulation(simulation)
+    , fixedTimestep(std::max(fixedTimestep, 0.0001f))
+    , maxSubsteps(std::max(maxSubsteps, 1)) {
+    SnapshotPositions();
+}
+
+int SimulationStepper::Advance(float frameTime) {
+    if (!(frameTime > 0.0f)) return 0; // Also rejects NaN
+    accumulator += frameTime;
+    
+    int steps = static_cast<int>(accumulator / fixedTimestep);
+    if (steps > maxSubsteps) {
+        // Over budget: drop whole steps, keep the fractional remainder
+        droppedTime += static_cast<double>(steps - maxSubsteps) * fixedTimestep;
+        accumulator -= static_cast<float>(steps - maxSubsteps) * fixedTimestep;
+        steps = maxSubsteps;
+    }
+    
+    for (int step = 0; step < steps; ++step) {
+        // Only the state before the last step is needed for interpolation
+        if (step == steps - 1) {
+            SnapshotPositions();
+        }
+        simulation.Update(fixedTimestep);
+        accumulator -= fixedTimestep;
+    }
+    if (steps > 0) FollowCompaction();
+    accumulator = std::clamp(accumulator, 0.0f, fixedTimestep * 0.9999f);
+    return steps;
+}
+
+glm::vec3 SimulationStepper::GetInterpolatedPosition(size_t i) const {
+    const ParticleStore& particles = simulation.GetParticleStore();
+    const glm::vec3 current = particles.GetPosition(i);
+    if (i >= previousX.size()) return current;
+    
+    const glm::vec3 previous(previousX[i], previousY[i], previousZ[i]);
+    return glm::mix(previous, current, GetAlpha());
+}
+
+void SimulationStepper::SetFixedTimestep(float dt) {
+    fixedTimestep = std::max(dt, 0.0001f);
+    accumulator = std::min(accumulator, fixedTimestep * 0.9999f);
+}
+
+void SimulationStepper::SetMaxSubsteps(int steps) {
+    maxSubsteps = std::max(steps, 1);
+}
+
+void SimulationStepper::FollowCompaction() {
+    // The snapshot is indexed as before the last step's Compact: move it
+    // the same way, and drop slots past its end so particles emitted after
+    // it fall back to their current position
+    const LiquidSimulation::CompactionLog& log = simulation.GetLastCompaction();
+    for (const LiquidSimulation::ParticleMove& move : log.moves) {
+        if (move.from >= previousX.size() || move.to >= previousX.size()) continue;
+        previousX[move.to] = previousX[move.from];
+        previousY[move.to] = previousY[move.from];
+        previousZ[move.to] = previousZ[move.from];
+    }
+    const size_t size = std::min(previousX.size(), log.size);
+    previousX.resize(size);
+    previousY.resize(size);
+    previousZ.resize(size);
+}
+
+void SimulationStepper::SnapshotPositions() {
+    const ParticleStore& particles = simulation.GetParticleStore();
+    previousX.assign(particles.x.begin(), particles.x.end());
+    previousY.assign(particles.y.begin(), particles.y.end());
+    previousZ.assign(particles.z.begin(), particles.z.end());
+}
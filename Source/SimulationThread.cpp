@@ -0,0 +1,97 @@
+#include "SimulationThread.h"
+#include "LiquidSimulation.h"
+#include "SimulationStepper.h"
+#include "Trace.h"
+#include <chrono>
+#include <utility>
+
+SimulationThread::SimulationThread(SimulationStepper& stepper)
+    : stepper(stepper) {
+}
+
+SimulationThread::~SimulationThread() {
+    Stop();
+}
+
+void SimulationThread::Start() {
+    if (thread.joinable()) return;
+    stopping = false;
+    Publish(); // Something to draw before the first step
+    thread = std::thread(&SimulationThread::Run, this);
+}
+
+void SimulationThread::Stop() {
+    if (!thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+void SimulationThread::RethrowIfFailed() {
+    std::exception_ptr failure;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        failure = std::exchange(error, nullptr);
+    }
+    if (failure) std::rethrow_exception(failure);
+}
+
+const TrajectoryFrame& SimulationThread::AcquireFrame() {
+    frames.Acquire();
+    return frames.GetFront();
+}
+
+void SimulationThread::Run() {
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point last = Clock::now();
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        lock.unlock();
+        try {
+            const Clock::time_point now = Clock::now();
+            const float elapsed = std::chrono::duration<float>(now - last).count();
+            last = now;
+            
+            const int steps = stepper.Advance(elapsed);
+            if (steps > 0) {
+                if (onSteps) onSteps(stepper.GetSimulation(), steps);
+                Publish();
+            }
+        } catch (...) {
+            lock.lock();
+            error = std::current_exception();
+            break;
+        }
+        
+        // Sleep until the next step is due, or until Stop
+        const float untilStep = (1.0f - stepper.GetAlpha()) * stepper.GetFixedTimestep();
+        lock.lock();
+        wake.wait_for(lock, std::chrono::duration<float>(untilStep), [this] { return stopping; });
+    }
+}
+
+void SimulationThread::Publish() {
+    TRACE_SCOPE("SimulationThread::Publish");
+    const LiquidSimulation& simulation = stepper.GetSimulation();
+    const ParticleStore& particles = simulation.GetParticleStore();
+    const size_t count = particles.Size();
+    
+    TrajectoryFrame& frame = frames.GetBack();
+    frame.sequence = published.load(std::memory_order_relaxed);
+    frame.time = simulation.GetTime();
+    frame.Resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        const glm::vec3 position = stepper.GetInterpolatedPosition(i);
+        frame.x[i] = position.x;
+        frame.y[i] = position.y;
+        frame.z[i] = position.z;
+    }
+    frame.color.assign(particles.color.begin(), particles.color.end());
+    frame.radius.assign(particles.radius.begin(), particles.radius.end());
+    
+    frames.Publish();
+    published.fetch_add(1, std::memory_order_relaxed);
+}
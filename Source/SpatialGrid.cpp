@@ -0,0 +1,32 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+#include <cmath>
+
+void SpatialGrid::ComputeLayout(const glm::vec3& minBound, const glm::vec3& maxBound, float minCellSize) {
+    cellSize = std::max(minCellSize, 0.001f);
+    origin = minBound;
+    
+    glm::vec3 extent = maxBound - minBound;
+    for (int axis = 0; axis < 3; ++axis) {
+        // Runaway particles must not blow up the cell array
+        if (!std::isfinite(extent[axis]) || !std::isfinite(origin[axis])) {
+            origin[axis] = 0.0f;
+            extent[axis] = 0.0f;
+        }
+    }
+    
+    // Coarsen the cells until the grid fits the cell budget
+    for (;;) {
+        size_t total = 1;
+        for (int axis = 0; axis < 3; ++axis) {
+            double cells = std::min<double>(extent[axis] / cellSize, MaxCells) + 1.0;
+            dims[axis] = static_cast<int>(cells);
+            total *= static_cast<size_t>(dims[axis]);
+        }
+        if (total <= MaxCells) {
+            cellStart.assign(total + 1, 0u);
+            return;
+        }
+        cellSize *= std::cbrt(static_cast<float>(total) / MaxCells) * 1.01f;
+    }
+}
@@ -0,0 +1,187 @@
+#include "TaskGraph.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstring>
+#include <omp.h>
+
+TaskGraph::Task TaskGraph::Add(const char* name, std::function<void()> body, std::initializer_list<Task> after) {
+    return AddNode(name, 1, [body = std::move(body)](size_t) { body(); }, false, after, {});
+}
+
+TaskGraph::Task TaskGraph::AddChunked(const char* name, size_t chunkCount, std::function<void(size_t)> body,
+                                      std::initializer_list<Task> after, std::initializer_list<Task> alongside) {
+    return AddNode(name, chunkCount, std::move(body), false, after, alongside);
+}
+
+TaskGraph::Task TaskGraph::AddExclusive(const char* name, std::function<void()> body) {
+    return AddNode(name, 1, [body = std::move(body)](size_t) { body(); }, true, {}, {});
+}
+
+TaskGraph::Task TaskGraph::AddNode(const char* name, size_t chunkCount, std::function<void(size_t)> body,
+                                   bool exclusive, std::initializer_list<Task> after,
+                                   std::initializer_list<Task> alongside) {
+    const Task task = tasks.size();
+    Node& node = tasks.emplace_back();
+    node.name = name;
+    node.body = std::move(body);
+    node.chunkCount = chunkCount;
+    node.exclusive = exclusive;
+    for (Task other : after) {
+        if (other < task) node.after.push_back(other);
+    }
+    for (Task other : alongside) {
+        if (other >= task) continue;
+        // Chunk k only lines up with chunk k when both split the same way
+        if (tasks[other].chunkCount == chunkCount) {
+            node.alongside.push_back(other);
+        } else {
+            node.after.push_back(other);
+        }
+    }
+    return task;
+}
+
+void TaskGraph::Clear() {
+    tasks.clear();
+}
+
+TaskGraph::Task TaskGraph::Find(const char* name) const {
+    for (Task task = 0; task < tasks.size(); ++task) {
+        if (std::strcmp(tasks[task].name, name) == 0) return task;
+    }
+    return tasks.size();
+}
+
+bool TaskGraph::IsOrderedAfter(Task task, Task other) const {
+    if (task >= tasks.size() || other >= task) return false;
+    for (Task between = other; between < task; ++between) {
+        if (tasks[between].exclusive) return true;
+    }
+
+    // Alongside edges only wait for matching chunks, so they order whole
+    // tasks only when both have a single chunk
+    std::vector<Task> stack = {task};
+    std::vector<bool> seen(task + 1, false);
+    while (!stack.empty()) {
+        const Node& node = tasks[stack.back()];
+        stack.pop_back();
+        for (Task dependency : node.after) {
+            if (dependency == other) return true;
+            if (!seen[dependency]) {
+                seen[dependency] = true;
+                stack.push_back(dependency);
+            }
+        }
+        for (Task dependency : node.alongside) {
+            if (dependency == other && GetItemCount(other) == 1) return true;
+            if (!seen[dependency]) {
+                seen[dependency] = true;
+                stack.push_back(dependency);
+            }
+        }
+    }
+    return false;
+}
+
+void TaskGraph::Run(int threadCount) {
+    if (threadCount <= 0) threadCount = omp_get_max_threads();
+
+    // Counters for every chunk of every task, reused across runs
+    size_t items = 0;
+    for (Task task = 0; task < tasks.size(); ++task) {
+        tasks[task].firstItem = items;
+        items += GetItemCount(task);
+    }
+    if (items > pendingCapacity) {
+        pending = std::make_unique<std::atomic<uint32_t>[]>(items);
+        pendingCapacity = items;
+    }
+    if (tasks.size() > chunksLeftCapacity) {
+        chunksLeft = std::make_unique<std::atomic<uint32_t>[]>(tasks.size());
+        chunksLeftCapacity = tasks.size();
+    }
+
+    // Exclusive tasks split the graph into stages that run one by one
+    Task stageBegin = 0;
+    for (Task task = 0; task < tasks.size(); ++task) {
+        if (!tasks[task].exclusive) continue;
+        RunStage(stageBegin, task, threadCount);
+        {
+            TRACE_SCOPE(tasks[task].name);
+            tasks[task].body(0);
+        }
+        stageBegin = task + 1;
+    }
+    RunStage(stageBegin, tasks.size(), threadCount);
+}
+
+void TaskGraph::RunStage(Task begin, Task end, int threadCount) {
+    if (begin >= end) return;
+
+    // Link each task to the ones waiting on it within the stage; earlier
+    // stages are already done
+    for (Task task = begin; task < end; ++task) {
+        tasks[task].successors.clear();
+        tasks[task].chunkSuccessors.clear();
+    }
+    roots.clear();
+    for (Task task = begin; task < end; ++task) {
+        Node& node = tasks[task];
+        uint32_t waits = 0;
+        for (Task other : node.after) {
+            if (other < begin) continue;
+            tasks[other].successors.push_back(task);
+            ++waits;
+        }
+        for (Task other : node.alongside) {
+            if (other < begin) continue;
+            tasks[other].chunkSuccessors.push_back(task);
+            ++waits;
+        }
+        for (size_t item = 0; item < GetItemCount(task); ++item) {
+            pending[node.firstItem + item].store(waits, std::memory_order_relaxed);
+        }
+        chunksLeft[task].store(static_cast<uint32_t>(GetItemCount(task)), std::memory_order_relaxed);
+        if (waits == 0) roots.push_back(task);
+    }
+
+    // The roots spawn their successors as they finish; the region's
+    // closing barrier waits for all of them
+    #pragma omp parallel num_threads(threadCount)
+    #pragma omp single
+    {
+        for (Task task : roots) {
+            for (size_t item = 0; item < GetItemCount(task); ++item) {
+                Spawn(task, item);
+            }
+        }
+    }
+}
+
+void TaskGraph::Spawn(Task task, size_t chunk) {
+    #pragma omp task firstprivate(task, chunk)
+    Execute(task, chunk);
+}
+
+void TaskGraph::Execute(Task task, size_t chunk) {
+    const Node& node = tasks[task];
+    if (node.chunkCount > 0) {
+        TRACE_SCOPE(node.name);
+        node.body(chunk);
+    }
+
+    // acq_rel: whoever releases a successor has seen every write it waits on
+    for (Task next : node.chunkSuccessors) {
+        if (pending[tasks[next].firstItem + chunk].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            Spawn(next, chunk);
+        }
+    }
+    if (chunksLeft[task].fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+    for (Task next : node.successors) {
+        for (size_t item = 0; item < GetItemCount(next); ++item) {
+            if (pending[tasks[next].firstItem + item].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                Spawn(next, item);
+            }
+        }
+    }
+}
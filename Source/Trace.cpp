@@ -0,0 +1,106 @@
+#include "Trace.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <set>
+
+namespace Trace {
+
+Recorder::Recorder(size_t capacity)
+    : slots(std::bit_ceil(std::max<size_t>(capacity, 1)))
+    , epoch(std::chrono::steady_clock::now()) {
+}
+
+Recorder& Recorder::Global() {
+    static Recorder recorder;
+    return recorder;
+}
+
+void Recorder::Record(const char* name, std::chrono::steady_clock::time_point start,
+                      std::chrono::steady_clock::time_point end) {
+    // Claim a ticket; once full, the oldest event is overwritten
+    const uint64_t ticket = next.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots[ticket & (slots.size() - 1)];
+    slot.sequence.store(2 * ticket + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.thread.store(CurrentThreadId(), std::memory_order_relaxed);
+    slot.startNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(start - epoch).count(),
+                       std::memory_order_relaxed);
+    slot.durationNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(),
+                          std::memory_order_relaxed);
+    slot.sequence.store(2 * ticket + 2, std::memory_order_release);
+}
+
+std::vector<Event> Recorder::Snapshot() const {
+    const uint64_t recorded = next.load(std::memory_order_acquire);
+    const uint64_t first = std::max(cleared.load(std::memory_order_acquire),
+                                    recorded - std::min<uint64_t>(recorded, slots.size()));
+    
+    std::vector<Event> result;
+    result.reserve(recorded - first);
+    for (uint64_t ticket = first; ticket < recorded; ++ticket) {
+        // Keep the copy only if the slot held this finished event
+        // throughout; a ticket is only reused once the ring wraps
+        const Slot& slot = slots[ticket & (slots.size() - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != 2 * ticket + 2) continue;
+        Event event;
+        event.name = slot.name.load(std::memory_order_relaxed);
+        event.thread = slot.thread.load(std::memory_order_relaxed);
+        event.startNs = slot.startNs.load(std::memory_order_relaxed);
+        event.durationNs = slot.durationNs.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != 2 * ticket + 2) continue;
+        result.push_back(event);
+    }
+    return result;
+}
+
+void Recorder::Clear() {
+    // Tickets keep counting, so no slot's sequence matches a new ticket
+    // by accident
+    cleared.store(next.load(std::memory_order_relaxed), std::memory_order_release);
+}
+
+bool Recorder::WriteChromeTrace(const std::string& path) const {
+    const std::vector<Event> snapshot = Snapshot();
+    
+    // Complete ("X") events in microseconds, one track per thread
+    nlohmann::json traceEvents = nlohmann::json::array();
+    std::set<uint32_t> threads;
+    for (const Event& event : snapshot) {
+        traceEvents.push_back({
+            {"name", event.name},
+            {"cat", "CppLiquid"},
+            {"ph", "X"},
+            {"ts", event.startNs / 1000.0},
+            {"dur", event.durationNs / 1000.0},
+            {"pid", 1},
+            {"tid", event.thread}
+        });
+        threads.insert(event.thread);
+    }
+    for (uint32_t thread : threads) {
+        traceEvents.push_back({
+            {"name", "thread_name"},
+            {"ph", "M"},
+            {"pid", 1},
+            {"tid", thread},
+            {"args", {{"name", "Thread " + std::to_string(thread)}}}
+        });
+    }
+    
+    std::ofstream file(path);
+    if (!file.is_open()) return false;
+    file << nlohmann::json{{"traceEvents", traceEvents}, {"displayTimeUnit", "ms"}}.dump();
+    return static_cast<bool>(file);
+}
+
+uint32_t CurrentThreadId() {
+    static std::atomic<uint32_t> nextId{0};
+    thread_local const uint32_t id = nextId.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+} // namespace Trace
@@ -0,0 +1,189 @@
+#include "Trajectory.h"
+#include "ParticleStore.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+void TrajectoryFrame::Resize(size_t count) {
+    x.resize(count);
+    y.resize(count);
+    z.resize(count);
+    color.resize(count);
+    radius.resize(count);
+}
+
+void TrajectoryFrame::CopyFrom(const ParticleStore& particles) {
+    x.assign(particles.x.begin(), particles.x.end());
+    y.assign(particles.y.begin(), particles.y.end());
+    z.assign(particles.z.begin(), particles.z.end());
+    color.assign(particles.color.begin(), particles.color.end());
+    radius.assign(particles.radius.begin(), particles.radius.end());
+}
+
+namespace Trajectory {
+
+namespace {
+    template <typename T>
+    void Append(std::vector<uint8_t>& out, const T* values, size_t count) {
+        const size_t start = out.size();
+        out.resize(start + count * sizeof(T));
+        if (count) std::memcpy(out.data() + start, values, count * sizeof(T));
+    }
+    
+    // Zigzag + LEB128: small changes of either sign take one or two bytes
+    void AppendVarint(std::vector<uint8_t>& out, int64_t value) {
+        uint64_t bits = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+        while (bits >= 0x80) {
+            out.push_back(static_cast<uint8_t>(bits) | 0x80);
+            bits >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(bits));
+    }
+    
+    // Bounds-checked payload cursor; every read fails once one has
+    struct Reader {
+        const uint8_t* data;
+        size_t bytes;
+        size_t offset = 0;
+        bool ok = true;
+        
+        template <typename T>
+        void Read(T* values, size_t count) {
+            const size_t size = count * sizeof(T);
+            if (!ok || bytes - offset < size) {
+                ok = false;
+                return;
+            }
+            if (size) std::memcpy(values, data + offset, size);
+            offset += size;
+        }
+        
+        int64_t ReadVarint() {
+            uint64_t bits = 0;
+            for (int shift = 0; ok && shift < 64; shift += 7) {
+                if (offset >= bytes) break;
+                const uint8_t byte = data[offset++];
+                bits |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) {
+                    return static_cast<int64_t>(bits >> 1) ^ -static_cast<int64_t>(bits & 1);
+                }
+            }
+            ok = false;
+            return 0;
+        }
+    };
+    
+    int32_t Quantize(float value, float step) {
+        const double q = std::round(static_cast<double>(value) / step);
+        return static_cast<int32_t>(std::clamp(q, double(std::numeric_limits<int32_t>::min()),
+                                               double(std::numeric_limits<int32_t>::max())));
+    }
+}
+
+Codec::Codec(uint32_t fileFlags, float positionStep)
+    : fileFlags(fileFlags & Delta ? fileFlags | Quantized : fileFlags)
+    , positionStep(positionStep > 0.0f ? positionStep : 0.001f) {
+}
+
+uint32_t Codec::Encode(const TrajectoryFrame& frame, bool keyframe, std::vector<uint8_t>& out) {
+    const size_t count = frame.Size();
+    if (!(fileFlags & Quantized)) {
+        Append(out, frame.x.data(), count);
+        Append(out, frame.y.data(), count);
+        Append(out, frame.z.data(), count);
+        Append(out, &frame.color.data()->x, count * 3);
+        Append(out, frame.radius.data(), count);
+        return Keyframe;
+    }
+    
+    // A delta needs a base with the same particles
+    keyframe = keyframe || !(fileFlags & Delta) || qx.size() != count;
+    const std::vector<float>* axes[3] = {&frame.x, &frame.y, &frame.z};
+    std::vector<int32_t>* quantized[3] = {&qx, &qy, &qz};
+    for (int axis = 0; axis < 3; ++axis) {
+        const std::vector<float>& values = *axes[axis];
+        std::vector<int32_t>& last = *quantized[axis];
+        if (keyframe) {
+            last.resize(count);
+            for (size_t i = 0; i < count; ++i) {
+                last[i] = Quantize(values[i], positionStep);
+            }
+            Append(out, last.data(), count);
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                const int32_t q = Quantize(values[i], positionStep);
+                AppendVarint(out, int64_t(q) - last[i]);
+                last[i] = q;
+            }
+        }
+    }
+    
+    const size_t colorStart = out.size();
+    out.resize(colorStart + count * 3);
+    uint8_t* rgb = out.data() + colorStart;
+    for (size_t i = 0; i < count; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            rgb[i * 3 + c] = static_cast<uint8_t>(std::lround(std::clamp(frame.color[i][c], 0.0f, 1.0f) * 255.0f));
+        }
+    }
+    
+    std::vector<uint16_t> radii(count);
+    for (size_t i = 0; i < count; ++i) {
+        radii[i] = static_cast<uint16_t>(std::min(std::lround(std::max(frame.radius[i], 0.0f) / RadiusStep), 65535l));
+    }
+    Append(out, radii.data(), count);
+    return keyframe ? uint32_t(Keyframe) : 0u;
+}
+
+bool Codec::Decode(const uint8_t* payload, size_t bytes, uint32_t frameFlags, size_t particleCount,
+                   TrajectoryFrame& out) {
+    const size_t count = particleCount;
+    if (count > bytes) return false; // Every encoding spends over a byte per particle
+    Reader reader{payload, bytes};
+    out.Resize(count);
+    if (!(fileFlags & Quantized)) {
+        reader.Read(out.x.data(), count);
+        reader.Read(out.y.data(), count);
+        reader.Read(out.z.data(), count);
+        reader.Read(&out.color.data()->x, count * 3);
+        reader.Read(out.radius.data(), count);
+        return reader.ok && reader.offset == bytes;
+    }
+    
+    const bool keyframe = frameFlags & Keyframe;
+    if (!keyframe && qx.size() != count) return false;
+    std::vector<float>* axes[3] = {&out.x, &out.y, &out.z};
+    std::vector<int32_t>* quantized[3] = {&qx, &qy, &qz};
+    for (int axis = 0; axis < 3; ++axis) {
+        std::vector<int32_t>& last = *quantized[axis];
+        if (keyframe) {
+            last.resize(count);
+            reader.Read(last.data(), count);
+        } else {
+            for (size_t i = 0; i < count && reader.ok; ++i) {
+                last[i] = static_cast<int32_t>(last[i] + reader.ReadVarint());
+            }
+        }
+        std::vector<float>& values = *axes[axis];
+        for (size_t i = 0; i < count; ++i) {
+            values[i] = static_cast<float>(last[i]) * positionStep;
+        }
+    }
+    
+    std::vector<uint8_t> rgb(count * 3);
+    std::vector<uint16_t> radii(count);
+    reader.Read(rgb.data(), rgb.size());
+    reader.Read(radii.data(), count);
+    if (!reader.ok || reader.offset != bytes) {
+        qx.clear(); // The delta base is now unreliable
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        out.color[i] = glm::vec3(rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2]) / 255.0f;
+        out.radius[i] = radii[i] * RadiusStep;
+    }
+    return true;
+}
+
+} // namespace Trajectory
@@ -0,0 +1,81 @@
+#include "TrajectoryPlayer.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+TrajectoryPlayer::TrajectoryPlayer(const std::string& path, size_t readAhead)
+    : reader(path)
+    , readAhead(std::max<size_t>(readAhead, 1)) {
+    if (reader.GetFrameCount() == 0) throw std::runtime_error("Trajectory has no frames: " + path);
+    clock = GetStartTime();
+    Show(0);
+}
+
+bool TrajectoryPlayer::Advance(double frameTime) {
+    if (paused) return false;
+    clock += frameTime * speed;
+    
+    const double start = GetStartTime();
+    const double end = GetEndTime();
+    const size_t count = GetFrameCount();
+    if (looping && count > 1 && end > start) {
+        // One period holds every frame, the last one included, for a
+        // recorded frame interval each
+        const double period = (end - start) * count / (count - 1);
+        clock = start + std::fmod(clock - start, period);
+        if (clock < start) clock += period;
+    } else {
+        clock = std::clamp(clock, start, end);
+    }
+    
+    const size_t next = FindFrame(clock);
+    if (next == current) return false;
+    Show(next);
+    return true;
+}
+
+void TrajectoryPlayer::Seek(double time) {
+    clock = std::clamp(time, GetStartTime(), GetEndTime());
+    const size_t next = FindFrame(clock);
+    if (next != current) Show(next);
+}
+
+void TrajectoryPlayer::SeekFrame(size_t index) {
+    index = std::min(index, GetFrameCount() - 1);
+    clock = reader.GetEntry(index).time;
+    if (index != current) Show(index);
+}
+
+size_t TrajectoryPlayer::FindFrame(double time) const {
+    // Frame times only grow, so binary search for the first one past `time`
+    size_t low = 0, high = GetFrameCount();
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (reader.GetEntry(mid).time <= time) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low > 0 ? low - 1 : 0;
+}
+
+void TrajectoryPlayer::Show(size_t index) {
+    TRACE_SCOPE("TrajectoryPlayer::Show");
+    reader.ReadFrame(index, frame);
+    current = index;
+    
+    // Keep the frames ahead, in the direction of play, hinted. The hint
+    // covers two windows so it's reissued once every readAhead frames
+    // rather than every frame.
+    const size_t count = GetFrameCount();
+    const bool backward = speed < 0.0;
+    const size_t first = backward ? index - std::min(index, readAhead) : index + 1;
+    const size_t end = std::min(first + readAhead, count);
+    if (first >= end || (first >= prefetchedFirst && end <= prefetchedEnd)) return;
+    
+    prefetchedFirst = backward ? index - std::min(index, 2 * readAhead) : first;
+    prefetchedEnd = backward ? index : std::min(first + 2 * readAhead, count);
+    reader.Prefetch(prefetchedFirst, prefetchedEnd - prefetchedFirst);
+}
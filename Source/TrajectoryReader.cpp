@@ -0,0 +1,94 @@
+#include "TrajectoryReader.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    Trajectory::FileHeader ReadHeader(const MappedFile& file, const std::string& path) {
+        Trajectory::FileHeader header;
+        if (file.GetSize() < sizeof(header)) throw std::runtime_error("Not a trajectory: " + path);
+        std::memcpy(&header, file.GetData(), sizeof(header));
+        if (std::memcmp(header.magic, Trajectory::Magic, sizeof(header.magic)) != 0) {
+            throw std::runtime_error("Not a trajectory: " + path);
+        }
+        if (header.endianTag != Trajectory::EndianTag) {
+            throw std::runtime_error("Trajectory written with a different byte order: " + path);
+        }
+        if (header.version != Trajectory::Version) {
+            throw std::runtime_error("Unsupported trajectory version " + std::to_string(header.version));
+        }
+        return header;
+    }
+}
+
+TrajectoryReader::TrajectoryReader(const std::string& path)
+    : file(path)
+    , header(ReadHeader(file, path))
+    , codec(header.flags, header.positionStep) {
+    const uint64_t size = file.GetSize();
+    const uint64_t indexBytes = header.frameCount * sizeof(Trajectory::IndexEntry);
+    if (header.indexOffset == 0 || header.indexOffset > size || indexBytes > size - header.indexOffset) {
+        RebuildIndex();
+        return;
+    }
+    index.resize(header.frameCount);
+    if (indexBytes) std::memcpy(index.data(), file.GetData() + header.indexOffset, indexBytes);
+}
+
+void TrajectoryReader::RebuildIndex() {
+    recovered = true;
+    const uint64_t size = file.GetSize();
+    uint64_t offset = sizeof(Trajectory::FileHeader);
+    while (size - offset >= sizeof(Trajectory::FrameHeader)) {
+        Trajectory::FrameHeader frame;
+        std::memcpy(&frame, file.GetData() + offset, sizeof(frame));
+        if (frame.magic != Trajectory::FrameMagic ||
+            frame.payloadBytes > size - offset - sizeof(frame)) {
+            break; // Torn write at the end of an unclosed file
+        }
+        index.push_back({offset, frame.time, frame.particleCount, frame.flags});
+        offset += sizeof(frame) + frame.payloadBytes;
+    }
+}
+
+void TrajectoryReader::ReadFrame(size_t frame, TrajectoryFrame& out) {
+    if (frame >= index.size()) throw std::out_of_range("Trajectory frame out of range");
+    
+    // Deltas build on the previous frame: continue from the last decode
+    // when possible, otherwise replay from the nearest keyframe
+    size_t start = frame;
+    while (start > 0 && !(index[start].flags & Trajectory::Keyframe) && start - 1 != lastDecoded) {
+        --start;
+    }
+    for (size_t f = start; f <= frame; ++f) {
+        DecodeFrame(f, out);
+    }
+}
+
+void TrajectoryReader::DecodeFrame(size_t frame, TrajectoryFrame& out) {
+    const Trajectory::IndexEntry& entry = index[frame];
+    const uint64_t size = file.GetSize();
+    Trajectory::FrameHeader frameHeader;
+    if (entry.offset > size || size - entry.offset < sizeof(frameHeader)) {
+        throw std::runtime_error("Corrupt trajectory frame " + std::to_string(frame));
+    }
+    std::memcpy(&frameHeader, file.GetData() + entry.offset, sizeof(frameHeader));
+    const uint64_t payloadOffset = entry.offset + sizeof(frameHeader);
+    if (frameHeader.magic != Trajectory::FrameMagic || frameHeader.payloadBytes > size - payloadOffset ||
+        !codec.Decode(file.GetData() + payloadOffset, frameHeader.payloadBytes, frameHeader.flags,
+                      frameHeader.particleCount, out)) {
+        lastDecoded = SIZE_MAX;
+        throw std::runtime_error("Corrupt trajectory frame " + std::to_string(frame));
+    }
+    out.sequence = frameHeader.sequence;
+    out.time = frameHeader.time;
+    lastDecoded = frame;
+}
+
+void TrajectoryReader::Prefetch(size_t first, size_t count) const {
+    if (first >= index.size() || count == 0) return;
+    const size_t last = std::min(first + count, index.size()) - 1;
+    const uint64_t end = last + 1 < index.size() ? index[last + 1].offset : file.GetSize();
+    file.Prefetch(index[first].offset, end - index[first].offset);
+}
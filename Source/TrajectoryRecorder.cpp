@@ -0,0 +1,170 @@
+#include "TrajectoryRecorder.h"
+#include "ParticleStore.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    uint32_t FileFlags(const TrajectoryRecorder::Options& options) {
+        uint32_t flags = 0;
+        if (options.quantize || options.delta) flags |= Trajectory::Quantized;
+        if (options.delta) flags |= Trajectory::Delta;
+        return flags;
+    }
+}
+
+TrajectoryRecorder::TrajectoryRecorder(const std::string& path, const Options& options)
+    : file(path, std::ios::binary | std::ios::trunc)
+    , codec(FileFlags(options), options.positionStep)
+    , keyframeInterval(std::max(options.keyframeInterval, 1))
+    , buffers(std::max(options.bufferCount, 1)) {
+    if (!file.is_open()) throw std::runtime_error("Cannot create trajectory " + path);
+    
+    std::memcpy(header.magic, Trajectory::Magic, sizeof(header.magic));
+    header.version = Trajectory::Version;
+    header.endianTag = Trajectory::EndianTag;
+    header.flags = FileFlags(options);
+    header.positionStep = options.positionStep > 0.0f ? options.positionStep : 0.001f;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    bytesWritten = sizeof(header);
+    
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        freeBuffers.push_back(i);
+    }
+    writer = std::thread(&TrajectoryRecorder::WriterLoop, this);
+}
+
+TrajectoryRecorder::~TrajectoryRecorder() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    frameQueued.notify_one();
+    writer.join();
+    Close();
+}
+
+bool TrajectoryRecorder::Capture(const ParticleStore& particles, double time) {
+    TRACE_SCOPE("TrajectoryRecorder::Capture");
+    size_t buffer;
+    uint64_t sequence;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        sequence = captured++;
+        if (failed || freeBuffers.empty()) {
+            ++dropped;
+            return false;
+        }
+        buffer = freeBuffers.back();
+        freeBuffers.pop_back();
+    }
+    
+    // The copy happens outside the lock; this buffer is ours until queued
+    TrajectoryFrame& frame = buffers[buffer];
+    frame.sequence = sequence;
+    frame.time = time;
+    frame.CopyFrom(particles);
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingBuffers.push_back(buffer);
+    }
+    frameQueued.notify_one();
+    return true;
+}
+
+void TrajectoryRecorder::Flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    frameWritten.wait(lock, [this] { return pendingBuffers.empty() && !writing; });
+}
+
+void TrajectoryRecorder::WriterLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        frameQueued.wait(lock, [this] { return stopping || !pendingBuffers.empty(); });
+        if (pendingBuffers.empty()) return; // Stopping with nothing left
+        
+        const size_t buffer = pendingBuffers.front();
+        pendingBuffers.pop_front();
+        writing = true;
+        lock.unlock();
+        
+        WriteFrame(buffers[buffer]);
+        
+        lock.lock();
+        writing = false;
+        freeBuffers.push_back(buffer);
+        frameWritten.notify_all();
+    }
+}
+
+void TrajectoryRecorder::WriteFrame(const TrajectoryFrame& frame) {
+    TRACE_SCOPE("TrajectoryRecorder::Write");
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (failed) return;
+    }
+    
+    const bool keyframe = index.size() % keyframeInterval == 0;
+    payload.clear();
+    Trajectory::FrameHeader frameHeader{};
+    frameHeader.magic = Trajectory::FrameMagic;
+    frameHeader.flags = codec.Encode(frame, keyframe, payload);
+    frameHeader.sequence = frame.sequence;
+    frameHeader.time = frame.time;
+    frameHeader.particleCount = static_cast<uint32_t>(frame.Size());
+    frameHeader.payloadBytes = payload.size();
+    
+    const uint64_t offset = static_cast<uint64_t>(file.tellp());
+    file.write(reinterpret_cast<const char*>(&frameHeader), sizeof(frameHeader));
+    file.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file) {
+        failed = true;
+        return;
+    }
+    index.push_back({offset, frame.time, frameHeader.particleCount, frameHeader.flags});
+    ++written;
+    bytesWritten += sizeof(frameHeader) + payload.size();
+}
+
+void TrajectoryRecorder::Close() {
+    if (failed) return; // Leave indexOffset 0; readers rebuild the index
+    
+    // Append the index, then point the header at it
+    header.indexOffset = static_cast<uint64_t>(file.tellp());
+    header.frameCount = index.size();
+    file.write(reinterpret_cast<const char*>(index.data()),
+               static_cast<std::streamsize>(index.size() * sizeof(Trajectory::IndexEntry)));
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.close();
+    bytesWritten += index.size() * sizeof(Trajectory::IndexEntry);
+}
+
+uint64_t TrajectoryRecorder::GetCapturedCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return captured;
+}
+
+uint64_t TrajectoryRecorder::GetDroppedCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return dropped;
+}
+
+uint64_t TrajectoryRecorder::GetWrittenCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return written;
+}
+
+uint64_t TrajectoryRecorder::GetBytesWritten() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return bytesWritten;
+}
+
+bool TrajectoryRecorder::HasFailed() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return failed;
+}
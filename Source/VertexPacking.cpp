@@ -0,0 +1,38 @@
+#include "VertexPacking.h"
+#include "ParticleStore.h"
+#include "SimulationStepper.h"
+#include "Trajectory.h"
+
+void PackLiquidVertices(const ParticleStore& particles, const SimulationStepper* stepper,
+                        std::vector<float>& vertices) {
+    const size_t count = particles.Size();
+    vertices.resize(count * LiquidVertexFloats);
+    
+    float* out = vertices.data();
+    for (size_t i = 0; i < count; ++i, out += LiquidVertexFloats) {
+        glm::vec3 position = stepper ? stepper->GetInterpolatedPosition(i) : particles.GetPosition(i);
+        out[0] = position.x;
+        out[1] = position.y;
+        out[2] = position.z;
+        out[3] = particles.color[i].r;
+        out[4] = particles.color[i].g;
+        out[5] = particles.color[i].b;
+        out[6] = particles.radius[i] * 40.0f;  // Scaled for better visibility
+    }
+}
+
+void PackLiquidVertices(const TrajectoryFrame& frame, std::vector<float>& vertices) {
+    const size_t count = frame.Size();
+    vertices.resize(count * LiquidVertexFloats);
+    
+    float* out = vertices.data();
+    for (size_t i = 0; i < count; ++i, out += LiquidVertexFloats) {
+        out[0] = frame.x[i];
+        out[1] = frame.y[i];
+        out[2] = frame.z[i];
+        out[3] = frame.color[i].r;
+        out[4] = frame.color[i].g;
+        out[5] = frame.color[i].b;
+        out[6] = frame.radius[i] * 40.0f;  // Same scale as live particles
+    }
+}
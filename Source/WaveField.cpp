@@ -0,0 +1,183 @@
+#include "WaveField.h"
+#include <algorithm>
+#include <cmath>
+
+void WaveField::Configure(const glm::vec3& minBound, const glm::vec3& maxBound, size_t channels, const Params& values) {
+    params = values;
+    params.cellSize = std::max(params.cellSize, 0.01f);
+    // Centered on the bounds, so the outer cells overhang both sides evenly
+    const glm::vec3 center = (minBound + maxBound) * 0.5f;
+    for (int axis = 0; axis < 3; ++axis) {
+        const float extent = std::max(maxBound[axis] - minBound[axis], 0.0f);
+        dims[axis] = std::max(static_cast<int>(std::ceil(extent / params.cellSize)), 1);
+        origin[axis] = center[axis] - (dims[axis] - 1) * params.cellSize * 0.5f;
+    }
+    channelCount = channels;
+    Clear();
+}
+
+void WaveField::Clear() {
+    phasors.assign(channelCount * GetCellCount(), glm::vec2(0.0f));
+    quiet = true;
+}
+
+glm::vec3 WaveField::ToGrid(const glm::vec3& position) const {
+    glm::vec3 grid = (position - origin) / params.cellSize;
+    for (int axis = 0; axis < 3; ++axis) {
+        grid[axis] = std::clamp(grid[axis], 0.0f, static_cast<float>(dims[axis] - 1));
+    }
+    return grid;
+}
+
+void WaveField::Inject(size_t channel, const glm::vec3& position, float amplitude, float phase) {
+    if (channel >= channelCount || !(amplitude >= MinAmplitude)) return;
+    const glm::vec3 grid = ToGrid(position);
+    const size_t cell = CellIndex(static_cast<int>(std::lround(grid.x)), static_cast<int>(std::lround(grid.y)),
+                                  static_cast<int>(std::lround(grid.z)));
+    glm::vec2& phasor = phasors[channel * GetCellCount() + cell];
+    if (amplitude * amplitude > phasor.x * phasor.x + phasor.y * phasor.y) {
+        phasor = glm::vec2(amplitude * std::cos(phase), amplitude * std::sin(phase));
+        quiet = false;
+    }
+}
+
+void WaveField::Step(float deltaTime, int threadCount) {
+    const int substeps = BeginStep(deltaTime);
+    for (int substep = 0; substep < substeps; ++substep) {
+        #pragma omp parallel for schedule(static) num_threads(threadCount)
+        for (int z = 0; z < dims[2]; ++z) {
+            StepSlabs(substep, z, z + 1);
+        }
+    }
+    EndStep();
+}
+
+int WaveField::GetSubstepCount(float deltaTime) const {
+    // Explicit diffusion is stable up to 1/6 per substep in 3D
+    const float spread = params.spreadRate * deltaTime / (params.cellSize * params.cellSize);
+    return std::clamp(static_cast<int>(std::ceil(spread * 6.0f)), 1, 16);
+}
+
+int WaveField::BeginStep(float deltaTime) {
+    stepping.substeps = 0;
+    if (quiet || !(deltaTime > 0.0f)) return 0;
+    
+    const int substeps = GetSubstepCount(deltaTime);
+    const float spread = params.spreadRate * deltaTime / (params.cellSize * params.cellSize);
+    stepping.alpha = std::min(spread / substeps, 1.0f / 6.0f);
+    const float decay = std::exp(-params.decayRate * deltaTime / substeps);
+    // Waves arriving from a neighbor are one cell further from their source
+    const float lag = -params.phaseLag * params.cellSize;
+    stepping.rotateCos = std::cos(lag);
+    stepping.rotateSin = std::sin(lag);
+    // Every cell advances and decays alike, so both fold into one rotation
+    const float advance = params.phaseRate * deltaTime / substeps;
+    stepping.advanceCos = decay * std::cos(advance);
+    stepping.advanceSin = decay * std::sin(advance);
+    stepping.substeps = substeps;
+    
+    scratch.resize(phasors.size());
+    slabLoud.assign(dims[2], 0);
+    return substeps;
+}
+
+void WaveField::StepSlabs(int substep, int zBegin, int zEnd) {
+    if (substep >= stepping.substeps) return;
+    // Substeps alternate between the two buffers; EndStep keeps the last
+    const bool even = substep % 2 == 0;
+    const bool last = substep == stepping.substeps - 1;
+    const size_t cells = GetCellCount();
+    const size_t layer = size_t(dims[0]) * dims[1];
+    const Stepping& s = stepping;
+    for (size_t channel = 0; channel < channelCount; ++channel) {
+        const glm::vec2* in = (even ? phasors : scratch).data() + channel * cells;
+        glm::vec2* out = (even ? scratch : phasors).data() + channel * cells;
+        for (int z = zBegin; z < zEnd; ++z) {
+            bool loud = false;
+            for (int y = 0; y < dims[1]; ++y) {
+                for (int x = 0; x < dims[0]; ++x) {
+                    const size_t cell = CellIndex(x, y, z);
+                    float sumX = 0.0f, sumY = 0.0f;
+                    int neighbors = 0;
+                    auto add = [&](bool exists, size_t index) {
+                        if (!exists) return;
+                        sumX += in[index].x;
+                        sumY += in[index].y;
+                        ++neighbors;
+                    };
+                    add(x > 0, cell - 1);
+                    add(x < dims[0] - 1, cell + 1);
+                    add(y > 0, cell - dims[0]);
+                    add(y < dims[1] - 1, cell + dims[0]);
+                    add(z > 0, cell - layer);
+                    add(z < dims[2] - 1, cell + layer);
+                    
+                    const float arrivingX = s.rotateCos * sumX - s.rotateSin * sumY;
+                    const float arrivingY = s.rotateCos * sumY + s.rotateSin * sumX;
+                    const glm::vec2 here = in[cell];
+                    const float nextX = here.x + s.alpha * (arrivingX - neighbors * here.x);
+                    const float nextY = here.y + s.alpha * (arrivingY - neighbors * here.y);
+                    glm::vec2 next(s.advanceCos * nextX - s.advanceSin * nextY,
+                                   s.advanceCos * nextY + s.advanceSin * nextX);
+                    // Drop what has faded so quiet fields cost nothing
+                    if (last) {
+                        if (next.x * next.x + next.y * next.y < MinAmplitude * MinAmplitude) {
+                            next = glm::vec2(0.0f);
+                        } else {
+                            loud = true;
+                        }
+                    }
+                    out[cell] = next;
+                }
+            }
+            if (loud) slabLoud[z] = 1;
+        }
+    }
+}
+
+void WaveField::EndStep() {
+    if (stepping.substeps == 0) return;
+    if (stepping.substeps % 2 == 1) phasors.swap(scratch);
+    quiet = std::none_of(slabLoud.begin(), slabLoud.end(), [](uint8_t loud) { return loud != 0; });
+    stepping.substeps = 0;
+}
+
+bool WaveField::Sample(size_t channel, const glm::vec3& position, float& amplitude, float& phase) const {
+    if (quiet || channel >= channelCount) return false;
+    const glm::vec3 grid = ToGrid(position);
+    // Lower corner and offset to the upper one per axis; single-cell axes
+    // sample the same cell twice
+    int base[3], step[3];
+    float t[3];
+    for (int axis = 0; axis < 3; ++axis) {
+        base[axis] = std::min(static_cast<int>(grid[axis]), std::max(dims[axis] - 2, 0));
+        step[axis] = dims[axis] > 1 ? 1 : 0;
+        t[axis] = grid[axis] - base[axis];
+    }
+    
+    const glm::vec2* cells = phasors.data() + channel * GetCellCount();
+    float sumX = 0.0f, sumY = 0.0f;
+    for (int corner = 0; corner < 8; ++corner) {
+        int coord[3];
+        float weight = 1.0f;
+        for (int axis = 0; axis < 3; ++axis) {
+            const int upper = (corner >> axis) & 1;
+            coord[axis] = base[axis] + upper * step[axis];
+            weight *= upper ? t[axis] : 1.0f - t[axis];
+        }
+        const glm::vec2 phasor = cells[CellIndex(coord[0], coord[1], coord[2])];
+        sumX += weight * phasor.x;
+        sumY += weight * phasor.y;
+    }
+    
+    amplitude = std::sqrt(sumX * sumX + sumY * sumY);
+    if (amplitude < MinAmplitude) return false;
+    phase = std::atan2(sumY, sumX);
+    return true;
+}
+
+void WaveField::Refresh() {
+    quiet = std::none_of(phasors.begin(), phasors.end(), [](const glm::vec2& phasor) {
+        return phasor.x * phasor.x + phasor.y * phasor.y >= MinAmplitude * MinAmplitude;
+    });
+}
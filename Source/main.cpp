@@ -1,21 +1,43 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
+#include <atomic>
+#include <csignal>
+#include <filesystem>
 #include <iostream>
 #include <iomanip>
+#include <map>
+#include <memory>
 #include <random>
+#include <utility>
 #include <omp.h>
 #include <glm/glm.hpp>
 #include "LiquidSimulation.h"
+#include "SimulationStepper.h"
+#include "SimulationThread.h"
 #include "Camera.h"
 #include "Renderer.h"
 #include "Config.h"
+#include "RandomParticles.h"
+#include "Trace.h"
+#include "TrajectoryPlayer.h"
+#include "TrajectoryRecorder.h"
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void error_callback(int error, const char* description);
+void SaveCheckpoint(const LiquidSimulation& simulation, const std::string& path);
+int RunReplay(GLFWwindow* window, const Config& config, const std::string& path);
 
-int main() {
+// Set by SIGUSR1 to snapshot the running state at the end of the frame,
+// or after the next step when the simulation has its own thread
+std::atomic<bool> checkpointRequested = false;
+static_assert(std::atomic<bool>::is_always_lock_free);
+
+int main(int argc, char* argv[]) {
     // Load simple JSON config
     Config config = Config::Load();
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--replay") config.replayPath = argv[++i];
+    }
     
     std::cout << "?? Starting C++ Liquid Simulation with " << config.particleCount << " particles\n";
     
@@ -168,97 +190,148 @@ int main() {
         glViewport(0, 0, windowWidth, windowHeight);
     }
 
+    // Replays render a recorded run and never create a simulation
+    if (!config.replayPath.empty()) {
+        int result = RunReplay(window, config, config.replayPath);
+        glfwTerminate();
+        return result;
+    }
+
     // Create simulation using config with memory monitoring
     std::cout << "Creating simulation with " << config.particleCount << " particles...\n";
-    LiquidSimulation simulation(config.width, config.height);
+    const uint32_t seed = config.ResolveSeed();
+    std::cout << "Seed: " << seed << " (set \"seed\" in config.json to replay)\n";
+    LiquidSimulation simulation(config.width, config.height, seed);
     simulation.SetGravity(glm::vec3(0.0f, config.gravity, 0.0f));
     simulation.SetDamping(config.damping);
+    simulation.SetPressure(config.pressureStiffness, config.restDensity);
+    simulation.SetViscosity(config.viscosity);
+    simulation.SetThreadCount(config.threadCount);
+    simulation.SetCollisionIterations(config.collisionIterations);
+    simulation.SetEmitter(config.emitRate, config.emitLifetime, std::max(config.emitMaxParticles, 0));
     
     Camera camera(config.cameraPos);
     camera.SetTarget(config.cameraTarget);
     
     Renderer renderer;
 
-    // Generate particles across the massive area to fill entire window
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<float> posX(5.0f, config.width - 5.0f);   // Use massive width
-    std::uniform_real_distribution<float> posY(5.0f, config.height - 5.0f);  // Use massive height  
-    std::uniform_real_distribution<float> posZ(-15.0f, 15.0f);               // Deeper for perspective
-    std::uniform_real_distribution<float> vel(-3.0f, 3.0f);                  // Higher velocities
-    std::uniform_real_distribution<float> sizeRange(1.0f, 3.0f);             // Larger particles
-    
-    // Much brighter color palette for visibility
-    std::vector<glm::vec3> colors = {
-        glm::vec3(1.0f, 0.4f, 0.4f),  // Bright Red
-        glm::vec3(0.4f, 1.0f, 0.4f),  // Bright Green  
-        glm::vec3(0.4f, 0.4f, 1.0f),  // Bright Blue
-        glm::vec3(1.0f, 1.0f, 0.4f),  // Bright Yellow
-        glm::vec3(1.0f, 0.4f, 1.0f),  // Bright Magenta
-        glm::vec3(0.4f, 1.0f, 1.0f),  // Bright Cyan
-        glm::vec3(1.0f, 0.7f, 0.2f),  // Orange
-        glm::vec3(0.8f, 0.2f, 1.0f)   // Purple
-    };
-    
-    std::cout << "? Generating " << config.particleCount << " particles with SMP acceleration...\n";
-    
-    // Create particles in smaller batches to avoid memory spikes
-    const int batchSize = 2500;
-    for (int batch = 0; batch < config.particleCount; batch += batchSize) {
-        int endBatch = std::min(batch + batchSize, config.particleCount);
+    // Resume a checkpointed run, or generate a fresh workload
+    const bool resume = !config.checkpointPath.empty() && std::filesystem::exists(config.checkpointPath);
+    if (resume) {
+        try {
+            simulation.LoadCheckpoint(config.checkpointPath);
+            std::cout << "Resumed " << simulation.GetParticleCount() << " particles from " << config.checkpointPath << "\n";
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+    } else {
+        // Generate particles across the massive area to fill entire window
+        std::mt19937 gen = MakeWorkloadGenerator(seed);
+        std::cout << "? Generating " << config.particleCount << " particles with SMP acceleration...\n";
         
-        for (int i = batch; i < endBatch; ++i) {
-            glm::vec3 position(posX(gen), posY(gen), posZ(gen));
-            glm::vec3 velocity(vel(gen), vel(gen) * 0.8f, vel(gen) * 0.3f);
+        // Create particles in smaller batches to avoid memory spikes
+        simulation.Reserve(simulation.GetParticleCount() + config.particleCount);
+        const int batchSize = 2500;
+        for (int batch = 0; batch < config.particleCount; batch += batchSize) {
+            int endBatch = std::min(batch + batchSize, config.particleCount);
             
-            // Make colors even brighter for visibility
-            glm::vec3 baseColor = colors[i % colors.size()];
-            glm::vec3 colorVariation(
-                std::uniform_real_distribution<float>(-0.1f, 0.3f)(gen),  // Bias toward brighter
-                std::uniform_real_distribution<float>(-0.1f, 0.3f)(gen),
-                std::uniform_real_distribution<float>(-0.1f, 0.3f)(gen)
-            );
-            glm::vec3 finalColor = glm::clamp(baseColor + colorVariation, 0.2f, 1.0f);  // Minimum brightness
+            AddRandomParticles(simulation, config, batch, endBatch, gen);
             
-            simulation.AddParticle(position, velocity, finalColor);
+            // Progress feedback for large particle counts
+            if (endBatch % 10000 == 0) {
+                float progress = (float)endBatch / config.particleCount * 100.0f;
+                std::cout << "Generated " << endBatch << " particles (" << std::fixed << std::setprecision(1) << progress << "%)\n";
+            }
         }
-        
-        // Progress feedback for large particle counts
-        if (endBatch % 10000 == 0) {
-            float progress = (float)endBatch / config.particleCount * 100.0f;
-            std::cout << "Generated " << endBatch << " particles (" << std::fixed << std::setprecision(1) << progress << "%)\n";
+    }
+    if (!config.checkpointPath.empty()) {
+        std::signal(SIGUSR1, [](int) { checkpointRequested = true; });
+    }
+    
+    SimulationStepper stepper(simulation, config.fixedTimestep, config.maxSubsteps);
+    
+    // Written on a background thread; frames are dropped if the disk lags
+    std::unique_ptr<TrajectoryRecorder> recorder;
+    if (!config.recordPath.empty()) {
+        try {
+            TrajectoryRecorder::Options recordOptions;
+            recordOptions.quantize = config.recordQuantized;
+            recordOptions.delta = config.recordDelta;
+            recorder = std::make_unique<TrajectoryRecorder>(config.recordPath, recordOptions);
+            std::cout << "Recording trajectory to " << config.recordPath << "\n";
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
         }
     }
     
+    // With its own thread the simulation steps (and records, and saves
+    // checkpoints) there, and frames draw whatever it published last
+    std::unique_ptr<SimulationThread> simulationThread;
+    if (config.simulationThread) {
+        simulationThread = std::make_unique<SimulationThread>(stepper);
+        simulationThread->SetStepCallback([&](LiquidSimulation& simulation, int) {
+            if (recorder) recorder->Capture(simulation.GetParticleStore(), simulation.GetTime());
+            if (checkpointRequested.exchange(false)) SaveCheckpoint(simulation, config.checkpointPath);
+        });
+        simulationThread->Start();
+        std::cout << "Simulating on a separate thread\n";
+    }
+    
     std::cout << "? Simulation started with " << simulation.GetParticleCount() << " particles\n";
-    std::cout << "?? Controls: ESC to exit, Mouse to look around\n";
+    std::cout << "?? Controls: ESC to exit, Mouse to look around"
+              << (Trace::Enabled ? ", T to write trace.json" : "") << "\n";
 
     // Performance tracking with stability monitoring
     float deltaTime = 0.0f;
     float lastFrame = 0.0f;
     float totalTime = 0.0f;
     int frameCounter = 0;
+    // The simulation's own count is off limits while its thread runs
+    auto particleCount = [&] {
+        return simulationThread ? simulationThread->AcquireFrame().Size() : simulation.GetParticleCount();
+    };
     
     // Main render loop with stability checks
     while (!glfwWindowShouldClose(window)) {
+        TRACE_SCOPE("Frame");
         float currentFrame = static_cast<float>(glfwGetTime());
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
         totalTime += deltaTime;
         frameCounter++;
         
-        // Clamp deltaTime for stability
-        deltaTime = std::clamp(deltaTime, 0.001f, 0.033f);  // 30-1000 FPS range
-        
         // Exit on ESC key
         if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
             std::cout << "ESC pressed, exiting...\n";
             glfwSetWindowShouldClose(window, true);
         }
         
-        // Update simulation with error handling
+        // Dump the recent trace events on T (once per press)
+        static bool traceKeyDown = false;
+        bool traceKey = glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS;
+        if (Trace::Enabled && traceKey && !traceKeyDown) {
+            // The simulation and recorder threads keep tracing meanwhile;
+            // the snapshot leaves out events caught mid-write
+            if (Trace::Recorder::Global().WriteChromeTrace("trace.json")) {
+                std::cout << "Trace written to trace.json\n";
+            } else {
+                std::cerr << "Failed to write trace.json\n";
+            }
+        }
+        traceKeyDown = traceKey;
+        
+        // Step the simulation at its fixed rate with error handling
         try {
-            simulation.Update(deltaTime);
+            if (simulationThread) {
+                simulationThread->RethrowIfFailed();
+            } else {
+                int steps = stepper.Advance(deltaTime);
+                if (recorder && steps > 0) {
+                    recorder->Capture(simulation.GetParticleStore(), simulation.GetTime());
+                }
+            }
         } catch (const std::exception& e) {
             std::cerr << "Simulation error: " << e.what() << std::endl;
             break;
@@ -295,44 +368,156 @@ int main() {
             std::cout << "Window: " << width << "x" << height << " | Viewport: " 
                       << currentViewport[2] << "x" << currentViewport[3] 
                       << " | Aspect: " << aspectRatio 
-                      << " | FOV: 60� | Particles: " << simulation.GetParticleCount() << std::endl;
+                      << " | FOV: 60� | Particles: " << particleCount() << std::endl;
         }
         
         // Render with explicit projection matrix for full window coverage
         try {
             renderer.Begin(camera.GetViewMatrix(), projection);
-            renderer.RenderLiquid(simulation);
+            if (simulationThread) {
+                renderer.RenderLiquid(simulationThread->AcquireFrame());
+            } else {
+                renderer.RenderLiquid(stepper);
+            }
             renderer.End();
         } catch (const std::exception& e) {
             std::cerr << "Rendering error: " << e.what() << std::endl;
             break;
         }
         
-        glfwSwapBuffers(window);
+        {
+            TRACE_SCOPE("SwapBuffers");
+            glfwSwapBuffers(window);
+        }
         glfwPollEvents();
         
+        if (!simulationThread && checkpointRequested.exchange(false)) {
+            SaveCheckpoint(simulation, config.checkpointPath);
+        }
+        
         // Performance stats every 10 seconds
         static int statsFrameCount = 0;
         if (++statsFrameCount % 600 == 0) {
             float avgFPS = frameCounter / totalTime;
-            int numThreads = omp_get_max_threads();
+            int numThreads = simulation.GetThreadCount();
             std::cout << "?? PERFORMANCE: " << static_cast<int>(avgFPS) << " FPS avg | " 
-                      << simulation.GetParticleCount() << " particles | "
+                      << particleCount() << " particles | "
                       << numThreads << " CPU cores | "
                       << width << "x" << height << "\n";
         }
     }
 
-    // Save config on exit
+    simulationThread.reset(); // Hands the simulation back to this thread
+    
+    if (recorder) {
+        std::cout << "Trajectory: " << recorder->GetCapturedCount() << " frames captured, "
+                  << recorder->GetDroppedCount() << " dropped\n";
+        recorder.reset(); // Writes the rest, then the index, and closes the file
+    }
+    
+    // Save config (and the run, if checkpointing) on exit
     config.Save();
+    if (!config.checkpointPath.empty()) {
+        SaveCheckpoint(simulation, config.checkpointPath);
+    }
     
     std::cout << "?? Simulation ended successfully. Runtime: " << std::fixed << std::setprecision(1) << totalTime << " seconds\n";
-    std::cout << "? SMP performance with " << omp_get_max_threads() << " CPU cores utilized\n";
+    std::cout << "? SMP performance with " << simulation.GetThreadCount() << " CPU cores utilized\n";
     
     glfwTerminate();
     return 0;
 }
 
+int RunReplay(GLFWwindow* window, const Config& config, const std::string& path) {
+    std::unique_ptr<TrajectoryPlayer> player;
+    try {
+        player = std::make_unique<TrajectoryPlayer>(path);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return -1;
+    }
+    const TrajectoryReader& reader = player->GetReader();
+    std::cout << "Replaying " << path << ": " << player->GetFrameCount() << " frames, "
+              << player->GetFrame().Size() << " particles, "
+              << std::fixed << std::setprecision(1) << player->GetEndTime() - player->GetStartTime() << " s"
+              << (reader.WasRecovered() ? " (unclosed file, index rebuilt)" : "") << "\n";
+    std::cout << "?? Controls: ESC to exit, Space to pause, Left/Right to seek 5 s, "
+              << "Up/Down to double/halve speed, R to reverse, Home to restart\n";
+    
+    Camera camera(config.cameraPos);
+    camera.SetTarget(config.cameraTarget);
+    Renderer renderer;
+    
+    // Edge-triggered keys: act once per press
+    std::map<int, bool> keysDown;
+    auto pressed = [&](int key) {
+        bool down = glfwGetKey(window, key) == GLFW_PRESS;
+        bool wasDown = std::exchange(keysDown[key], down);
+        return down && !wasDown;
+    };
+    
+    float lastFrame = static_cast<float>(glfwGetTime());
+    while (!glfwWindowShouldClose(window)) {
+        TRACE_SCOPE("Frame");
+        float currentFrame = static_cast<float>(glfwGetTime());
+        float deltaTime = currentFrame - lastFrame;
+        lastFrame = currentFrame;
+        
+        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) glfwSetWindowShouldClose(window, true);
+        if (pressed(GLFW_KEY_SPACE)) player->SetPaused(!player->IsPaused());
+        if (pressed(GLFW_KEY_UP)) player->SetSpeed(player->GetSpeed() * 2.0);
+        if (pressed(GLFW_KEY_DOWN)) player->SetSpeed(player->GetSpeed() * 0.5);
+        if (pressed(GLFW_KEY_R)) player->SetSpeed(-player->GetSpeed());
+        if (pressed(GLFW_KEY_HOME)) player->SeekFrame(0);
+        if (pressed(GLFW_KEY_LEFT)) player->Seek(player->GetTime() - 5.0);
+        if (pressed(GLFW_KEY_RIGHT)) player->Seek(player->GetTime() + 5.0);
+        if (Trace::Enabled && pressed(GLFW_KEY_T)) {
+            Trace::Recorder::Global().WriteChromeTrace("trace.json");
+        }
+        
+        try {
+            player->Advance(deltaTime);
+        } catch (const std::exception& e) {
+            std::cerr << "Replay error: " << e.what() << std::endl;
+            return -1;
+        }
+        
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        glViewport(0, 0, width, height);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        float aspectRatio = static_cast<float>(width) / static_cast<float>(std::max(height, 1));
+        glm::mat4 projection = glm::perspective(glm::radians(60.0f), aspectRatio, 0.1f, 200.0f);
+        
+        renderer.Begin(camera.GetViewMatrix(), projection);
+        renderer.RenderLiquid(player->GetFrame());
+        renderer.End();
+        
+        {
+            TRACE_SCOPE("SwapBuffers");
+            glfwSwapBuffers(window);
+        }
+        glfwPollEvents();
+        
+        static int statsFrameCount = 0;
+        if (++statsFrameCount % 600 == 0) {
+            std::cout << "Replay: frame " << player->GetFrameIndex() + 1 << "/" << player->GetFrameCount()
+                      << " | t=" << std::setprecision(2) << player->GetTime() << " s | speed "
+                      << player->GetSpeed() << "x" << (player->IsPaused() ? " (paused)" : "") << "\n";
+        }
+    }
+    return 0;
+}
+
+void SaveCheckpoint(const LiquidSimulation& simulation, const std::string& path) {
+    try {
+        simulation.SaveCheckpoint(path);
+        std::cout << "Checkpoint saved to " << path << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Checkpoint failed: " << e.what() << std::endl;
+    }
+}
+
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     // Update viewport to use full window size
     glViewport(0, 0, width, height);
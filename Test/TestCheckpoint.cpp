@@ -0,0 +1,153 @@
+#include "Checkpoint.h"
+#include "LiquidSimulation.h"
+#include <glm/glm.hpp>
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+class CheckpointTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    simulation = std::make_unique<LiquidSimulation>(100.0f, 100.0f, 7);
+    // Long enough for the centroid colors to drift, so memberships lag them
+    for (int i = 0; i < 200; ++i) simulation->Update(0.016f);
+  }
+
+  void TearDown() override { std::remove(path.c_str()); }
+
+  std::vector<char> ReadFile() {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), {}};
+  }
+
+  void WriteFile(const std::vector<char> &bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), bytes.size());
+  }
+
+  static void ExpectSameParticles(const LiquidSimulation &a, const LiquidSimulation &b) {
+    const auto &pa = a.GetParticles();
+    const auto &pb = b.GetParticles();
+    ASSERT_EQ(pa.size(), pb.size());
+    for (size_t i = 0; i < pa.size(); ++i) {
+      EXPECT_EQ(pa[i].position, pb[i].position);
+      EXPECT_EQ(pa[i].velocity, pb[i].velocity);
+      EXPECT_EQ(pa[i].color, pb[i].color);
+      EXPECT_EQ(pa[i].radius, pb[i].radius);
+      EXPECT_EQ(pa[i].waveAmplitude, pb[i].waveAmplitude);
+    }
+  }
+
+  std::unique_ptr<LiquidSimulation> simulation;
+  const std::string path = "test_checkpoint.bin";
+};
+
+TEST_F(CheckpointTest, RoundTripRestoresParticles) {
+  simulation->SaveCheckpoint(path);
+
+  LiquidSimulation restored(10.0f, 10.0f, 99);
+  restored.LoadCheckpoint(path);
+  EXPECT_EQ(restored.GetSeed(), 7u);
+  // The walls follow the checkpoint's size
+  for (size_t w = 0; w < restored.GetWalls().size(); ++w) {
+    EXPECT_EQ(restored.GetWalls()[w].GetPosition(), simulation->GetWalls()[w].GetPosition());
+  }
+  ExpectSameParticles(*simulation, restored);
+  for (size_t i = 0; i < restored.GetParticleCount(); ++i) {
+    EXPECT_EQ(restored.GetParticleGroup(i), simulation->GetParticleGroup(i));
+  }
+}
+
+TEST_F(CheckpointTest, RestoredRunContinuesIdentically) {
+  simulation->SaveCheckpoint(path);
+  LiquidSimulation restored(100.0f, 100.0f, 99);
+  restored.LoadCheckpoint(path);
+
+  for (size_t i = 0; i < restored.GetParticleCount(); ++i) {
+    EXPECT_EQ(restored.GetParticleGroupDistance(i), simulation->GetParticleGroupDistance(i));
+  }
+  for (int i = 0; i < 20; ++i) {
+    simulation->Update(0.016f);
+    restored.Update(0.016f);
+  }
+  ExpectSameParticles(*simulation, restored);
+}
+
+TEST_F(CheckpointTest, RestoresFluidParameters) {
+  simulation->SetPressure(1500.0f, 2.0f);
+  simulation->SetViscosity(1.0f);
+  simulation->SaveCheckpoint(path);
+  LiquidSimulation restored(100.0f, 100.0f, 99); // Default constants
+  restored.LoadCheckpoint(path);
+
+  for (int i = 0; i < 20; ++i) {
+    simulation->Update(0.016f);
+    restored.Update(0.016f);
+  }
+  ExpectSameParticles(*simulation, restored);
+}
+
+TEST_F(CheckpointTest, RestoresLifetimesAndFreeSlots) {
+  simulation->Spawn({glm::vec3(1.0f), glm::vec3(0.0f), glm::vec3(0.5f), 2.0f});
+  simulation->Despawn(4);
+  simulation->SaveCheckpoint(path);
+
+  LiquidSimulation restored(100.0f, 100.0f, 99);
+  restored.LoadCheckpoint(path);
+  EXPECT_FALSE(restored.IsAlive(4));
+  EXPECT_EQ(restored.GetLiveCount(), simulation->GetLiveCount());
+  EXPECT_EQ(restored.GetParticleStore().expireTime, simulation->GetParticleStore().expireTime);
+
+  // The restored run expires and compacts the same way
+  for (int i = 0; i < 3; ++i) {
+    simulation->Update(1.0f);
+    restored.Update(1.0f);
+  }
+  EXPECT_EQ(restored.GetParticleCount(), simulation->GetParticleCount());
+  ExpectSameParticles(*simulation, restored);
+}
+
+TEST_F(CheckpointTest, SectionsAreAligned) {
+  simulation->SaveCheckpoint(path);
+  std::vector<char> bytes = ReadFile();
+  Checkpoint::Header header;
+  std::memcpy(&header, bytes.data(), sizeof(header));
+  EXPECT_EQ(header.fileSize, bytes.size());
+  EXPECT_EQ(header.particleCount, simulation->GetParticleCount());
+
+  for (uint32_t s = 0; s < header.sectionCount; ++s) {
+    Checkpoint::Section section;
+    std::memcpy(&section, bytes.data() + sizeof(header) + s * sizeof(section), sizeof(section));
+    EXPECT_EQ(section.offset % Checkpoint::Alignment, 0u);
+  }
+}
+
+TEST_F(CheckpointTest, MissingFileThrows) {
+  EXPECT_THROW(simulation->LoadCheckpoint("does_not_exist.bin"), std::runtime_error);
+}
+
+TEST_F(CheckpointTest, CorruptFilesAreRejectedWithoutChangingState) {
+  simulation->SaveCheckpoint(path);
+  const std::vector<char> good = ReadFile();
+  LiquidSimulation target(100.0f, 100.0f, 3);
+  const size_t originalCount = target.GetParticleCount();
+
+  std::vector<char> badMagic = good;
+  badMagic[0] = 'X';
+  WriteFile(badMagic);
+  EXPECT_THROW(target.LoadCheckpoint(path), std::runtime_error);
+
+  std::vector<char> badVersion = good;
+  badVersion[offsetof(Checkpoint::Header, version)] = 9;
+  WriteFile(badVersion);
+  EXPECT_THROW(target.LoadCheckpoint(path), std::runtime_error);
+
+  WriteFile(std::vector<char>(good.begin(), good.end() - 64));
+  EXPECT_THROW(target.LoadCheckpoint(path), std::runtime_error);
+
+  EXPECT_EQ(target.GetParticleCount(), originalCount);
+}
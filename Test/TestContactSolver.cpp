@@ -0,0 +1,106 @@
+#include "ContactSolver.h"
+#include "ParticleStore.h"
+#include <glm/glm.hpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <set>
+
+class ContactSolverTest : public ::testing::Test {
+protected:
+  void AddParticle(const glm::vec3 &position, const glm::vec3 &velocity,
+                   float radius = 0.5f, float mass = 1.0f) {
+    LiquidParticle p{};
+    p.position = position;
+    p.velocity = velocity;
+    p.radius = radius;
+    p.baseRadius = radius;
+    p.mass = mass;
+    store.Add(p);
+  }
+
+  void FillRandom(int count) {
+    std::mt19937 gen(99);
+    std::uniform_real_distribution<float> pos(-3.0f, 3.0f);
+    std::uniform_real_distribution<float> vel(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> rad(0.3f, 1.2f);
+    for (int i = 0; i < count; ++i) {
+      AddParticle(glm::vec3(pos(gen), pos(gen), pos(gen)),
+                  glm::vec3(vel(gen), vel(gen), vel(gen)), rad(gen));
+    }
+  }
+
+  ParticleStore store;
+  ContactSolver solver;
+};
+
+TEST_F(ContactSolverTest, SeparatesOverlappingPair) {
+  AddParticle(glm::vec3(0.0f), glm::vec3(0.0f));
+  AddParticle(glm::vec3(0.6f, 0.0f, 0.0f), glm::vec3(0.0f));
+  solver.Solve(store, 1, 1);
+
+  ASSERT_EQ(solver.GetContacts().size(), 1);
+  EXPECT_NEAR(glm::length(store.GetPosition(1) - store.GetPosition(0)), 1.0f, 1e-5f);
+}
+
+TEST_F(ContactSolverTest, PreservesRestitutionImpulse) {
+  // Relative velocity along the contact normal of 2, restitution 0.1
+  AddParticle(glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+  AddParticle(glm::vec3(-0.9f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f));
+  solver.Solve(store, 1, 1);
+
+  EXPECT_NEAR(store.vx[0], 1.0f - 1.1f, 1e-5f);
+  EXPECT_NEAR(store.vx[1], -1.0f + 1.1f, 1e-5f);
+  EXPECT_NEAR(solver.GetContacts()[0].waveIntensity, 0.2f, 1e-5f);
+}
+
+TEST_F(ContactSolverTest, BatchesAreConflictFree) {
+  FillRandom(600);
+  solver.Solve(store, 1, 1);
+  ASSERT_GT(solver.GetContacts().size(), 0);
+
+  // The last batch may be the serial overflow batch
+  for (size_t b = 0; b < std::min<size_t>(solver.GetBatchCount(), 64); ++b) {
+    std::set<uint32_t> seen;
+    for (size_t c = solver.GetBatchBegin(b); c < solver.GetBatchEnd(b); ++c) {
+      const auto &contact = solver.GetContacts()[c];
+      EXPECT_TRUE(seen.insert(contact.a).second);
+      EXPECT_TRUE(seen.insert(contact.b).second);
+    }
+  }
+}
+
+TEST_F(ContactSolverTest, ResultsIndependentOfThreadCount) {
+  FillRandom(600);
+  ParticleStore copy = store;
+  ContactSolver other;
+
+  solver.Solve(store, 3, 1);
+  other.Solve(copy, 3, 4);
+
+  for (size_t i = 0; i < store.Size(); ++i) {
+    EXPECT_EQ(store.GetPosition(i), copy.GetPosition(i));
+    EXPECT_EQ(store.GetVelocity(i), copy.GetVelocity(i));
+  }
+}
+
+TEST_F(ContactSolverTest, MoreIterationsReduceOverlap) {
+  FillRandom(600);
+  ParticleStore once = store;
+  ParticleStore many = store;
+  ContactSolver other;
+  solver.Solve(once, 1, 1);
+  other.Solve(many, 8, 1);
+
+  auto totalOverlap = [](const ParticleStore &s) {
+    float total = 0.0f;
+    for (size_t i = 0; i < s.Size(); ++i) {
+      for (size_t j = i + 1; j < s.Size(); ++j) {
+        float d = glm::length(s.GetPosition(i) - s.GetPosition(j));
+        total += std::max(0.0f, s.radius[i] + s.radius[j] - d);
+      }
+    }
+    return total;
+  };
+  EXPECT_LT(totalOverlap(many), totalOverlap(once));
+}
@@ -0,0 +1,74 @@
+#include "GroupHistogram.h"
+#include <glm/glm.hpp>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+class GroupHistogramTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<float> x(-15.0f, 15.0f);
+    std::uniform_real_distribution<float> y(0.0f, 5.0f);
+    std::uniform_real_distribution<float> z(-10.0f, 10.0f);
+    std::uniform_int_distribution<int> group(0, groupCount); // groupCount = uncounted
+    for (int i = 0; i < 2000; ++i) {
+      points.emplace_back(x(gen), y(gen), z(gen));
+      int g = group(gen);
+      groups.push_back(g == groupCount ? GroupHistogram::Uncounted : static_cast<uint8_t>(g));
+    }
+    histogram.Build(points.size(), groupCount, radius,
+                    [this](size_t i) { return points[i]; },
+                    [this](size_t i) { return groups[i]; });
+  }
+
+  std::vector<int> BruteForce(const glm::vec3 &point) const {
+    std::vector<int> counts(groupCount, 0);
+    for (size_t j = 0; j < points.size(); ++j) {
+      glm::vec3 diff = points[j] - point;
+      if (groups[j] != GroupHistogram::Uncounted && glm::dot(diff, diff) < radius * radius) {
+        ++counts[groups[j]];
+      }
+    }
+    return counts;
+  }
+
+  static constexpr int groupCount = 6;
+  const float radius = 2.0f;
+  std::vector<glm::vec3> points;
+  std::vector<uint8_t> groups;
+  GroupHistogram histogram;
+};
+
+TEST_F(GroupHistogramTest, ExactModeMatchesBruteForce) {
+  for (size_t i = 0; i < points.size(); i += 7) {
+    std::vector<int> counts(groupCount, 0);
+    histogram.Count(points[i], GroupHistogram::Mode::Exact, counts.data());
+    EXPECT_EQ(counts, BruteForce(points[i]));
+  }
+}
+
+TEST_F(GroupHistogramTest, ApproximateModeTracksExact) {
+  long exactTotal = 0, absError = 0;
+  for (size_t i = 0; i < points.size(); ++i) {
+    std::vector<int> exact(groupCount, 0), approx(groupCount, 0);
+    histogram.Count(points[i], GroupHistogram::Mode::Exact, exact.data());
+    histogram.Count(points[i], GroupHistogram::Mode::Approximate, approx.data());
+    for (int g = 0; g < groupCount; ++g) {
+      exactTotal += exact[g];
+      absError += std::abs(approx[g] - exact[g]);
+    }
+  }
+  ASSERT_GT(exactTotal, 0);
+  // Cell-granular boundary: same ballpark, not the same counts
+  EXPECT_LT(static_cast<double>(absError) / exactTotal, 0.5);
+}
+
+TEST_F(GroupHistogramTest, CountAccumulatesIntoExistingCounts) {
+  std::vector<int> counts(groupCount, 10);
+  histogram.Count(points[0], GroupHistogram::Mode::Exact, counts.data());
+  std::vector<int> expected = BruteForce(points[0]);
+  for (int g = 0; g < groupCount; ++g) {
+    EXPECT_EQ(counts[g], expected[g] + 10);
+  }
+}
@@ -0,0 +1,122 @@
+#include "GroupStats.h"
+#include "LiquidSimulation.h"
+#include <glm/glm.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+
+class GroupStatsTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    simulation = std::make_unique<LiquidSimulation>(100.0f, 100.0f, 21);
+    std::vector<ParticleInit> inits;
+    for (int i = 0; i < 6000; ++i) {
+      // Spread over every group color so each has members
+      const glm::vec3 color = simulation->GetGroupColor(static_cast<uint8_t>(i % simulation->GetGroupCount()));
+      inits.push_back({glm::vec3(i % 80 - 40.0f, 1.0f + i % 7, i % 30 - 15.0f),
+                       glm::vec3(0.0f), color});
+    }
+    simulation->AddParticles(inits);
+    simulation->Update(0.016f);
+  }
+
+  std::unique_ptr<LiquidSimulation> simulation;
+};
+
+TEST_F(GroupStatsTest, MergedPartialsMatchOnePass) {
+  const glm::vec3 points[] = {{1, 2, 3}, {-4, 0, 2}, {5, -1, 0}, {0, 7, -3}};
+  GroupStats whole, first, second;
+  for (int i = 0; i < 4; ++i) {
+    whole.Add(points[i], points[i] * 2.0f);
+    (i < 2 ? first : second).Add(points[i], points[i] * 2.0f);
+  }
+  first.Merge(second);
+  EXPECT_EQ(first.count, 4u);
+  EXPECT_EQ(first.positionSum, whole.positionSum);
+  EXPECT_EQ(first.velocitySum, whole.velocitySum);
+  EXPECT_EQ(first.boundsMin, glm::vec3(-4, -1, -3));
+  EXPECT_EQ(first.boundsMax, glm::vec3(5, 7, 3));
+  EXPECT_EQ(first.GetMeanPosition(), glm::vec3(0.5f, 2.0f, 0.5f));
+}
+
+TEST_F(GroupStatsTest, RepresentativeTiesKeepTheEarliest) {
+  GroupStats first, second;
+  first.OfferRepresentative(3, 4.0f);
+  first.OfferRepresentative(7, 4.0f);
+  second.OfferRepresentative(9, 4.0f);
+  first.Merge(second);
+  EXPECT_EQ(first.representative, 3u);
+  EXPECT_EQ(GroupStats().representative, GroupStats::NoMember);
+}
+
+TEST_F(GroupStatsTest, MatchesABruteForceScan) {
+  const ParticleStore &particles = simulation->GetParticleStore();
+  const auto &stats = simulation->GetGroupStats();
+  ASSERT_EQ(stats.size(), simulation->GetGroupCount());
+
+  size_t total = 0;
+  for (size_t g = 0; g < stats.size(); ++g) {
+    GroupStats expected;
+    for (size_t i = 0; i < particles.Size(); ++i) {
+      if (simulation->GetParticleGroup(i) != g) continue;
+      expected.Add(particles.GetPosition(i), particles.GetVelocity(i));
+    }
+    EXPECT_EQ(stats[g].count, expected.count);
+    EXPECT_EQ(stats[g].boundsMin, expected.boundsMin);
+    EXPECT_EQ(stats[g].boundsMax, expected.boundsMax);
+    const glm::vec3 meanError = stats[g].GetMeanPosition() - expected.GetMeanPosition();
+    EXPECT_LT(glm::length(meanError), 1e-3f);
+    total += stats[g].count;
+
+    // A strong member, and no strong member of the group is closer
+    ASSERT_NE(stats[g].representative, GroupStats::NoMember);
+    const size_t representative = stats[g].representative;
+    EXPECT_EQ(simulation->GetParticleGroup(representative), g);
+    EXPECT_LT(simulation->GetParticleGroupDistance(representative), 0.3f);
+  }
+  EXPECT_EQ(total, particles.Size());
+}
+
+TEST_F(GroupStatsTest, IdenticalForAnyThreadCount) {
+  LiquidSimulation serial(100.0f, 100.0f, 21);
+  LiquidSimulation parallel(100.0f, 100.0f, 21);
+  serial.SetThreadCount(1);
+  parallel.SetThreadCount(3);
+  std::vector<ParticleInit> inits(10000, {glm::vec3(2.0f, 1.0f, 0.0f), glm::vec3(1.0f), glm::vec3(0.2f, 0.6f, 1.0f)});
+  for (size_t i = 0; i < inits.size(); ++i) inits[i].position.x += i * 0.001f;
+  serial.AddParticles(inits);
+  parallel.AddParticles(inits);
+  serial.Update(0.016f);
+  parallel.Update(0.016f);
+
+  for (size_t g = 0; g < serial.GetGroupCount(); ++g) {
+    const GroupStats &a = serial.GetGroupStats()[g];
+    const GroupStats &b = parallel.GetGroupStats()[g];
+    EXPECT_EQ(a.count, b.count);
+    EXPECT_EQ(a.positionSum, b.positionSum);
+    EXPECT_EQ(a.velocitySum, b.velocitySum);
+    EXPECT_EQ(a.representative, b.representative);
+  }
+}
+
+TEST_F(GroupStatsTest, RepresentativesFollowCompaction) {
+  LiquidSimulation simulation(100.0f, 100.0f, 5);
+  simulation.Update(0.016f);
+  const size_t g = 0;
+  const uint32_t representative = simulation.GetGroupStats()[g].representative;
+  ASSERT_NE(representative, GroupStats::NoMember);
+  ASSERT_GT(representative, 0u);
+
+  // Make the representative the last live particle, then open a hole
+  // below it: compaction moves it down into the hole
+  for (size_t i = representative + 1; i < simulation.GetParticleCount(); ++i) simulation.Despawn(i);
+  simulation.Despawn(0);
+  const glm::vec3 position = simulation.GetParticleStore().GetPosition(representative);
+  simulation.Compact();
+  EXPECT_EQ(simulation.GetGroupStats()[g].representative, 0u);
+  EXPECT_EQ(simulation.GetParticleStore().GetPosition(0), position);
+
+  // A despawned representative is dropped, not left naming a reused slot
+  simulation.Despawn(0);
+  simulation.Compact();
+  EXPECT_EQ(simulation.GetGroupStats()[g].representative, GroupStats::NoMember);
+}
@@ -1,4 +1,5 @@
 #include "LiquidSimulation.h"
+#include "RandomParticles.h"
 #include <glm/glm.hpp>
 #include <gtest/gtest.h>
 
@@ -19,6 +20,21 @@ TEST_F(LiquidSimulationTest, InitializationCreatesWalls) {
   EXPECT_EQ(simulation->GetWalls().size(), 6); // 4 walls + floor + ceiling
 }
 
+TEST(LiquidSimulationWallsTest, RandomWorkloadStartsInsideTheWalls) {
+  Config config;
+  LiquidSimulation simulation(config.width, config.height, 4);
+  const size_t builtIn = simulation.GetParticleCount();
+  std::mt19937 gen = MakeWorkloadGenerator(4);
+  AddRandomParticles(simulation, config, 0, 2000, gen);
+
+  // No particle has to be dragged in from outside the box
+  const ParticleStore &store = simulation.GetParticleStore();
+  for (size_t i = builtIn; i < store.Size(); ++i) {
+    glm::vec3 gradient;
+    EXPECT_GT(simulation.GetWallField().Sample(store.GetPosition(i), gradient), 0.0f) << i;
+  }
+}
+
 TEST_F(LiquidSimulationTest, AddParticleIncreasesCount) {
   size_t initialCount = simulation->GetParticles().size();
   simulation->AddParticle(glm::vec3(0.0f), glm::vec3(0.0f),
@@ -26,6 +42,67 @@ TEST_F(LiquidSimulationTest, AddParticleIncreasesCount) {
   EXPECT_EQ(simulation->GetParticles().size(), initialCount + 1);
 }
 
+TEST_F(LiquidSimulationTest, AddParticlesAppendsInOrder) {
+  const size_t initialCount = simulation->GetParticleCount();
+  std::vector<ParticleInit> inits;
+  for (int i = 0; i < 100; ++i) {
+    inits.push_back({glm::vec3(i, 1.0f, 2.0f), glm::vec3(0.5f, 0.0f, -1.0f),
+                     glm::vec3(0.25f, 0.5f, 1.0f)});
+  }
+  simulation->AddParticles(inits);
+  ASSERT_EQ(simulation->GetParticleCount(), initialCount + inits.size());
+
+  const ParticleStore &store = simulation->GetParticleStore();
+  for (size_t n = 0; n < inits.size(); ++n) {
+    const size_t i = initialCount + n;
+    EXPECT_EQ(store.GetPosition(i), inits[n].position);
+    EXPECT_EQ(store.GetVelocity(i), inits[n].velocity);
+    EXPECT_EQ(store.color[i], inits[n].color);
+    EXPECT_EQ(store.targetColor[i], inits[n].color);
+    EXPECT_GE(store.baseRadius[i], 0.3f);
+    EXPECT_LT(store.baseRadius[i], 1.2f);
+    EXPECT_EQ(store.radius[i], store.baseRadius[i]);
+    EXPECT_GE(store.mass[i], 0.2f);
+    EXPECT_LT(store.mass[i], 1.0f);
+    EXPECT_GE(store.waveDecay[i], 0.85f);
+    EXPECT_LT(store.waveDecay[i], 0.95f);
+  }
+}
+
+TEST_F(LiquidSimulationTest, AddParticlesIsThreadCountIndependent) {
+  LiquidSimulation serial(100.0f, 100.0f, 9);
+  LiquidSimulation parallel(100.0f, 100.0f, 9);
+  serial.SetThreadCount(1);
+  parallel.SetThreadCount(4);
+  std::vector<ParticleInit> inits(20000, {glm::vec3(1.0f), glm::vec3(0.0f), glm::vec3(0.5f)});
+  serial.AddParticles(inits);
+  parallel.AddParticles(inits);
+
+  const ParticleStore &a = serial.GetParticleStore();
+  const ParticleStore &b = parallel.GetParticleStore();
+  EXPECT_EQ(a.mass, b.mass);
+  EXPECT_EQ(a.baseRadius, b.baseRadius);
+  EXPECT_EQ(a.colorTransitionSpeed, b.colorTransitionSpeed);
+  EXPECT_EQ(a.waveDecay, b.waveDecay);
+  for (size_t i = 0; i < serial.GetParticleCount(); ++i) {
+    EXPECT_EQ(serial.GetParticleGroup(i), parallel.GetParticleGroup(i));
+  }
+}
+
+TEST_F(LiquidSimulationTest, ReserveAvoidsReallocation) {
+  const size_t target = simulation->GetParticleCount() + 5000;
+  simulation->Reserve(target);
+  EXPECT_GE(simulation->GetCapacity(), target);
+
+  const float *data = simulation->GetParticleStore().x.data();
+  std::vector<ParticleInit> batch(1000, {glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(1.0f)});
+  for (int i = 0; i < 5; ++i) {
+    simulation->AddParticles(batch);
+  }
+  EXPECT_EQ(simulation->GetParticleCount(), target);
+  EXPECT_EQ(simulation->GetParticleStore().x.data(), data);
+}
+
 TEST_F(LiquidSimulationTest, UpdateMaintainsParticleCount) {
   size_t initialCount = simulation->GetParticles().size();
   simulation->Update(0.016f); // ~60Hz
@@ -58,4 +135,201 @@ TEST_F(LiquidSimulationTest, ParticlesStayWithinBounds) {
     EXPECT_LE(particle.position.z, halfHeight + particle.radius);
     EXPECT_GE(particle.position.y, 0.0f);
   }
-}
\ No newline at end of file
+}
+
+TEST_F(LiquidSimulationTest, ResultsIndependentOfThreadCount) {
+  LiquidSimulation singleThreaded = *simulation;
+  LiquidSimulation multiThreaded = *simulation;
+  singleThreaded.SetThreadCount(1);
+  multiThreaded.SetThreadCount(4);
+
+  for (int i = 0; i < 5; ++i) {
+    singleThreaded.Update(0.016f);
+    multiThreaded.Update(0.016f);
+  }
+
+  const auto &a = singleThreaded.GetParticles();
+  const auto &b = multiThreaded.GetParticles();
+  ASSERT_EQ(a.size(), b.size());
+  for (size_t i = 0; i < a.size(); ++i) {
+    EXPECT_EQ(a[i].position, b[i].position);
+    EXPECT_EQ(a[i].velocity, b[i].velocity);
+    EXPECT_EQ(a[i].color, b[i].color);
+    EXPECT_EQ(a[i].waveAmplitude, b[i].waveAmplitude);
+  }
+}
+
+TEST_F(LiquidSimulationTest, SameSeedGivesIdenticalRuns) {
+  LiquidSimulation first(100.0f, 100.0f, 42);
+  LiquidSimulation second(100.0f, 100.0f, 42);
+  EXPECT_EQ(first.GetSeed(), 42u);
+  second.SetThreadCount(3);
+
+  for (int i = 0; i < 10; ++i) {
+    first.Update(0.016f);
+    second.Update(0.016f);
+  }
+
+  const auto &a = first.GetParticles();
+  const auto &b = second.GetParticles();
+  ASSERT_EQ(a.size(), b.size());
+  for (size_t i = 0; i < a.size(); ++i) {
+    EXPECT_EQ(a[i].position, b[i].position);
+    EXPECT_EQ(a[i].velocity, b[i].velocity);
+    EXPECT_EQ(a[i].color, b[i].color);
+    EXPECT_EQ(a[i].waveAmplitude, b[i].waveAmplitude);
+  }
+}
+
+TEST_F(LiquidSimulationTest, DifferentSeedsDiverge) {
+  LiquidSimulation first(100.0f, 100.0f, 1);
+  LiquidSimulation second(100.0f, 100.0f, 2);
+  first.Update(0.016f);
+  second.Update(0.016f);
+
+  const auto &a = first.GetParticles();
+  const auto &b = second.GetParticles();
+  bool anyDifferent = false;
+  for (size_t i = 0; i < std::min(a.size(), b.size()); ++i) {
+    anyDifferent |= a[i].position != b[i].position;
+  }
+  EXPECT_TRUE(anyDifferent);
+}
+
+TEST_F(LiquidSimulationTest, WaveAmplitudeStaysBounded) {
+  for (int i = 0; i < 20; ++i) {
+    simulation->Update(0.016f);
+  }
+
+  // Events carry intensity <= 1 and falloff <= 1, and applying a batch
+  // takes the max rather than accumulating
+  for (const auto &particle : simulation->GetParticles()) {
+    EXPECT_GE(particle.waveAmplitude, 0.0f);
+    EXPECT_LE(particle.waveAmplitude, 1.0f);
+  }
+}
+
+TEST_F(LiquidSimulationTest, CachedGroupMatchesNearestCentroid) {
+  for (int step = 0; step < 10; ++step) {
+    simulation->Update(0.016f);
+  }
+  const auto &store = simulation->GetParticleStore();
+  for (size_t i = 0; i < store.Size(); ++i) {
+    uint8_t nearest = LiquidSimulation::NoGroup;
+    float minColorDist = 999.0f;
+    for (size_t c = 0; c < simulation->GetGroupCount(); ++c) {
+      float colorDist = glm::length(store.color[i] - simulation->GetGroupColor(c));
+      if (colorDist < minColorDist) {
+        minColorDist = colorDist;
+        nearest = static_cast<uint8_t>(c);
+      }
+    }
+    // Cached from a particle color and centroid colors each at most the
+    // tolerance away, so only a near tie may pick another group
+    const float tolerance = LiquidSimulation::MembershipColorTolerance;
+    const uint8_t cached = simulation->GetParticleGroup(i);
+    const float cachedDist = glm::length(store.color[i] - simulation->GetGroupColor(cached));
+    EXPECT_TRUE(cached == nearest || cachedDist <= minColorDist + 4.0f * tolerance);
+    EXPECT_NEAR(simulation->GetParticleGroupDistance(i), cachedDist, 2.0f * tolerance + 1e-5f);
+  }
+}
+
+TEST_F(LiquidSimulationTest, SmallCentroidColorDriftKeepsMemberships) {
+  // Memberships only move with a particle's own color or a refresh
+  int colorSteps = 0, refreshSteps = 0;
+  for (int step = 0; step < 600; ++step) {
+    std::vector<glm::vec3> groupColors;
+    for (size_t g = 0; g < simulation->GetGroupCount(); ++g) {
+      groupColors.push_back(simulation->GetGroupColor(static_cast<uint8_t>(g)));
+    }
+    const glm::vec3 color = simulation->GetParticleStore().color[0];
+    const float distance = simulation->GetParticleGroupDistance(0);
+    simulation->Update(0.016f);
+    bool colorsMoved = false;
+    for (size_t g = 0; g < groupColors.size(); ++g) {
+      colorsMoved |= simulation->GetGroupColor(static_cast<uint8_t>(g)) != groupColors[g];
+    }
+    colorSteps += colorsMoved;
+    refreshSteps += simulation->GetParticleStore().color[0] == color &&
+                    simulation->GetParticleGroupDistance(0) != distance;
+  }
+  // Centroid colors morph on many steps; a full refresh is much rarer
+  EXPECT_GT(colorSteps, 100);
+  EXPECT_LT(refreshSteps, colorSteps / 4);
+}
+
+TEST_F(LiquidSimulationTest, SmallParticleColorStepsKeepMemberships) {
+  // Colors ease toward their targets a little every step; a membership
+  // only follows once the color has moved past the tolerance
+  size_t colorChanges = 0, membershipChanges = 0;
+  for (int step = 0; step < 200; ++step) {
+    const std::vector<glm::vec3> colors = simulation->GetParticleStore().color;
+    std::vector<float> distances;
+    for (size_t i = 0; i < colors.size(); ++i) {
+      distances.push_back(simulation->GetParticleGroupDistance(i));
+    }
+    simulation->Update(0.016f);
+    for (size_t i = 0; i < colors.size() && i < simulation->GetParticleCount(); ++i) {
+      colorChanges += simulation->GetParticleStore().color[i] != colors[i];
+      membershipChanges += simulation->GetParticleGroupDistance(i) != distances[i];
+    }
+  }
+  EXPECT_GT(colorChanges, 1000u);
+  EXPECT_LT(membershipChanges, colorChanges / 2);
+}
+
+TEST_F(LiquidSimulationTest, ColorCountModesBothProduceValidColors) {
+  LiquidSimulation approximate = *simulation;
+  approximate.SetColorCountMode(GroupHistogram::Mode::Approximate);
+  for (int step = 0; step < 20; ++step) {
+    simulation->Update(0.016f);
+    approximate.Update(0.016f);
+  }
+
+  // Same particles, nearly the same colors: only boundary cells differ
+  const auto &exact = simulation->GetParticleStore();
+  const auto &approx = approximate.GetParticleStore();
+  ASSERT_EQ(exact.Size(), approx.Size());
+  size_t sameGroup = 0;
+  for (size_t i = 0; i < exact.Size(); ++i) {
+    EXPECT_GE(approx.color[i].r, 0.0f);
+    EXPECT_LE(approx.color[i].r, 1.0f);
+    if (simulation->GetParticleGroup(i) == approximate.GetParticleGroup(i)) ++sameGroup;
+  }
+  EXPECT_GT(sameGroup, exact.Size() * 9 / 10);
+}
+
+TEST_F(LiquidSimulationTest, DensityPassSumsKernelWeightedMasses) {
+  // Far from the others: one particle alone, and a pair half a unit apart
+  const size_t alone = simulation->GetParticleCount();
+  simulation->AddParticle(glm::vec3(500.0f), glm::vec3(0.0f), glm::vec3(1.0f));
+  simulation->AddParticle(glm::vec3(-500.0f), glm::vec3(0.0f), glm::vec3(1.0f));
+  simulation->AddParticle(glm::vec3(-500.5f, -500.0f, -500.0f), glm::vec3(0.0f), glm::vec3(1.0f));
+  simulation->RunPhase(LiquidSimulation::Phase::NeighborSearch, 0.016f);
+  simulation->RunPhase(LiquidSimulation::Phase::Density, 0.016f);
+
+  const SphKernel kernel(2.0f);
+  const auto &store = simulation->GetParticleStore();
+  EXPECT_NEAR(simulation->GetDensity(alone), store.mass[alone] * kernel.Density(0.0f), 1e-6f);
+  EXPECT_NEAR(simulation->GetDensity(alone + 1),
+              store.mass[alone + 1] * kernel.Density(0.0f) + store.mass[alone + 2] * kernel.Density(0.25f), 1e-5f);
+  EXPECT_GE(simulation->GetPressure(alone), 0.0f);
+}
+
+TEST_F(LiquidSimulationTest, CompressedParticlesPushApart) {
+  // Beyond boid separation range; stiff enough to outweigh the boid pull
+  simulation->SetPressure(1000.0f, 0.0f);
+  simulation->SetViscosity(0.0f);
+  simulation->SetGravity(glm::vec3(0.0f));
+  const size_t first = simulation->GetParticleCount();
+  simulation->AddParticle(glm::vec3(500.0f), glm::vec3(0.0f), glm::vec3(1.0f));
+  simulation->AddParticle(glm::vec3(501.5f, 500.0f, 500.0f), glm::vec3(0.0f), glm::vec3(1.0f));
+  simulation->RunPhase(LiquidSimulation::Phase::NeighborSearch, 0.016f);
+  simulation->RunPhase(LiquidSimulation::Phase::Density, 0.016f);
+  simulation->RunPhase(LiquidSimulation::Phase::Forces, 0.016f);
+
+  const auto &store = simulation->GetParticleStore();
+  EXPECT_GT(simulation->GetPressure(first), 0.0f);
+  EXPECT_LT(store.vx[first], 0.0f);
+  EXPECT_GT(store.vx[first + 1], 0.0f);
+}
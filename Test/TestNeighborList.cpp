@@ -0,0 +1,98 @@
+#include "NeighborList.h"
+#include "SpatialGrid.h"
+#include <glm/glm.hpp>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+class NeighborListTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> x(-15.0f, 15.0f);
+    std::uniform_real_distribution<float> y(0.0f, 5.0f);
+    std::uniform_real_distribution<float> z(-10.0f, 10.0f);
+    for (int i = 0; i < 1000; ++i) {
+      points.emplace_back(x(gen), y(gen), z(gen));
+    }
+
+    auto positionOf = [this](size_t i) { return points[i]; };
+    grid.Build(points.size(), 5.0f, positionOf);
+    list.Build(grid, points.size(), 5.0f, 2.0f, positionOf);
+  }
+
+  std::vector<glm::vec3> points;
+  SpatialGrid grid;
+  NeighborList list;
+};
+
+TEST_F(NeighborListTest, EntryCountMatchesBruteForce) {
+  ASSERT_EQ(list.GetPointCount(), points.size());
+  for (size_t i = 0; i < points.size(); ++i) {
+    size_t expected = 0;
+    for (size_t j = 0; j < points.size(); ++j) {
+      if (j != i && glm::length(points[j] - points[i]) < 5.0f) ++expected;
+    }
+    EXPECT_EQ(list.GetEnd(i) - list.GetBegin(i), expected);
+  }
+}
+
+TEST_F(NeighborListTest, InnerEntriesComeFirstWithTheirDistances) {
+  size_t innerTotal = 0;
+  for (size_t i = 0; i < points.size(); ++i) {
+    ASSERT_LE(list.GetInnerEnd(i), list.GetEnd(i));
+    for (size_t n = list.GetBegin(i); n < list.GetEnd(i); ++n) {
+      size_t j = list.GetIndex(n);
+      float dist = glm::length(points[j] - points[i]);
+      EXPECT_NE(j, i);
+      EXPECT_LT(dist, 5.0f);
+      EXPECT_EQ(n < list.GetInnerEnd(i), dist < 2.0f);
+      if (n < list.GetInnerEnd(i)) {
+        EXPECT_FLOAT_EQ(list.GetDistance(i, n), dist);
+      }
+    }
+    innerTotal += list.GetInnerEnd(i) - list.GetBegin(i);
+  }
+  // Only the inner entries store a distance
+  EXPECT_EQ(list.GetInnerEntryCount(), innerTotal);
+  EXPECT_LT(innerTotal, list.GetEntryCount());
+}
+
+TEST_F(NeighborListTest, ParallelAndSteppedBuildsMatchSerial) {
+  auto positionOf = [this](size_t i) { return points[i]; };
+  NeighborList parallel;
+  parallel.Build(grid, points.size(), 5.0f, 2.0f, positionOf, 4);
+
+  // Ranges out of order, as a task graph might run them
+  NeighborList stepped;
+  stepped.Start(points.size(), 5.0f, 2.0f);
+  stepped.Count(grid, 500, points.size(), positionOf);
+  stepped.Count(grid, 0, 500, positionOf);
+  stepped.Allocate();
+  stepped.Fill(grid, 500, points.size(), positionOf);
+  stepped.Fill(grid, 0, 500, positionOf);
+
+  for (const NeighborList *other : {&parallel, &stepped}) {
+    ASSERT_EQ(other->GetEntryCount(), list.GetEntryCount());
+    for (size_t i = 0; i < points.size(); ++i) {
+      ASSERT_EQ(other->GetBegin(i), list.GetBegin(i));
+      ASSERT_EQ(other->GetInnerEnd(i), list.GetInnerEnd(i));
+    }
+    for (size_t n = 0; n < list.GetEntryCount(); ++n) {
+      EXPECT_EQ(other->GetIndex(n), list.GetIndex(n));
+    }
+  }
+}
+
+TEST_F(NeighborListTest, ListIsSymmetric) {
+  for (size_t i = 0; i < points.size(); i += 13) {
+    for (size_t n = list.GetBegin(i); n < list.GetEnd(i); ++n) {
+      size_t j = list.GetIndex(n);
+      bool found = false;
+      for (size_t m = list.GetBegin(j); m < list.GetEnd(j); ++m) {
+        found |= list.GetIndex(m) == i;
+      }
+      EXPECT_TRUE(found);
+    }
+  }
+}
@@ -0,0 +1,134 @@
+#include "PairKernel.h"
+#include <glm/glm.hpp>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+class PairKernelTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<float> pos(-4.0f, 4.0f);
+    std::uniform_real_distribution<float> vel(-3.0f, 3.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int i = 0; i < 203; ++i) {
+      x.push_back(pos(gen));
+      y.push_back(pos(gen));
+      z.push_back(pos(gen));
+      vx.push_back(vel(gen));
+      vy.push_back(vel(gen));
+      vz.push_back(vel(gen));
+      mass.push_back(0.5f + unit(gen));
+      radius.push_back(0.1f + 0.3f * unit(gen));
+      inverseDensity.push_back(1.0f / (0.2f + unit(gen)));
+      pressureRatio.push_back(2.0f * unit(gen));
+      for (int c = 0; c < 3; ++c) color.push_back(0.3f + 0.7f * unit(gen));
+    }
+    // Coincident with the subject: no direction, so excluded from forces
+    x[5] = y[5] = z[5] = 0.0f;
+
+    // Odd count so the SIMD tail is exercised; skips some indices
+    for (uint32_t i = 0; i < x.size(); i += (i % 3 == 0) ? 2 : 1) {
+      indices.push_back(i);
+    }
+    neighbors = {x.data(), y.data(), z.data(), vx.data(), vy.data(), vz.data(),
+                 mass.data(), radius.data(), color.data(), inverseDensity.data(), pressureRatio.data(),
+                 indices.data(), indices.size()};
+  }
+
+  static void ExpectNear(const glm::vec3 &a, const glm::vec3 &b) {
+    const float tolerance = 1e-3f * (1.0f + glm::length(a));
+    EXPECT_NEAR(a.x, b.x, tolerance);
+    EXPECT_NEAR(a.y, b.y, tolerance);
+    EXPECT_NEAR(a.z, b.z, tolerance);
+  }
+
+  std::vector<float> x, y, z, vx, vy, vz, mass, radius, color, inverseDensity, pressureRatio;
+  std::vector<uint32_t> indices;
+  PairNeighbors neighbors{};
+  PairSubject subject{glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, -0.5f), glm::vec3(0.8f, 0.4f, 0.6f), 1.0f, 0.2f, 1.5f};
+  PairKernelParams params{5.0f, SphKernel(2.0f)};
+};
+
+TEST_F(PairKernelTest, ScalarMatchesReferenceLoop) {
+  PairAccumulator acc;
+  EvaluatePairsScalar(subject, neighbors, params, acc);
+
+  // Textbook SPH forms: -sum m_j (p_i/rho_i^2 + p_j/rho_j^2) grad W and
+  // sum m_j (v_j - v_i) / rho_j lap W
+  const float h = params.smoothing.radius;
+  const float pi = SphKernel::Pi;
+  float totalWeight = 0.0f;
+  glm::vec3 pressureForce(0.0f), viscosity(0.0f);
+  for (uint32_t j : indices) {
+    glm::vec3 diff = glm::vec3(x[j], y[j], z[j]) - subject.position;
+    float dist = glm::length(diff);
+    float colorDist = glm::length(subject.color - glm::vec3(color[3 * j], color[3 * j + 1], color[3 * j + 2]));
+    if (dist < params.interactionRadius && dist > 0.001f) {
+      totalWeight += std::max(0.0f, 1.0f - colorDist / 3.0f);
+    }
+    if (dist < h && dist > 0.0001f) {
+      glm::vec3 gradW = -diff / dist * (-45.0f / (pi * std::pow(h, 6.0f)) * (h - dist) * (h - dist));
+      float shared = subject.pressureRatio + pressureRatio[j];
+      pressureForce -= mass[j] * shared * gradW;
+      glm::vec3 velDiff = glm::vec3(vx[j], vy[j], vz[j]) - subject.velocity;
+      viscosity += mass[j] * inverseDensity[j] * velDiff * (45.0f / (pi * std::pow(h, 6.0f)) * (h - dist));
+    }
+  }
+  EXPECT_NEAR(acc.totalWeight, totalWeight, 1e-4f);
+  ExpectNear(acc.pressure, pressureForce);
+  ExpectNear(acc.viscosity, viscosity);
+}
+
+TEST_F(PairKernelTest, PressureIsSymmetricAndRepulsive) {
+  // Two particles alone, each evaluated against the other
+  x = {0.5f, 0.0f};
+  y = {0.0f, 0.0f};
+  z = {0.0f, 0.0f};
+  mass = {1.0f, 1.0f};
+  inverseDensity = {1.0f, 1.0f};
+  pressureRatio = {subject.pressureRatio, subject.pressureRatio};
+  for (std::vector<float> *v : {&vx, &vy, &vz}) v->assign(2, 0.0f);
+  indices = {0};
+  neighbors = {x.data(), y.data(), z.data(), vx.data(), vy.data(), vz.data(),
+               mass.data(), radius.data(), color.data(), inverseDensity.data(), pressureRatio.data(),
+               indices.data(), 1};
+  subject.velocity = glm::vec3(0.0f);
+
+  PairAccumulator a, b;
+  EvaluatePairsScalar(subject, neighbors, params, a);
+  indices = {1};
+  subject.position = glm::vec3(0.5f, 0.0f, 0.0f);
+  EvaluatePairsScalar(subject, neighbors, params, b);
+
+  EXPECT_LT(a.pressure.x, 0.0f); // Pushed away from the neighbor
+  ExpectNear(a.pressure, -b.pressure);
+}
+
+TEST_F(PairKernelTest, SupportedVariantsMatchScalar) {
+  PairAccumulator expected;
+  EvaluatePairsScalar(subject, neighbors, params, expected);
+
+  for (PairKernelIsa isa : {PairKernelIsa::AVX2, PairKernelIsa::AVX512}) {
+    if (static_cast<int>(isa) > static_cast<int>(GetSupportedPairKernelIsa())) continue;
+    SCOPED_TRACE(GetPairKernelName(isa));
+
+    PairAccumulator acc;
+    GetPairKernel(isa)(subject, neighbors, params, acc);
+    ExpectNear(acc.separation, expected.separation);
+    ExpectNear(acc.alignment, expected.alignment);
+    ExpectNear(acc.cohesion, expected.cohesion);
+    ExpectNear(acc.pressure, expected.pressure);
+    ExpectNear(acc.viscosity, expected.viscosity);
+    EXPECT_NEAR(acc.totalWeight, expected.totalWeight, 1e-3f * (1.0f + expected.totalWeight));
+  }
+}
+
+TEST_F(PairKernelTest, EmptyNeighborhoodLeavesAccumulatorUntouched) {
+  neighbors.count = 0;
+  PairAccumulator acc;
+  GetPairKernel(GetSupportedPairKernelIsa())(subject, neighbors, params, acc);
+  EXPECT_EQ(acc.totalWeight, 0.0f);
+  EXPECT_EQ(glm::length(acc.pressure), 0.0f);
+  EXPECT_EQ(glm::length(acc.separation), 0.0f);
+}
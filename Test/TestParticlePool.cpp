@@ -0,0 +1,153 @@
+#include "LiquidSimulation.h"
+#include <glm/glm.hpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+class ParticlePoolTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    simulation = std::make_unique<LiquidSimulation>(100.0f, 100.0f, 3);
+  }
+
+  static ParticleInit MakeInit(float x, float lifetime = 0.0f) {
+    return {glm::vec3(x, 5.0f, 0.0f), glm::vec3(0.0f), glm::vec3(0.5f), lifetime};
+  }
+
+  std::unique_ptr<LiquidSimulation> simulation;
+};
+
+TEST_F(ParticlePoolTest, DespawnLeavesAHoleThatSpawnReuses) {
+  const size_t size = simulation->GetParticleCount();
+  ASSERT_GT(size, 4u);
+  simulation->Despawn(3);
+  EXPECT_FALSE(simulation->IsAlive(3));
+  EXPECT_EQ(simulation->GetParticleCount(), size);
+  EXPECT_EQ(simulation->GetLiveCount(), size - 1);
+
+  simulation->Despawn(3); // Already free: ignored
+  EXPECT_EQ(simulation->GetLiveCount(), size - 1);
+
+  EXPECT_EQ(simulation->Spawn(MakeInit(42.0f)), 3u);
+  EXPECT_TRUE(simulation->IsAlive(3));
+  EXPECT_EQ(simulation->GetParticleStore().x[3], 42.0f);
+  EXPECT_EQ(simulation->GetParticleCount(), size);
+  EXPECT_EQ(simulation->Spawn(MakeInit(43.0f)), size); // No holes left: appends
+}
+
+TEST_F(ParticlePoolTest, CompactKeepsLiveParticlesContiguous) {
+  const ParticleStore &store = simulation->GetParticleStore();
+  const size_t size = simulation->GetParticleCount();
+  std::vector<float> expected;
+  for (size_t i = 0; i < size; ++i) {
+    if (i != 0 && i != 2 && i != size - 1) expected.push_back(store.x[i]);
+  }
+  simulation->Despawn(2);
+  simulation->Despawn(size - 1);
+  simulation->Despawn(0);
+
+  simulation->Compact();
+  ASSERT_EQ(simulation->GetParticleCount(), size - 3);
+  EXPECT_EQ(simulation->GetLiveCount(), size - 3);
+  std::vector<float> actual(store.x.begin(), store.x.end());
+  for (size_t i = 0; i < actual.size(); ++i) EXPECT_TRUE(simulation->IsAlive(i));
+  std::sort(expected.begin(), expected.end());
+  std::sort(actual.begin(), actual.end());
+  EXPECT_EQ(actual, expected);
+
+  // Only particles from past the new end moved, each into a hole
+  const auto &log = simulation->GetLastCompaction();
+  EXPECT_EQ(log.size, size - 3);
+  EXPECT_EQ(log.moves.size(), 2u);
+  for (const auto &move : log.moves) {
+    EXPECT_GE(move.from, size - 3);
+    EXPECT_LT(move.to, size - 3);
+  }
+}
+
+TEST_F(ParticlePoolTest, LifetimesExpireDuringUpdate) {
+  const size_t size = simulation->GetParticleCount();
+  const size_t index = simulation->Spawn(MakeInit(50.0f, 0.05f));
+  EXPECT_TRUE(std::isfinite(simulation->GetParticleStore().expireTime[index]));
+
+  simulation->Update(0.02f);
+  simulation->Update(0.02f);
+  EXPECT_EQ(simulation->GetParticleCount(), size + 1);
+  simulation->Update(0.02f);
+  EXPECT_EQ(simulation->GetParticleCount(), size);
+  EXPECT_EQ(simulation->GetLiveCount(), size);
+}
+
+TEST_F(ParticlePoolTest, LifetimesFollowParticlesThroughCompactionAndReuse) {
+  // Particles are told apart by mass, which Update never changes
+  const ParticleStore &store = simulation->GetParticleStore();
+  auto isPresent = [&](float mass) {
+    for (size_t i = 0; i < store.Size(); ++i) {
+      if (store.mass[i] == mass && simulation->IsAlive(i)) return true;
+    }
+    return false;
+  };
+  const size_t size = simulation->GetParticleCount();
+  // The mortal particle sits last, so compaction moves it into the hole
+  const float mortal = store.mass[simulation->Spawn(MakeInit(50.0f, 0.1f))];
+  simulation->Despawn(1);
+  simulation->Update(0.02f);
+  ASSERT_EQ(simulation->GetParticleCount(), size);
+  EXPECT_EQ(store.mass[1], mortal);
+
+  // A slot reused by an immortal particle ignores the old lifetime
+  const size_t reused = simulation->Spawn(MakeInit(60.0f, 0.03f));
+  simulation->Despawn(reused);
+  ASSERT_EQ(simulation->Spawn(MakeInit(61.0f)), reused);
+  const float immortal = store.mass[reused];
+  for (int step = 0; step < 5; ++step) simulation->Update(0.02f);
+  EXPECT_FALSE(isPresent(mortal));
+  EXPECT_TRUE(isPresent(immortal));
+  EXPECT_EQ(simulation->GetLiveCount(), size);
+}
+
+TEST_F(ParticlePoolTest, EmitterReachesSteadyState) {
+  const size_t size = simulation->GetParticleCount();
+  // 60 particles/s living 0.5 s each: about 30 alive at any time
+  simulation->SetEmitter(60.0f, 0.5f, 0);
+  size_t peak = 0;
+  for (int step = 0; step < 90; ++step) {
+    simulation->Update(1.0f / 60.0f);
+    if (step >= 45) peak = std::max(peak, simulation->GetParticleCount());
+  }
+  EXPECT_GE(simulation->GetParticleCount(), size + 25);
+  EXPECT_LE(peak, size + 32);
+  EXPECT_EQ(simulation->GetLiveCount(), simulation->GetParticleCount());
+}
+
+TEST_F(ParticlePoolTest, EmitterSpawnsAboveAGroupsMeanPosition) {
+  std::vector<glm::vec3> means;
+  for (const GroupStats &stats : simulation->GetGroupStats()) {
+    if (stats.count) means.push_back(stats.GetMeanPosition());
+  }
+  ASSERT_FALSE(means.empty());
+  const size_t size = simulation->GetParticleCount();
+  simulation->SetEmitter(600.0f, 0.0f, 0);
+  simulation->Update(1.0f / 60.0f);
+  ASSERT_GT(simulation->GetParticleCount(), size);
+
+  // Within the spawn offset of some group's mean, less one step of motion
+  const ParticleStore &store = simulation->GetParticleStore();
+  for (size_t i = size; i < store.Size(); ++i) {
+    const glm::vec3 position = store.GetPosition(i);
+    const bool nearGroup = std::any_of(means.begin(), means.end(), [&](const glm::vec3 &mean) {
+      const glm::vec3 offset = position - mean;
+      return std::abs(offset.x) < 3.0f && std::abs(offset.z) < 3.0f && std::abs(offset.y - 3.5f) < 0.5f;
+    });
+    EXPECT_TRUE(nearGroup) << i;
+  }
+}
+
+TEST_F(ParticlePoolTest, EmitterStopsAtTheCap) {
+  const size_t cap = simulation->GetParticleCount() + 5;
+  simulation->SetEmitter(600.0f, 0.0f, cap);
+  for (int step = 0; step < 10; ++step) {
+    simulation->Update(1.0f / 60.0f);
+  }
+  EXPECT_EQ(simulation->GetLiveCount(), cap);
+}
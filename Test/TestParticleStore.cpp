@@ -0,0 +1,75 @@
+#include "LiquidSimulation.h"
+#include "ParticleStore.h"
+#include <glm/glm.hpp>
+#include <gtest/gtest.h>
+
+class ParticleStoreTest : public ::testing::Test {
+protected:
+  LiquidParticle MakeParticle(float seed) {
+    LiquidParticle p;
+    p.position = glm::vec3(seed, seed + 1.0f, seed + 2.0f);
+    p.velocity = glm::vec3(-seed, 0.5f, 0.25f);
+    p.color = glm::vec3(0.2f, 0.4f, 0.6f);
+    p.targetColor = glm::vec3(0.6f, 0.4f, 0.2f);
+    p.radius = 0.5f;
+    p.baseRadius = 0.5f;
+    p.mass = 0.75f;
+    p.colorTransitionSpeed = 3.0f;
+    p.wavePhase = 1.0f;
+    p.waveAmplitude = 0.1f;
+    p.waveDecay = 0.9f;
+    return p;
+  }
+
+  ParticleStore store;
+};
+
+TEST_F(ParticleStoreTest, AddThenGetRoundTrips) {
+  store.Add(MakeParticle(1.0f));
+  store.Add(MakeParticle(2.0f));
+  ASSERT_EQ(store.Size(), 2);
+
+  LiquidParticle p = store.Get(1);
+  EXPECT_EQ(p.position, glm::vec3(2.0f, 3.0f, 4.0f));
+  EXPECT_EQ(p.velocity, glm::vec3(-2.0f, 0.5f, 0.25f));
+  EXPECT_EQ(p.targetColor, glm::vec3(0.6f, 0.4f, 0.2f));
+  EXPECT_FLOAT_EQ(p.mass, 0.75f);
+  EXPECT_FLOAT_EQ(p.waveDecay, 0.9f);
+}
+
+TEST_F(ParticleStoreTest, ResizeAndMoveKeepEveryArrayInStep) {
+  for (int i = 0; i < 4; ++i) store.Add(MakeParticle(static_cast<float>(i)));
+  store.Resize(6);
+  for (size_t size : {store.y.size(), store.z.size(), store.vx.size(), store.vy.size(),
+                      store.vz.size(), store.mass.size(), store.radius.size(), store.color.size(),
+                      store.targetColor.size(), store.colorTransitionSpeed.size(),
+                      store.baseRadius.size(), store.wavePhase.size(), store.waveAmplitude.size(),
+                      store.waveDecay.size(), store.expireTime.size()}) {
+    EXPECT_EQ(size, 6u);
+  }
+  EXPECT_EQ(store.GetPosition(5), glm::vec3(0.0f));
+  EXPECT_EQ(store.waveDecay[5], 0.0f);
+
+  // Every field moves, cold ones included
+  store.Move(2, 5);
+  const LiquidParticle from = store.Get(2), to = store.Get(5);
+  EXPECT_EQ(to.position, from.position);
+  EXPECT_EQ(to.velocity, from.velocity);
+  EXPECT_EQ(to.targetColor, from.targetColor);
+  EXPECT_EQ(to.colorTransitionSpeed, from.colorTransitionSpeed);
+  EXPECT_EQ(to.waveDecay, from.waveDecay);
+  EXPECT_EQ(to.expireTime, from.expireTime);
+}
+
+TEST_F(ParticleStoreTest, SimulationViewMatchesStoreAfterUpdate) {
+  LiquidSimulation simulation(100.0f, 100.0f);
+  simulation.Update(0.016f);
+
+  const auto &view = simulation.GetParticles();
+  const auto &soa = simulation.GetParticleStore();
+  ASSERT_EQ(view.size(), soa.Size());
+  for (size_t i = 0; i < view.size(); ++i) {
+    EXPECT_EQ(view[i].position, soa.GetPosition(i));
+    EXPECT_EQ(view[i].color, soa.color[i]);
+  }
+}
@@ -0,0 +1,103 @@
+#include "LiquidSimulation.h"
+#include "SignedDistanceField.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+class SignedDistanceFieldTest : public ::testing::Test {
+protected:
+  // Closed box, open over [-4, 4] x [0, 2] x [-3, 3]
+  static std::vector<Wall> Container() {
+    return {Wall(glm::vec3(-4.5f, 1.0f, 0.0f), glm::vec3(1.0f, 4.0f, 8.0f)),
+            Wall(glm::vec3(4.5f, 1.0f, 0.0f), glm::vec3(1.0f, 4.0f, 8.0f)),
+            Wall(glm::vec3(0.0f, 1.0f, -3.5f), glm::vec3(10.0f, 4.0f, 1.0f)),
+            Wall(glm::vec3(0.0f, 1.0f, 3.5f), glm::vec3(10.0f, 4.0f, 1.0f)),
+            Wall(glm::vec3(0.0f, -0.05f, 0.0f), glm::vec3(10.0f, 0.1f, 8.0f)),
+            Wall(glm::vec3(0.0f, 2.05f, 0.0f), glm::vec3(10.0f, 0.1f, 8.0f))};
+  }
+};
+
+TEST_F(SignedDistanceFieldTest, MeasuresDistanceToTheNearestWall) {
+  SignedDistanceField field;
+  field.Bake(Container(), 0.25f);
+  ASSERT_FALSE(field.IsEmpty());
+
+  glm::vec3 gradient;
+  EXPECT_NEAR(field.Sample(glm::vec3(3.0f, 1.0f, 0.0f), gradient), 1.0f, 0.05f);
+  EXPECT_NEAR(gradient.x, -1.0f, 0.05f);
+  EXPECT_NEAR(field.Sample(glm::vec3(0.0f, 0.5f, 0.0f), gradient), 0.5f, 0.05f);
+  EXPECT_NEAR(gradient.y, 1.0f, 0.05f);
+  EXPECT_NEAR(field.Sample(glm::vec3(-1.0f, 1.5f, 2.0f), gradient), 0.5f, 0.05f);
+}
+
+TEST_F(SignedDistanceFieldTest, ThinWallsSealTheContainer) {
+  SignedDistanceField field;
+  field.Bake(Container(), 0.25f);
+
+  // Below the 0.1-thick floor counts as outside, and leads back up
+  glm::vec3 gradient;
+  EXPECT_LT(field.Sample(glm::vec3(0.0f, -0.3f, 0.0f), gradient), 0.0f);
+  EXPECT_GT(gradient.y, 0.0f);
+}
+
+TEST_F(SignedDistanceFieldTest, PointsOutsideTheGridLeadBackIn) {
+  SignedDistanceField field;
+  field.Bake(Container(), 0.25f);
+
+  glm::vec3 gradient;
+  EXPECT_LT(field.Sample(glm::vec3(100.0f, 1.0f, 0.0f), gradient), -90.0f);
+  EXPECT_NEAR(gradient.x, -1.0f, 1e-5f);
+}
+
+TEST_F(SignedDistanceFieldTest, BatchesMatchSinglePoints) {
+  SignedDistanceField field;
+  field.Bake(Container(), 0.25f);
+
+  // Open space, walls and points beyond the grid, in one batch
+  std::vector<float> x, y, z;
+  for (float px = -7.0f; px <= 7.0f; px += 0.7f) {
+    for (float py = -2.0f; py <= 4.0f; py += 0.9f) {
+      x.push_back(px);
+      y.push_back(py);
+      z.push_back(px * 0.6f - py);
+    }
+  }
+  const size_t count = x.size();
+  std::vector<float> distance(count), gradientX(count), gradientY(count), gradientZ(count);
+  field.SampleBatch(x.data(), y.data(), z.data(), count, distance.data(), gradientX.data(),
+                    gradientY.data(), gradientZ.data());
+  for (size_t i = 0; i < count; ++i) {
+    glm::vec3 gradient;
+    EXPECT_EQ(distance[i], field.Sample(glm::vec3(x[i], y[i], z[i]), gradient));
+    EXPECT_EQ(gradientX[i], gradient.x);
+    EXPECT_EQ(gradientY[i], gradient.y);
+    EXPECT_EQ(gradientZ[i], gradient.z);
+  }
+}
+
+TEST_F(SignedDistanceFieldTest, BoxesEnclosingNothingAreObstacles) {
+  SignedDistanceField field;
+  field.Bake({Wall(glm::vec3(0.0f), glm::vec3(2.0f))}, 0.25f);
+
+  glm::vec3 gradient;
+  EXPECT_NEAR(field.Sample(glm::vec3(2.0f, 0.0f, 0.0f), gradient), 1.0f, 0.05f);
+  EXPECT_NEAR(gradient.x, 1.0f, 0.05f);
+  EXPECT_LT(field.Sample(glm::vec3(0.0f), gradient), 0.0f);
+}
+
+TEST_F(SignedDistanceFieldTest, SimulationKeepsParticlesInsideTheWalls) {
+  LiquidSimulation simulation(100.0f, 100.0f, 3);
+  simulation.AddObstacle(glm::vec3(0.0f, 2.5f, 0.0f), glm::vec3(4.0f, 5.0f, 4.0f));
+  const size_t stray = simulation.GetParticleCount();
+  simulation.AddParticle(glm::vec3(100.0f, 2.0f, 0.0f), glm::vec3(5.0f, 0.0f, 0.0f), glm::vec3(1.0f));
+  simulation.AddParticle(glm::vec3(0.5f, 2.0f, 0.0f), glm::vec3(0.0f), glm::vec3(1.0f));
+
+  simulation.RunPhase(LiquidSimulation::Phase::WallCollisions, 0.016f);
+  const ParticleStore &store = simulation.GetParticleStore();
+  for (size_t i = stray; i < stray + 2; ++i) {
+    glm::vec3 gradient;
+    EXPECT_GE(simulation.GetWallField().Sample(store.GetPosition(i), gradient), store.radius[i] - 0.1f);
+  }
+  EXPECT_LT(store.x[stray], 50.0f);
+  EXPECT_LT(store.vx[stray], 0.0f);
+  EXPECT_GT(std::abs(store.x[stray + 1]), 2.0f);
+}
@@ -0,0 +1,81 @@
+#include "LiquidSimulation.h"
+#include "SimulationStepper.h"
+#include <glm/glm.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+
+class SimulationStepperTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    simulation = std::make_unique<LiquidSimulation>(100.0f, 100.0f);
+    stepper = std::make_unique<SimulationStepper>(*simulation, 0.01f, 4);
+  }
+
+  std::unique_ptr<LiquidSimulation> simulation;
+  std::unique_ptr<SimulationStepper> stepper;
+};
+
+TEST_F(SimulationStepperTest, AccumulatesPartialFrames) {
+  EXPECT_EQ(stepper->Advance(0.004f), 0);
+  EXPECT_NEAR(stepper->GetAlpha(), 0.4f, 1e-4f);
+  EXPECT_EQ(stepper->Advance(0.004f), 0);
+  EXPECT_EQ(stepper->Advance(0.004f), 1);
+  EXPECT_NEAR(stepper->GetAlpha(), 0.2f, 1e-3f);
+}
+
+TEST_F(SimulationStepperTest, StepCountFollowsFrameTime) {
+  EXPECT_EQ(stepper->Advance(0.035f), 3);
+  EXPECT_NEAR(stepper->GetAlpha(), 0.5f, 1e-3f);
+  EXPECT_EQ(stepper->GetDroppedTime(), 0.0);
+}
+
+TEST_F(SimulationStepperTest, SlowFramesAreCappedAndDropped) {
+  EXPECT_EQ(stepper->Advance(1.0f), 4);
+  EXPECT_NEAR(stepper->GetDroppedTime(), 0.96, 1e-3);
+  EXPECT_LT(stepper->GetAlpha(), 1.0f);
+}
+
+TEST_F(SimulationStepperTest, InvalidFrameTimesAreIgnored) {
+  EXPECT_EQ(stepper->Advance(-1.0f), 0);
+  EXPECT_EQ(stepper->Advance(std::nanf("")), 0);
+  EXPECT_EQ(stepper->GetAlpha(), 0.0f);
+}
+
+TEST_F(SimulationStepperTest, InterpolatesBetweenLastTwoStates) {
+  const auto &store = simulation->GetParticleStore();
+  stepper->Advance(0.01f);
+  std::vector<glm::vec3> before;
+  for (size_t i = 0; i < store.Size(); ++i) before.push_back(store.GetPosition(i));
+
+  stepper->Advance(0.015f); // One step plus half a step
+  ASSERT_NEAR(stepper->GetAlpha(), 0.5f, 1e-3f);
+  for (size_t i = 0; i < store.Size(); ++i) {
+    glm::vec3 expected = glm::mix(before[i], store.GetPosition(i), stepper->GetAlpha());
+    glm::vec3 actual = stepper->GetInterpolatedPosition(i);
+    EXPECT_NEAR(actual.x, expected.x, 1e-4f);
+    EXPECT_NEAR(actual.y, expected.y, 1e-4f);
+    EXPECT_NEAR(actual.z, expected.z, 1e-4f);
+  }
+}
+
+TEST_F(SimulationStepperTest, NewParticlesUseCurrentPosition) {
+  stepper->Advance(0.015f);
+  simulation->AddParticle(glm::vec3(1.0f, 2.0f, 3.0f), glm::vec3(0.0f), glm::vec3(1.0f));
+  glm::vec3 position = stepper->GetInterpolatedPosition(simulation->GetParticleCount() - 1);
+  EXPECT_EQ(position, glm::vec3(1.0f, 2.0f, 3.0f));
+}
+
+TEST_F(SimulationStepperTest, InterpolationFollowsCompaction) {
+  const size_t last = simulation->GetParticleCount() - 1;
+  const glm::vec3 before = simulation->GetParticleStore().GetPosition(last);
+  simulation->Despawn(1); // The last particle moves into slot 1
+
+  stepper->Advance(0.015f);
+  ASSERT_EQ(simulation->GetParticleCount(), last);
+  const glm::vec3 current = simulation->GetParticleStore().GetPosition(1);
+  const glm::vec3 expected = glm::mix(before, current, stepper->GetAlpha());
+  const glm::vec3 actual = stepper->GetInterpolatedPosition(1);
+  EXPECT_NEAR(actual.x, expected.x, 1e-5f);
+  EXPECT_NEAR(actual.y, expected.y, 1e-5f);
+  EXPECT_NEAR(actual.z, expected.z, 1e-5f);
+}
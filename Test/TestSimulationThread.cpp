@@ -0,0 +1,126 @@
+#include "LiquidSimulation.h"
+#include "SimulationStepper.h"
+#include "SimulationThread.h"
+#include "TripleBuffer.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(TripleBufferTest, ReaderGetsTheLatestValue) {
+  TripleBuffer<int> buffer;
+  EXPECT_FALSE(buffer.Acquire());
+
+  buffer.GetBack() = 1;
+  buffer.Publish();
+  buffer.GetBack() = 2;
+  buffer.Publish();
+  EXPECT_TRUE(buffer.Acquire());
+  EXPECT_EQ(buffer.GetFront(), 2);
+
+  // Nothing new: the front stays put
+  EXPECT_FALSE(buffer.Acquire());
+  EXPECT_EQ(buffer.GetFront(), 2);
+}
+
+TEST(TripleBufferTest, ValuesArriveWholeAndInOrder) {
+  constexpr int Count = 20000;
+  TripleBuffer<std::vector<int>> buffer;
+  std::thread writer([&] {
+    for (int value = 1; value <= Count; ++value) {
+      buffer.GetBack().assign(64, value);
+      buffer.Publish();
+    }
+  });
+
+  int last = 0;
+  bool torn = false;
+  while (last < Count) {
+    if (!buffer.Acquire()) {
+      std::this_thread::yield();
+      continue;
+    }
+    const std::vector<int> &values = buffer.GetFront();
+    for (int value : values) torn |= value != values.front();
+    EXPECT_GT(values.front(), last);
+    last = values.front();
+  }
+  writer.join();
+  EXPECT_FALSE(torn);
+}
+
+class SimulationThreadTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    simulation = std::make_unique<LiquidSimulation>(100.0f, 100.0f, 9);
+    std::vector<ParticleInit> inits;
+    for (int i = 0; i < 500; ++i) {
+      inits.push_back({glm::vec3(i % 50 - 25.0f, 5.0f + i / 50, 0.0f), glm::vec3(0.0f), glm::vec3(0.2f, 0.6f, 1.0f)});
+    }
+    simulation->AddParticles(inits);
+    stepper = std::make_unique<SimulationStepper>(*simulation, 0.005f, 4);
+  }
+
+  // Polls until `done` holds or a generous deadline passes
+  template <typename Predicate>
+  static bool WaitFor(Predicate done) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!done()) {
+      if (std::chrono::steady_clock::now() > deadline) return false;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+  }
+
+  std::unique_ptr<LiquidSimulation> simulation;
+  std::unique_ptr<SimulationStepper> stepper;
+};
+
+TEST_F(SimulationThreadTest, StartPublishesTheCurrentState) {
+  const size_t count = simulation->GetParticleCount();
+  SimulationThread thread(*stepper);
+  thread.Start();
+  const TrajectoryFrame &frame = thread.AcquireFrame();
+  ASSERT_EQ(frame.Size(), count);
+  EXPECT_EQ(frame.sequence, 0u);
+  thread.Stop();
+  EXPECT_FALSE(thread.IsRunning());
+}
+
+TEST_F(SimulationThreadTest, StepsAndPublishesInTheBackground) {
+  SimulationThread thread(*stepper);
+  int callbackSteps = 0;
+  thread.SetStepCallback([&](LiquidSimulation &, int steps) { callbackSteps += steps; });
+  thread.Start();
+  ASSERT_TRUE(WaitFor([&] { return thread.GetPublishedCount() >= 5; }));
+  thread.Stop();
+
+  // Stopped: everything published is visible and the simulation is ours
+  const TrajectoryFrame &frame = thread.AcquireFrame();
+  EXPECT_EQ(frame.sequence + 1, thread.GetPublishedCount());
+  EXPECT_GT(frame.time, 0.0);
+  EXPECT_DOUBLE_EQ(frame.time, simulation->GetTime());
+  EXPECT_NEAR(simulation->GetTime(), callbackSteps * 0.005, 1e-6);
+  ASSERT_EQ(frame.Size(), simulation->GetParticleCount());
+  for (size_t i = 0; i < frame.Size(); ++i) {
+    const glm::vec3 expected = stepper->GetInterpolatedPosition(i);
+    ASSERT_EQ(glm::vec3(frame.x[i], frame.y[i], frame.z[i]), expected);
+  }
+}
+
+TEST_F(SimulationThreadTest, FailuresSurfaceOnTheCallingThread) {
+  SimulationThread thread(*stepper);
+  thread.SetStepCallback([](LiquidSimulation &, int) { throw std::runtime_error("step failed"); });
+  thread.Start();
+  ASSERT_TRUE(WaitFor([&] {
+    try {
+      thread.RethrowIfFailed();
+    } catch (const std::runtime_error &) {
+      return true;
+    }
+    return false;
+  }));
+  thread.Stop();
+  EXPECT_NO_THROW(thread.RethrowIfFailed()); // Rethrown once
+}
@@ -0,0 +1,87 @@
+#include "SpatialGrid.h"
+#include <glm/glm.hpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+class SpatialGridTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<float> x(-15.0f, 15.0f);
+    std::uniform_real_distribution<float> y(0.0f, 5.0f);
+    std::uniform_real_distribution<float> z(-10.0f, 10.0f);
+    for (int i = 0; i < 2000; ++i) {
+      points.emplace_back(x(gen), y(gen), z(gen));
+    }
+  }
+
+  void BuildGrid(float cellSize) {
+    grid.Build(points.size(), cellSize,
+               [this](size_t i) { return points[i]; });
+  }
+
+  std::vector<size_t> GridNeighbors(size_t i, float radius) const {
+    std::vector<size_t> result;
+    grid.ForEachCandidate(points[i], radius, [&](size_t j) {
+      if (j != i && glm::length(points[j] - points[i]) < radius) {
+        result.push_back(j);
+      }
+    });
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+
+  std::vector<size_t> BruteForceNeighbors(size_t i, float radius) const {
+    std::vector<size_t> result;
+    for (size_t j = 0; j < points.size(); ++j) {
+      if (j != i && glm::length(points[j] - points[i]) < radius) {
+        result.push_back(j);
+      }
+    }
+    return result;
+  }
+
+  std::vector<glm::vec3> points;
+  SpatialGrid grid;
+};
+
+TEST_F(SpatialGridTest, SortedIndicesArePermutation) {
+  BuildGrid(5.0f);
+  std::vector<uint32_t> sorted = grid.GetSortedIndices();
+  ASSERT_EQ(sorted.size(), points.size());
+  std::sort(sorted.begin(), sorted.end());
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    EXPECT_EQ(sorted[i], i);
+  }
+}
+
+TEST_F(SpatialGridTest, NeighborsMatchBruteForce) {
+  BuildGrid(5.0f);
+  for (size_t i = 0; i < points.size(); i += 7) {
+    EXPECT_EQ(GridNeighbors(i, 5.0f), BruteForceNeighbors(i, 5.0f));
+  }
+}
+
+TEST_F(SpatialGridTest, RadiusLargerThanCellMatchesBruteForce) {
+  BuildGrid(2.0f);
+  for (size_t i = 0; i < points.size(); i += 31) {
+    EXPECT_EQ(GridNeighbors(i, 5.0f), BruteForceNeighbors(i, 5.0f));
+  }
+}
+
+TEST_F(SpatialGridTest, WidelySpreadPointsStayWithinCellBudget) {
+  points.emplace_back(1.0e6f, -1.0e6f, 1.0e6f);
+  BuildGrid(0.5f);
+  EXPECT_LE(grid.GetCellCount(), SpatialGrid::MaxCells);
+  EXPECT_EQ(GridNeighbors(0, 2.0f), BruteForceNeighbors(0, 2.0f));
+}
+
+TEST_F(SpatialGridTest, EmptyGridVisitsNothing) {
+  points.clear();
+  BuildGrid(5.0f);
+  int visited = 0;
+  grid.ForEachCandidate(glm::vec3(0.0f), 5.0f, [&](size_t) { ++visited; });
+  EXPECT_EQ(visited, 0);
+}
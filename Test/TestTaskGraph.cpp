@@ -0,0 +1,198 @@
+#include "LiquidSimulation.h"
+#include "TaskGraph.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <omp.h>
+
+class TaskGraphTest : public ::testing::Test {
+protected:
+  static constexpr size_t Chunks = 16;
+  static constexpr int Threads = 4;
+};
+
+TEST_F(TaskGraphTest, TasksWaitForTheirDependencies) {
+  for (int run = 0; run < 20; ++run) {
+    TaskGraph graph;
+    std::atomic<bool> first = false;
+    std::vector<std::atomic<int>> stage(Chunks);
+    std::atomic<int> violations = 0;
+    std::atomic<int> lastRan = 0;
+
+    const TaskGraph::Task a = graph.Add("A", [&] { first = true; });
+    const TaskGraph::Task b = graph.AddChunked("B", Chunks, [&](size_t chunk) {
+      violations += !first;
+      stage[chunk] = 1;
+    }, {a});
+    // Chunk by chunk: chunk k of C only needs chunk k of B
+    const TaskGraph::Task c = graph.AddChunked("C", Chunks, [&](size_t chunk) {
+      violations += stage[chunk] != 1;
+      stage[chunk] = 2;
+    }, {}, {b});
+    graph.Add("D", [&] {
+      for (size_t chunk = 0; chunk < Chunks; ++chunk) violations += stage[chunk] != 2;
+      lastRan = 1;
+    }, {c});
+    graph.Run(Threads);
+
+    EXPECT_EQ(violations, 0);
+    EXPECT_EQ(lastRan, 1);
+  }
+}
+
+TEST_F(TaskGraphTest, EveryItemRunsOnce) {
+  // A dependent task listed after many roots gets released while the
+  // roots are still being spawned
+  constexpr size_t Fillers = 1000;
+  for (int run = 0; run < 20; ++run) {
+    TaskGraph graph;
+    std::vector<std::atomic<int>> runs(Fillers + 2 + Chunks);
+    const TaskGraph::Task a = graph.Add("A", [&] { ++runs[0]; });
+    for (size_t f = 0; f < Fillers; ++f) {
+      graph.Add("Filler", [&, f] {
+        ++runs[1 + f];
+        std::this_thread::sleep_for(std::chrono::microseconds(20));
+      });
+    }
+    graph.Add("B", [&] { ++runs[Fillers + 1]; }, {a});
+    graph.AddChunked("C", Chunks, [&](size_t chunk) { ++runs[Fillers + 2 + chunk]; }, {a});
+    graph.Run(Threads);
+
+    for (size_t item = 0; item < runs.size(); ++item) {
+      ASSERT_EQ(runs[item], 1) << "item " << item << ", run " << run;
+    }
+  }
+}
+
+TEST_F(TaskGraphTest, ExclusiveTasksRunAloneWithTheirOwnThreads) {
+  TaskGraph graph;
+  std::atomic<int> before = 0, after = 0;
+  int beforeSeen = -1, afterSeen = -1, teamSize = 0;
+  graph.AddChunked("Before", Chunks, [&](size_t) { ++before; });
+  graph.AddExclusive("Exclusive", [&] {
+    beforeSeen = before;
+    afterSeen = after;
+    #pragma omp parallel num_threads(Threads)
+    {
+      #pragma omp single
+      teamSize = omp_get_num_threads();
+    }
+  });
+  graph.AddChunked("After", Chunks, [&](size_t) { ++after; });
+  graph.Run(Threads);
+
+  EXPECT_EQ(beforeSeen, static_cast<int>(Chunks));
+  EXPECT_EQ(afterSeen, 0);
+  EXPECT_EQ(after, static_cast<int>(Chunks));
+  EXPECT_EQ(teamSize, Threads);
+}
+
+TEST_F(TaskGraphTest, EmptyAndMismatchedTasksStillOrderTheirSuccessors) {
+  TaskGraph graph;
+  std::atomic<int> done = 0;
+  int seenByLast = -1, seenByWide = -1;
+  const TaskGraph::Task work = graph.AddChunked("Work", Chunks, [&](size_t) { ++done; });
+  const TaskGraph::Task empty = graph.AddChunked("Empty", 0, [](size_t) { FAIL(); }, {work});
+  graph.Add("Last", [&] { seenByLast = done; }, {empty});
+  // Different chunk counts can't line up, so this waits for all of Work
+  graph.AddChunked("Wide", 1, [&](size_t) { seenByWide = done; }, {}, {work});
+  graph.Run(Threads);
+
+  EXPECT_EQ(seenByLast, static_cast<int>(Chunks));
+  EXPECT_EQ(seenByWide, static_cast<int>(Chunks));
+}
+
+TEST_F(TaskGraphTest, OrderingFollowsDependenciesAndExclusiveTasks) {
+  TaskGraph graph;
+  const TaskGraph::Task a = graph.Add("A", [] {});
+  const TaskGraph::Task b = graph.AddChunked("B", Chunks, [](size_t) {}, {a});
+  const TaskGraph::Task c = graph.AddChunked("C", Chunks, [](size_t) {}, {}, {b});
+  const TaskGraph::Task d = graph.Add("D", [] {});
+  graph.AddExclusive("E", [] {});
+  const TaskGraph::Task f = graph.Add("F", [] {});
+
+  EXPECT_EQ(graph.Find("C"), c);
+  EXPECT_EQ(graph.Find("Missing"), graph.GetTaskCount());
+  EXPECT_TRUE(graph.IsOrderedAfter(c, a));
+  EXPECT_FALSE(graph.IsOrderedAfter(c, b)); // Chunk by chunk only
+  EXPECT_FALSE(graph.IsOrderedAfter(d, a));
+  EXPECT_FALSE(graph.IsOrderedAfter(a, d));
+  EXPECT_TRUE(graph.IsOrderedAfter(f, d));
+}
+
+TEST_F(TaskGraphTest, ClearedGraphsCanBeRebuilt) {
+  TaskGraph graph;
+  int sum = 0;
+  for (int run = 1; run <= 3; ++run) {
+    graph.Clear();
+    std::atomic<int> total = 0;
+    const TaskGraph::Task parts = graph.AddChunked("Parts", run * 5, [&](size_t chunk) { total += chunk; });
+    graph.Add("Sum", [&] { sum = total; }, {parts});
+    graph.Run(Threads);
+    EXPECT_EQ(graph.GetTaskCount(), 2u);
+    EXPECT_EQ(sum, run * 5 * (run * 5 - 1) / 2);
+  }
+}
+
+// The graph lets phases and chunks overlap, but every particle must see
+// exactly what it would with the phases run in order
+TEST_F(TaskGraphTest, SimulationMatchesPhasesRunInOrder) {
+  LiquidSimulation graphed(100.0f, 100.0f, 17);
+  LiquidSimulation ordered(100.0f, 100.0f, 17);
+  ordered.SetTaskGraphEnabled(false);
+  for (LiquidSimulation *simulation : {&graphed, &ordered}) {
+    simulation->SetThreadCount(Threads);
+    simulation->SetEmitter(200.0f, 0.05f, 0);
+    std::vector<ParticleInit> inits;
+    for (int i = 0; i < 3000; ++i) {
+      inits.push_back({glm::vec3(i % 30 - 15.0f, 1.0f + i % 4, i % 20 - 10.0f), glm::vec3(0.0f),
+                       simulation->GetGroupColor(static_cast<uint8_t>(i % simulation->GetGroupCount()))});
+    }
+    simulation->AddParticles(inits);
+  }
+
+  for (int step = 0; step < 10; ++step) {
+    graphed.Update(0.016f);
+    ordered.Update(0.016f);
+  }
+
+  const ParticleStore &a = graphed.GetParticleStore();
+  const ParticleStore &b = ordered.GetParticleStore();
+  ASSERT_EQ(a.Size(), b.Size());
+  EXPECT_EQ(a.x, b.x);
+  EXPECT_EQ(a.y, b.y);
+  EXPECT_EQ(a.z, b.z);
+  EXPECT_EQ(a.vx, b.vx);
+  EXPECT_EQ(a.vy, b.vy);
+  EXPECT_EQ(a.vz, b.vz);
+  EXPECT_EQ(a.waveAmplitude, b.waveAmplitude);
+  EXPECT_EQ(a.wavePhase, b.wavePhase);
+  for (size_t i = 0; i < a.Size(); ++i) {
+    ASSERT_EQ(a.color[i], b.color[i]);
+  }
+  for (size_t g = 0; g < graphed.GetGroupCount(); ++g) {
+    EXPECT_EQ(graphed.GetGroupStats()[g].positionSum, ordered.GetGroupStats()[g].positionSum);
+    EXPECT_EQ(graphed.GetGroupStats()[g].representative, ordered.GetGroupStats()[g].representative);
+  }
+}
+
+// Forces/Setup may resize the density arrays when the particle count
+// changed, so it must never overlap the tasks that size and fill them
+TEST_F(TaskGraphTest, SimulationSizesSharedArraysBeforeUsingThem) {
+  LiquidSimulation simulation(100.0f, 100.0f, 17);
+  simulation.SetThreadCount(Threads);
+  simulation.Update(0.016f);
+  const size_t before = simulation.GetParticleCount();
+  simulation.AddParticle(glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f), glm::vec3(1.0f));
+  simulation.Update(0.016f);
+  ASSERT_EQ(simulation.GetParticleCount(), before + 1);
+
+  const TaskGraph &graph = simulation.GetUpdateGraph();
+  const TaskGraph::Task forcesSetup = graph.Find("Forces/Setup");
+  ASSERT_LT(forcesSetup, graph.GetTaskCount());
+  EXPECT_TRUE(graph.IsOrderedAfter(forcesSetup, graph.Find("Density/Setup")));
+  EXPECT_TRUE(graph.IsOrderedAfter(graph.Find("Forces"), graph.Find("Density")));
+  EXPECT_TRUE(graph.IsOrderedAfter(graph.Find("Forces"), forcesSetup));
+}
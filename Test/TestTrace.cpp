@@ -0,0 +1,101 @@
+#include "Trace.h"
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+
+class TraceTest : public ::testing::Test {
+protected:
+  void Record(const char *name, int startUs, int durationUs) {
+    auto start = std::chrono::steady_clock::now() + std::chrono::microseconds(startUs);
+    recorder.Record(name, start, start + std::chrono::microseconds(durationUs));
+  }
+
+  Trace::Recorder recorder{4};
+};
+
+TEST_F(TraceTest, CapacityRoundsUpToPowerOfTwo) {
+  EXPECT_EQ(Trace::Recorder(5).GetCapacity(), 8u);
+  EXPECT_EQ(Trace::Recorder(0).GetCapacity(), 1u);
+}
+
+TEST_F(TraceTest, RecordsNameAndDuration) {
+  Record("Forces", 0, 250);
+  auto events = recorder.Snapshot();
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_STREQ(events[0].name, "Forces");
+  EXPECT_EQ(events[0].durationNs, 250000);
+  EXPECT_EQ(events[0].thread, Trace::CurrentThreadId());
+}
+
+TEST_F(TraceTest, RingKeepsNewestEventsInOrder) {
+  const char *names[] = {"a", "b", "c", "d", "e", "f"};
+  for (const char *name : names) Record(name, 0, 1);
+
+  auto events = recorder.Snapshot();
+  ASSERT_EQ(events.size(), 4u);
+  EXPECT_EQ(recorder.GetRecordedCount(), 6u);
+  EXPECT_STREQ(events.front().name, "c");
+  EXPECT_STREQ(events.back().name, "f");
+
+  recorder.Clear();
+  EXPECT_TRUE(recorder.Snapshot().empty());
+}
+
+TEST_F(TraceTest, SnapshotsNeverTearEventsRecordedMeanwhile) {
+  // Each writer's events have their own name and duration; a torn copy
+  // would mix them up
+  Trace::Recorder shared(64);
+  std::atomic<bool> stop = false;
+  auto writer = [&](const char *name, int durationUs) {
+    while (!stop) {
+      auto start = std::chrono::steady_clock::now();
+      shared.Record(name, start, start + std::chrono::microseconds(durationUs));
+    }
+  };
+  std::thread a(writer, "a", 1), b(writer, "b", 2);
+  size_t seen = 0;
+  for (int snapshot = 0; snapshot < 2000 || seen == 0; ++snapshot) {
+    for (const Trace::Event &event : shared.Snapshot()) {
+      const bool isA = event.name == std::string("a");
+      ASSERT_TRUE(isA || event.name == std::string("b"));
+      EXPECT_EQ(event.durationNs, isA ? 1000 : 2000);
+      ++seen;
+    }
+  }
+  stop = true;
+  a.join();
+  b.join();
+}
+
+TEST_F(TraceTest, ThreadIdsAreDistinct) {
+  uint32_t other = 0;
+  std::thread([&] { other = Trace::CurrentThreadId(); }).join();
+  EXPECT_NE(other, Trace::CurrentThreadId());
+}
+
+TEST_F(TraceTest, WritesChromeTraceJson) {
+  Record("Colors", 10, 40);
+  const std::string path = "test_trace.json";
+  ASSERT_TRUE(recorder.WriteChromeTrace(path));
+
+  std::ifstream file(path);
+  nlohmann::json trace = nlohmann::json::parse(file);
+  std::remove(path.c_str());
+
+  const auto &events = trace["traceEvents"];
+  ASSERT_EQ(events.size(), 2u); // The event and its thread name
+  EXPECT_EQ(events[0]["name"], "Colors");
+  EXPECT_EQ(events[0]["ph"], "X");
+  EXPECT_DOUBLE_EQ(events[0]["dur"].get<double>(), 40.0);
+  EXPECT_EQ(events[0]["tid"], Trace::CurrentThreadId());
+  EXPECT_EQ(events[1]["ph"], "M");
+}
+
+TEST_F(TraceTest, UnwritablePathFails) {
+  EXPECT_FALSE(recorder.WriteChromeTrace("/nonexistent/dir/trace.json"));
+}
@@ -0,0 +1,131 @@
+#include "LiquidSimulation.h"
+#include "TrajectoryReader.h"
+#include "TrajectoryRecorder.h"
+#include <glm/glm.hpp>
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+class TrajectoryTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    simulation = std::make_unique<LiquidSimulation>(100.0f, 100.0f, 11);
+  }
+
+  void TearDown() override { std::remove(path.c_str()); }
+
+  // Records `frames` steps, flushing after each so none are dropped, and
+  // returns the recorded states
+  std::vector<TrajectoryFrame> Record(const TrajectoryRecorder::Options &options, int frames) {
+    std::vector<TrajectoryFrame> expected;
+    TrajectoryRecorder recorder(path, options);
+    for (int i = 0; i < frames; ++i) {
+      simulation->Update(0.016f);
+      EXPECT_TRUE(recorder.Capture(simulation->GetParticleStore(), i * 0.016));
+      recorder.Flush();
+      expected.emplace_back().CopyFrom(simulation->GetParticleStore());
+    }
+    EXPECT_EQ(recorder.GetWrittenCount(), static_cast<uint64_t>(frames));
+    return expected;
+  }
+
+  static void ExpectNear(const TrajectoryFrame &actual, const TrajectoryFrame &expected,
+                         float positionTolerance, float colorTolerance) {
+    ASSERT_EQ(actual.Size(), expected.Size());
+    for (size_t i = 0; i < actual.Size(); ++i) {
+      EXPECT_NEAR(actual.x[i], expected.x[i], positionTolerance);
+      EXPECT_NEAR(actual.y[i], expected.y[i], positionTolerance);
+      EXPECT_NEAR(actual.z[i], expected.z[i], positionTolerance);
+      EXPECT_NEAR(actual.color[i].r, expected.color[i].r, colorTolerance);
+      EXPECT_NEAR(actual.radius[i], expected.radius[i], Trajectory::RadiusStep);
+    }
+  }
+
+  std::unique_ptr<LiquidSimulation> simulation;
+  const std::string path = "test_trajectory.bin";
+};
+
+TEST_F(TrajectoryTest, RawFramesRoundTripExactly) {
+  auto expected = Record({}, 3);
+  TrajectoryReader reader(path);
+  ASSERT_EQ(reader.GetFrameCount(), 3u);
+  EXPECT_FALSE(reader.WasRecovered());
+
+  TrajectoryFrame frame;
+  for (size_t f = 0; f < 3; ++f) {
+    reader.ReadFrame(f, frame);
+    EXPECT_EQ(frame.sequence, f);
+    EXPECT_DOUBLE_EQ(frame.time, f * 0.016);
+    ExpectNear(frame, expected[f], 0.0f, 0.0f);
+  }
+}
+
+TEST_F(TrajectoryTest, DeltaFramesDecodeInAnyOrder) {
+  TrajectoryRecorder::Options options;
+  options.delta = true;
+  options.keyframeInterval = 4;
+  auto expected = Record(options, 10);
+
+  TrajectoryReader reader(path);
+  EXPECT_TRUE(reader.GetEntry(0).flags & Trajectory::Keyframe);
+  EXPECT_FALSE(reader.GetEntry(1).flags & Trajectory::Keyframe);
+  EXPECT_TRUE(reader.GetEntry(4).flags & Trajectory::Keyframe);
+
+  TrajectoryFrame frame;
+  for (size_t f : {0u, 1u, 2u, 7u, 3u, 9u, 5u}) {
+    reader.ReadFrame(f, frame);
+    ExpectNear(frame, expected[f], 0.0006f, 0.5f / 255.0f + 1e-6f);
+  }
+}
+
+TEST_F(TrajectoryTest, DeltaFilesAreSmallerThanRaw) {
+  Record({}, 6);
+  const auto rawSize = std::ifstream(path, std::ios::ate | std::ios::binary).tellg();
+  TrajectoryRecorder::Options options;
+  options.delta = true;
+  Record(options, 6);
+  const auto deltaSize = std::ifstream(path, std::ios::ate | std::ios::binary).tellg();
+  EXPECT_LT(deltaSize * 2, rawSize);
+}
+
+TEST_F(TrajectoryTest, FullBuffersDropInsteadOfBlocking) {
+  TrajectoryRecorder::Options options;
+  options.bufferCount = 1;
+  TrajectoryRecorder recorder(path, options);
+  for (int i = 0; i < 50; ++i) {
+    recorder.Capture(simulation->GetParticleStore(), i);
+  }
+  recorder.Flush();
+  EXPECT_EQ(recorder.GetCapturedCount(), 50u);
+  EXPECT_EQ(recorder.GetWrittenCount() + recorder.GetDroppedCount(), 50u);
+  EXPECT_GE(recorder.GetWrittenCount(), 1u);
+}
+
+TEST_F(TrajectoryTest, UnclosedFileIndexIsRebuilt) {
+  Record({}, 3);
+  std::vector<char> bytes;
+  {
+    std::ifstream file(path, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(file), {});
+  }
+  // Drop the index and clear the header's pointer to it, as after a crash
+  Trajectory::FileHeader header;
+  std::memcpy(&header, bytes.data(), sizeof(header));
+  bytes.resize(header.indexOffset - 10); // Also tear the last chunk
+  header.indexOffset = 0;
+  std::memcpy(bytes.data(), &header, sizeof(header));
+  std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), bytes.size());
+
+  TrajectoryReader reader(path);
+  EXPECT_TRUE(reader.WasRecovered());
+  EXPECT_EQ(reader.GetFrameCount(), 2u);
+}
+
+TEST_F(TrajectoryTest, NonTrajectoryFilesAreRejected) {
+  std::ofstream(path) << "not a trajectory file at all, just some text padding it out";
+  EXPECT_THROW(TrajectoryReader reader(path), std::runtime_error);
+  EXPECT_THROW(TrajectoryReader reader("missing.bin"), std::runtime_error);
+}
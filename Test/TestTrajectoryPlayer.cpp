@@ -0,0 +1,127 @@
+#include "LiquidSimulation.h"
+#include "TrajectoryPlayer.h"
+#include "TrajectoryRecorder.h"
+#include "VertexPacking.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+class TrajectoryPlayerTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    LiquidSimulation simulation(100.0f, 100.0f, 5);
+    TrajectoryRecorder::Options options;
+    options.delta = true;
+    options.keyframeInterval = 4;
+    TrajectoryRecorder recorder(path, options);
+    for (int i = 0; i < FrameCount; ++i) {
+      simulation.Update(Step);
+      ASSERT_TRUE(recorder.Capture(simulation.GetParticleStore(), i * Step));
+      recorder.Flush();
+    }
+  }
+
+  void TearDown() override { std::remove(path.c_str()); }
+
+  // The frame as the reader decodes it on its own
+  TrajectoryFrame Expected(size_t index) {
+    TrajectoryReader reader(path);
+    TrajectoryFrame frame;
+    reader.ReadFrame(index, frame);
+    return frame;
+  }
+
+  static constexpr int FrameCount = 10;
+  static constexpr double Step = 0.5;
+  const std::string path = "test_player.bin";
+};
+
+TEST_F(TrajectoryPlayerTest, StartsOnFirstFrame) {
+  TrajectoryPlayer player(path);
+  EXPECT_EQ(player.GetFrameCount(), static_cast<size_t>(FrameCount));
+  EXPECT_EQ(player.GetFrameIndex(), 0u);
+  EXPECT_DOUBLE_EQ(player.GetStartTime(), 0.0);
+  EXPECT_DOUBLE_EQ(player.GetEndTime(), (FrameCount - 1) * Step);
+  EXPECT_EQ(player.GetFrame().x, Expected(0).x);
+}
+
+TEST_F(TrajectoryPlayerTest, AdvanceFollowsRecordedTime) {
+  TrajectoryPlayer player(path);
+  EXPECT_FALSE(player.Advance(0.25)); // Still within frame 0
+  EXPECT_TRUE(player.Advance(0.25));
+  EXPECT_EQ(player.GetFrameIndex(), 1u);
+  EXPECT_TRUE(player.Advance(1.0));
+  EXPECT_EQ(player.GetFrameIndex(), 3u);
+  EXPECT_EQ(player.GetFrame().x, Expected(3).x);
+}
+
+TEST_F(TrajectoryPlayerTest, SpeedScalesAndReversesPlayback) {
+  TrajectoryPlayer player(path);
+  player.SetSpeed(4.0);
+  player.Advance(0.5);
+  EXPECT_EQ(player.GetFrameIndex(), 4u);
+
+  player.SetSpeed(-1.0);
+  player.Advance(1.0);
+  EXPECT_EQ(player.GetFrameIndex(), 2u);
+  EXPECT_EQ(player.GetFrame().x, Expected(2).x);
+}
+
+TEST_F(TrajectoryPlayerTest, PausedPlayerHolds) {
+  TrajectoryPlayer player(path);
+  player.SetPaused(true);
+  EXPECT_FALSE(player.Advance(3.0));
+  EXPECT_EQ(player.GetFrameIndex(), 0u);
+  EXPECT_DOUBLE_EQ(player.GetTime(), 0.0);
+}
+
+TEST_F(TrajectoryPlayerTest, SeekLandsOnExactFramesAcrossKeyframes) {
+  TrajectoryPlayer player(path);
+  for (size_t index : {7u, 2u, 9u, 5u, 0u}) {
+    player.SeekFrame(index);
+    EXPECT_EQ(player.GetFrameIndex(), index);
+    EXPECT_EQ(player.GetFrame().x, Expected(index).x);
+  }
+
+  player.Seek(3.2); // Between frames 6 and 7
+  EXPECT_EQ(player.GetFrameIndex(), 6u);
+  player.Seek(100.0);
+  EXPECT_EQ(player.GetFrameIndex(), static_cast<size_t>(FrameCount - 1));
+  player.Seek(-100.0);
+  EXPECT_EQ(player.GetFrameIndex(), 0u);
+}
+
+TEST_F(TrajectoryPlayerTest, LoopsOrStopsAtTheEnd) {
+  TrajectoryPlayer player(path);
+  // A loop holds each of the 10 frames for one 0.5 s interval
+  player.Advance(FrameCount * Step + 0.25);
+  EXPECT_EQ(player.GetFrameIndex(), 0u);
+  player.Advance(0.5);
+  EXPECT_EQ(player.GetFrameIndex(), 1u);
+
+  player.SetLooping(false);
+  player.Advance(100.0);
+  EXPECT_EQ(player.GetFrameIndex(), static_cast<size_t>(FrameCount - 1));
+  EXPECT_DOUBLE_EQ(player.GetTime(), player.GetEndTime());
+}
+
+TEST_F(TrajectoryPlayerTest, PacksFramesLikeLiveParticles) {
+  TrajectoryPlayer player(path);
+  const TrajectoryFrame &frame = player.GetFrame();
+  std::vector<float> vertices;
+  PackLiquidVertices(frame, vertices);
+  ASSERT_EQ(vertices.size(), frame.Size() * LiquidVertexFloats);
+  const size_t last = frame.Size() - 1;
+  const float *vertex = vertices.data() + last * LiquidVertexFloats;
+  EXPECT_EQ(vertex[0], frame.x[last]);
+  EXPECT_EQ(vertex[1], frame.y[last]);
+  EXPECT_EQ(vertex[2], frame.z[last]);
+  EXPECT_EQ(vertex[3], frame.color[last].r);
+  EXPECT_FLOAT_EQ(vertex[6], frame.radius[last] * 40.0f);
+}
+
+TEST_F(TrajectoryPlayerTest, RejectsEmptyTrajectories) {
+  { TrajectoryRecorder recorder(path); }
+  EXPECT_THROW(TrajectoryPlayer player(path), std::runtime_error);
+}
@@ -0,0 +1,51 @@
+#include "LiquidSimulation.h"
+#include "SimulationStepper.h"
+#include "VertexPacking.h"
+#include <glm/glm.hpp>
+#include <gtest/gtest.h>
+
+class VertexPackingTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    simulation = std::make_unique<LiquidSimulation>(100.0f, 100.0f);
+    simulation->AddParticle(glm::vec3(1.0f, 2.0f, 3.0f), glm::vec3(0.0f),
+                            glm::vec3(0.5f, 0.25f, 1.0f));
+    last = simulation->GetParticleCount() - 1;
+  }
+
+  std::unique_ptr<LiquidSimulation> simulation;
+  size_t last = 0;
+};
+
+TEST_F(VertexPackingTest, PacksPositionColorAndSize) {
+  std::vector<float> vertices;
+  PackLiquidVertices(simulation->GetParticleStore(), nullptr, vertices);
+  const float *vertex = vertices.data() + last * LiquidVertexFloats;
+  EXPECT_EQ(vertex[0], 1.0f);
+  EXPECT_EQ(vertex[1], 2.0f);
+  EXPECT_EQ(vertex[2], 3.0f);
+  EXPECT_EQ(vertex[3], 0.5f);
+  EXPECT_EQ(vertex[4], 0.25f);
+  EXPECT_EQ(vertex[5], 1.0f);
+  EXPECT_FLOAT_EQ(vertex[6],
+                  simulation->GetParticleStore().radius[last] * 40.0f);
+}
+
+TEST_F(VertexPackingTest, ResizesToParticleCount) {
+  std::vector<float> vertices(100000, -1.0f);
+  PackLiquidVertices(simulation->GetParticleStore(), nullptr, vertices);
+  EXPECT_EQ(vertices.size(), simulation->GetParticleCount() * LiquidVertexFloats);
+}
+
+TEST_F(VertexPackingTest, UsesInterpolatedPositionsWithStepper) {
+  SimulationStepper stepper(*simulation, 0.01f, 4);
+  stepper.Advance(0.015f);
+  std::vector<float> vertices;
+  PackLiquidVertices(simulation->GetParticleStore(), &stepper, vertices);
+  for (size_t i = 0; i < simulation->GetParticleCount(); ++i) {
+    glm::vec3 expected = stepper.GetInterpolatedPosition(i);
+    EXPECT_EQ(vertices[i * LiquidVertexFloats + 0], expected.x);
+    EXPECT_EQ(vertices[i * LiquidVertexFloats + 1], expected.y);
+    EXPECT_EQ(vertices[i * LiquidVertexFloats + 2], expected.z);
+  }
+}
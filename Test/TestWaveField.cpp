@@ -0,0 +1,111 @@
+#include "WaveField.h"
+#include <gtest/gtest.h>
+#include <cmath>
+
+class WaveFieldTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    // 10 x 5 x 5 cells of 2 units, centered on the origin
+    field.Configure(glm::vec3(-10.0f, -5.0f, -5.0f), glm::vec3(10.0f, 5.0f, 5.0f), 2, params);
+  }
+
+  WaveField::Params params;
+  WaveField field;
+};
+
+TEST_F(WaveFieldTest, SamplesBackWhatWasInjected) {
+  EXPECT_TRUE(field.IsQuiet());
+  const glm::vec3 center(1.0f, 0.0f, 0.0f); // A cell center
+  field.Inject(1, center, 0.8f, 0.5f);
+  EXPECT_FALSE(field.IsQuiet());
+
+  float amplitude = 0.0f, phase = 0.0f;
+  ASSERT_TRUE(field.Sample(1, center, amplitude, phase));
+  EXPECT_NEAR(amplitude, 0.8f, 1e-5f);
+  EXPECT_NEAR(phase, 0.5f, 1e-5f);
+  // Channels are independent
+  EXPECT_FALSE(field.Sample(0, center, amplitude, phase));
+}
+
+TEST_F(WaveFieldTest, KeepsTheStrongestInjection) {
+  const glm::vec3 center(1.0f, 0.0f, 0.0f);
+  field.Inject(0, center, 0.8f, 0.5f);
+  field.Inject(0, center, 0.3f, 2.0f);
+
+  float amplitude = 0.0f, phase = 0.0f;
+  ASSERT_TRUE(field.Sample(0, center, amplitude, phase));
+  EXPECT_NEAR(amplitude, 0.8f, 1e-5f);
+  EXPECT_NEAR(phase, 0.5f, 1e-5f);
+}
+
+TEST_F(WaveFieldTest, SpreadsToNeighborsAndFades) {
+  const glm::vec3 center(1.0f, 0.0f, 0.0f);
+  const glm::vec3 nearby = center + glm::vec3(4.0f, 0.0f, 0.0f);
+  field.Inject(0, center, 1.0f, 0.0f);
+
+  float amplitude = 0.0f, phase = 0.0f;
+  EXPECT_FALSE(field.Sample(0, nearby, amplitude, phase));
+  field.Step(1.0f / 60.0f);
+  ASSERT_TRUE(field.Sample(0, nearby, amplitude, phase));
+  EXPECT_GT(amplitude, 0.0f);
+  ASSERT_TRUE(field.Sample(0, center, amplitude, phase));
+  EXPECT_LT(amplitude, 1.0f);
+
+  for (int step = 0; step < 600 && !field.IsQuiet(); ++step) field.Step(1.0f / 60.0f);
+  EXPECT_TRUE(field.IsQuiet());
+  EXPECT_FALSE(field.Sample(0, center, amplitude, phase));
+}
+
+TEST_F(WaveFieldTest, FartherCellsLagInPhase) {
+  params.decayRate = 0.0f;
+  params.phaseLag = 0.1f; // Keeps every phase here within (-pi, 0]
+  SetUp();
+  const glm::vec3 center(1.0f, 0.0f, 0.0f);
+  field.Inject(0, center, 1.0f, 0.0f);
+  for (int step = 0; step < 3; ++step) field.Step(1.0f / 60.0f);
+
+  float nearAmplitude = 0.0f, nearPhase = 0.0f, farAmplitude = 0.0f, farPhase = 0.0f;
+  ASSERT_TRUE(field.Sample(0, center + glm::vec3(2.0f, 0.0f, 0.0f), nearAmplitude, nearPhase));
+  ASSERT_TRUE(field.Sample(0, center + glm::vec3(6.0f, 0.0f, 0.0f), farAmplitude, farPhase));
+  EXPECT_LT(nearPhase, 0.0f);
+  EXPECT_LT(farPhase, nearPhase);
+  EXPECT_LT(farAmplitude, nearAmplitude);
+}
+
+TEST_F(WaveFieldTest, PointsOutsideTheBoundsUseTheEdgeCells) {
+  field.Inject(0, glm::vec3(100.0f, 0.0f, 0.0f), 0.5f, 0.0f);
+
+  float amplitude = 0.0f, phase = 0.0f;
+  ASSERT_TRUE(field.Sample(0, glm::vec3(9.0f, 0.0f, 0.0f), amplitude, phase));
+  EXPECT_GT(amplitude, 0.0f);
+  EXPECT_FALSE(field.Sample(0, glm::vec3(-9.0f, 0.0f, 0.0f), amplitude, phase));
+}
+
+TEST_F(WaveFieldTest, SlabsSteppedInAnyOrderMatchASerialStep) {
+  field.Inject(0, glm::vec3(1.0f, 0.0f, 0.0f), 1.0f, 0.0f);
+  field.Inject(1, glm::vec3(-5.0f, 3.0f, -3.0f), 0.6f, 1.0f);
+  WaveField threaded = field, slabbed = field;
+
+  for (int step = 0; step < 8; ++step) {
+    // Three substeps, then two: both buffers end up holding the result
+    const float deltaTime = (step % 2 == 0 ? 1.0f : 0.5f) / 60.0f;
+    field.Step(deltaTime);
+    threaded.Step(deltaTime, 4);
+    const int substeps = slabbed.BeginStep(deltaTime);
+    for (int substep = 0; substep < substeps; ++substep) {
+      for (int z = slabbed.GetDimension(2) - 1; z >= 0; --z) slabbed.StepSlabs(substep, z, z + 1);
+    }
+    slabbed.EndStep();
+
+    const auto& expected = field.GetPhasors();
+    ASSERT_EQ(threaded.GetPhasors().size(), expected.size());
+    ASSERT_EQ(slabbed.GetPhasors().size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+      ASSERT_EQ(threaded.GetPhasors()[i].x, expected[i].x);
+      ASSERT_EQ(threaded.GetPhasors()[i].y, expected[i].y);
+      ASSERT_EQ(slabbed.GetPhasors()[i].x, expected[i].x);
+      ASSERT_EQ(slabbed.GetPhasors()[i].y, expected[i].y);
+    }
+    EXPECT_EQ(slabbed.IsQuiet(), field.IsQuiet());
+  }
+}